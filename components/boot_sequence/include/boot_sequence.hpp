@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "sdkconfig.h"
+
+/**
+ * @brief One step of the boot.
+ * @param arg Pointer given to BootSequence::add()
+ * @return ESP_OK, or the error that makes the stages depending on it be skipped
+ */
+using BootStageFn = esp_err_t (*)(void* arg);
+
+enum class BootStageState : uint8_t {
+    Pending,
+    Running,
+    Done,
+    Failed,
+    Skipped,  ///< A dependency failed or was skipped
+};
+
+/**
+ * @brief Outcome and timing of one stage; times are ms since boot.
+ */
+struct BootStageReport {
+    const char* name;
+    BootStageState state;
+    esp_err_t err;
+    uint32_t start_ms;
+    uint32_t end_ms;
+};
+
+/**
+ * @brief Runs boot stages as soon as the stages they depend on have succeeded.
+ *
+ * Each stage runs on its own task, so stages that do not depend on each other
+ * overlap. Dependencies can only name stages added earlier, which keeps the
+ * graph acyclic. run() returns once every stage has finished or been skipped,
+ * and logs a per-stage timing breakdown against CONFIG_BOOT_SEQUENCE_BUDGET_MS.
+ */
+class BootSequence {
+   public:
+    static constexpr size_t MAX_STAGES = 16;
+
+    /**
+     * @brief Add a stage.
+     * @param deps Ids returned by earlier add() calls
+     * @return Stage id, or -1 if the table is full or a dependency is unknown
+     */
+    int add(const char* name, BootStageFn fn, void* arg = nullptr,
+            std::initializer_list<int> deps = {});
+
+    /**
+     * @brief Run every stage and wait for all of them.
+     * @return ESP_OK, or the error of the first stage that failed
+     */
+    esp_err_t run();
+
+    BootStageReport getReport(int id) const;
+
+    size_t size() const {
+        return count_;
+    }
+
+   private:
+    struct Stage {
+        const char* name;
+        BootStageFn fn;
+        void* arg;
+        uint32_t deps;  ///< Bit n set for stage n
+        BootStageState state;
+        esp_err_t err;
+        int64_t start_us;
+        int64_t end_us;
+        uint8_t id;
+        QueueHandle_t done;  ///< Where the stage task reports its id
+    };
+
+    Stage stages_[MAX_STAGES] = {};
+    size_t count_ = 0;
+    QueueHandle_t done_ = nullptr;  ///< Ids of finished stages, while run() waits
+
+    size_t startReady();
+    void logSummary(int64_t run_start_us) const;
+
+    static void stageTask(void* arg);
+};
@@ -0,0 +1,170 @@
+#include "boot_sequence.hpp"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+
+static const char* TAG = "boot_sequence";
+
+static uint32_t toMs(int64_t us) {
+    return static_cast<uint32_t>(us / 1000);
+}
+
+static const char* stateName(BootStageState state) {
+    switch (state) {
+        case BootStageState::Done:
+            return "ok";
+        case BootStageState::Failed:
+            return "failed";
+        case BootStageState::Skipped:
+            return "skipped";
+        default:
+            return "pending";
+    }
+}
+
+int BootSequence::add(const char* name, BootStageFn fn, void* arg,
+                      std::initializer_list<int> deps) {
+    if (count_ == MAX_STAGES || !fn) return -1;
+
+    uint32_t mask = 0;
+    for (int dep : deps) {
+        if (dep < 0 || static_cast<size_t>(dep) >= count_) {
+            ESP_LOGE(TAG, "Stage %s depends on unknown stage %d", name, dep);
+            return -1;
+        }
+        mask |= 1u << dep;
+    }
+
+    Stage& stage = stages_[count_];
+    stage = {};
+    stage.name = name;
+    stage.fn = fn;
+    stage.arg = arg;
+    stage.deps = mask;
+    stage.id = static_cast<uint8_t>(count_);
+    return static_cast<int>(count_++);
+}
+
+esp_err_t BootSequence::run() {
+    if (count_ == 0) return ESP_OK;
+
+    done_ = xQueueCreate(count_, sizeof(uint8_t));
+    if (!done_) return ESP_ERR_NO_MEM;
+
+    int64_t run_start_us = esp_timer_get_time();
+    esp_err_t result = ESP_OK;
+    size_t finished = startReady();
+    while (finished < count_) {
+        uint8_t id;
+        xQueueReceive(done_, &id, portMAX_DELAY);
+
+        Stage& stage = stages_[id];
+        stage.state = stage.err == ESP_OK ? BootStageState::Done : BootStageState::Failed;
+        if (stage.err != ESP_OK) {
+            ESP_LOGE(TAG, "Stage %s failed: %s", stage.name, esp_err_to_name(stage.err));
+        }
+        finished += 1 + startReady();
+    }
+    vQueueDelete(done_);
+    done_ = nullptr;
+
+    for (size_t i = 0; i < count_ && result == ESP_OK; i++) {
+        if (stages_[i].state == BootStageState::Failed) result = stages_[i].err;
+    }
+    logSummary(run_start_us);
+    return result;
+}
+
+// Starts every pending stage whose dependencies all succeeded and skips those
+// with a failed one. Returns how many stages it settled without a task, which
+// the caller counts as finished.
+size_t BootSequence::startReady() {
+    size_t settled = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 0; i < count_; i++) {
+            Stage& stage = stages_[i];
+            if (stage.state != BootStageState::Pending) continue;
+
+            bool ready = true;
+            bool blocked = false;
+            for (size_t dep = 0; dep < count_; dep++) {
+                if (!(stage.deps & (1u << dep))) continue;
+                BootStageState dep_state = stages_[dep].state;
+                if (dep_state == BootStageState::Failed || dep_state == BootStageState::Skipped) {
+                    blocked = true;
+                }
+                if (dep_state != BootStageState::Done) ready = false;
+            }
+
+            if (blocked) {
+                ESP_LOGW(TAG, "Skipping stage %s: a dependency failed", stage.name);
+                stage.state = BootStageState::Skipped;
+                settled++;
+                changed = true;  // Its own dependents are skipped in the next pass
+                continue;
+            }
+            if (!ready) continue;
+
+            // Same priority as the caller, so no stage preempts the others
+            stage.state = BootStageState::Running;
+            stage.done = done_;
+            if (xTaskCreate(stageTask, stage.name, CONFIG_BOOT_SEQUENCE_STAGE_STACK_SIZE, &stage,
+                            uxTaskPriorityGet(nullptr), nullptr) != pdPASS) {
+                ESP_LOGE(TAG, "No task for stage %s", stage.name);
+                stage.state = BootStageState::Failed;
+                stage.err = ESP_ERR_NO_MEM;
+                settled++;
+                changed = true;
+            }
+        }
+    }
+    return settled;
+}
+
+void BootSequence::stageTask(void* arg) {
+    auto* stage = static_cast<Stage*>(arg);
+    stage->start_us = esp_timer_get_time();
+    stage->err = stage->fn(stage->arg);
+    stage->end_us = esp_timer_get_time();
+
+    // The queue holds one slot per stage, so this never blocks
+    xQueueSend(stage->done, &stage->id, portMAX_DELAY);
+    vTaskDelete(nullptr);
+}
+
+BootStageReport BootSequence::getReport(int id) const {
+    if (id < 0 || static_cast<size_t>(id) >= count_) return {};
+
+    const Stage& stage = stages_[id];
+    return {stage.name, stage.state, stage.err, toMs(stage.start_us), toMs(stage.end_us)};
+}
+
+void BootSequence::logSummary(int64_t run_start_us) const {
+    int64_t end_us = run_start_us;
+    ESP_LOGI(TAG, "%-12s %8s %8s %8s  %s", "stage", "start", "end", "took", "result");
+    for (size_t i = 0; i < count_; i++) {
+        const Stage& stage = stages_[i];
+        if (stage.end_us > end_us) end_us = stage.end_us;
+        if (stage.state == BootStageState::Skipped) {
+            ESP_LOGI(TAG, "%-12s %8s %8s %8s  %s", stage.name, "-", "-", "-",
+                     stateName(stage.state));
+            continue;
+        }
+        ESP_LOGI(TAG, "%-12s %8u %8u %8u  %s", stage.name, (unsigned)toMs(stage.start_us),
+                 (unsigned)toMs(stage.end_us), (unsigned)toMs(stage.end_us - stage.start_us),
+                 stateName(stage.state));
+    }
+
+    // esp_timer counts from boot, so the end time is the boot time so far
+    uint32_t boot_ms = toMs(end_us);
+    uint32_t sequence_ms = toMs(end_us - run_start_us);
+    if (CONFIG_BOOT_SEQUENCE_BUDGET_MS && boot_ms > CONFIG_BOOT_SEQUENCE_BUDGET_MS) {
+        ESP_LOGW(TAG, "Boot took %u ms (stages %u ms), over the %u ms budget", (unsigned)boot_ms,
+                 (unsigned)sequence_ms, (unsigned)CONFIG_BOOT_SEQUENCE_BUDGET_MS);
+    } else {
+        ESP_LOGI(TAG, "Boot took %u ms (stages %u ms)", (unsigned)boot_ms, (unsigned)sequence_ms);
+    }
+}
@@ -0,0 +1,47 @@
+#include <stdio.h>
+
+#include "unity.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void setUp(void) {
+    // Set up before every test
+}
+
+void tearDown(void) {
+    // Clean up after every test
+}
+
+// boot sequence tests
+void test_boot_sequence_orders_dependencies();
+void test_boot_sequence_overlaps_independent_stages();
+void test_boot_sequence_skips_dependents_of_failed_stage();
+void test_boot_sequence_rejects_unknown_dependency();
+
+#ifdef __cplusplus
+}
+#endif
+
+TEST_CASE("Boot: Stages start after their dependencies", "[boot]") {
+    test_boot_sequence_orders_dependencies();
+}
+
+TEST_CASE("Boot: Independent stages run in parallel", "[boot]") {
+    test_boot_sequence_overlaps_independent_stages();
+}
+
+TEST_CASE("Boot: Dependents of a failed stage are skipped", "[boot]") {
+    test_boot_sequence_skips_dependents_of_failed_stage();
+}
+
+TEST_CASE("Boot: Unknown dependencies are rejected", "[boot]") {
+    test_boot_sequence_rejects_unknown_dependency();
+}
+
+void app_main(void) {
+    UNITY_BEGIN();
+    unity_run_all_tests();
+    UNITY_END();
+}
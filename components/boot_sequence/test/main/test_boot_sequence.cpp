@@ -0,0 +1,102 @@
+#include <atomic>
+
+#include "boot_sequence.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "unity.h"
+
+constexpr uint32_t STAGE_MS = 100;
+
+/**
+ * @brief What a test stage did; the order field is its place among finishers.
+ */
+struct Probe {
+    std::atomic<int>* finished;
+    int order = -1;
+    esp_err_t result = ESP_OK;
+};
+
+static esp_err_t sleepStage(void* arg) {
+    auto* probe = static_cast<Probe*>(arg);
+    vTaskDelay(pdMS_TO_TICKS(STAGE_MS));
+    probe->order = (*probe->finished)++;
+    return probe->result;
+}
+
+static esp_err_t quickStage(void* arg) {
+    auto* probe = static_cast<Probe*>(arg);
+    probe->order = (*probe->finished)++;
+    return probe->result;
+}
+
+/// @brief Tests that a stage starts only after every stage it depends on has finished.
+extern "C" void test_boot_sequence_orders_dependencies() {
+    std::atomic<int> finished{0};
+    Probe slow{&finished}, fast{&finished}, last{&finished};
+
+    BootSequence boot;
+    int a = boot.add("slow", sleepStage, &slow);
+    int b = boot.add("fast", quickStage, &fast);
+    int c = boot.add("last", quickStage, &last, {a, b});
+    TEST_ASSERT_EQUAL(ESP_OK, boot.run());
+
+    TEST_ASSERT_EQUAL(0, fast.order);
+    TEST_ASSERT_EQUAL(1, slow.order);
+    TEST_ASSERT_EQUAL(2, last.order);
+
+    BootStageReport report = boot.getReport(c);
+    TEST_ASSERT_EQUAL(BootStageState::Done, report.state);
+    TEST_ASSERT_GREATER_OR_EQUAL(boot.getReport(a).end_ms, report.start_ms);
+}
+
+/// @brief Tests that stages without dependencies between them overlap in time.
+extern "C" void test_boot_sequence_overlaps_independent_stages() {
+    std::atomic<int> finished{0};
+    Probe probes[3] = {{&finished}, {&finished}, {&finished}};
+
+    BootSequence boot;
+    for (Probe& probe : probes) boot.add("sleep", sleepStage, &probe);
+
+    TickType_t start = xTaskGetTickCount();
+    TEST_ASSERT_EQUAL(ESP_OK, boot.run());
+    TickType_t elapsed = xTaskGetTickCount() - start;
+
+    TEST_ASSERT_EQUAL(3, finished.load());
+    TEST_ASSERT_GREATER_OR_EQUAL(pdMS_TO_TICKS(STAGE_MS), elapsed);
+    TEST_ASSERT_LESS_THAN(pdMS_TO_TICKS(2 * STAGE_MS), elapsed);
+}
+
+/// @brief Tests that a failure skips its dependents, transitively, but not unrelated stages.
+extern "C" void test_boot_sequence_skips_dependents_of_failed_stage() {
+    std::atomic<int> finished{0};
+    Probe failing{&finished}, child{&finished}, grandchild{&finished}, unrelated{&finished};
+    failing.result = ESP_ERR_TIMEOUT;
+
+    BootSequence boot;
+    int a = boot.add("failing", quickStage, &failing);
+    int b = boot.add("child", quickStage, &child, {a});
+    int c = boot.add("grandchild", quickStage, &grandchild, {b});
+    int d = boot.add("unrelated", sleepStage, &unrelated);
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, boot.run());
+
+    TEST_ASSERT_EQUAL(BootStageState::Failed, boot.getReport(a).state);
+    TEST_ASSERT_EQUAL(BootStageState::Skipped, boot.getReport(b).state);
+    TEST_ASSERT_EQUAL(BootStageState::Skipped, boot.getReport(c).state);
+    TEST_ASSERT_EQUAL(BootStageState::Done, boot.getReport(d).state);
+    TEST_ASSERT_EQUAL(-1, child.order);
+    TEST_ASSERT_EQUAL(-1, grandchild.order);
+    TEST_ASSERT_EQUAL(2, finished.load());
+}
+
+/// @brief Tests that a dependency on a stage not added yet is refused.
+extern "C" void test_boot_sequence_rejects_unknown_dependency() {
+    std::atomic<int> finished{0};
+    Probe probe{&finished};
+
+    BootSequence boot;
+    TEST_ASSERT_EQUAL(-1, boot.add("orphan", quickStage, &probe, {0}));
+    int a = boot.add("first", quickStage, &probe);
+    TEST_ASSERT_EQUAL(-1, boot.add("self", quickStage, &probe, {a + 1}));
+    TEST_ASSERT_EQUAL(1, boot.size());
+    TEST_ASSERT_EQUAL(ESP_OK, boot.run());
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "config_types.hpp"
+
+// On-flash format of one config section. Every blob is a ConfigBlobHeader
+// followed by the section struct as laid out by its schema version. Blobs
+// written before the header existed are raw structs and are read as version 0.
+
+#define CONFIG_BLOB_MAGIC 0x47464E43  // "CNFG"
+
+#define CONFIG_INFO_VERSION 1     ///< Current DeviceInfo schema
+#define CONFIG_NETWORK_VERSION 2  ///< Current NetworkConfig schema
+
+/**
+ * @brief Header stored in front of every section blob; little-endian.
+ */
+struct ConfigBlobHeader {
+    uint32_t magic;    ///< CONFIG_BLOB_MAGIC
+    uint16_t version;  ///< Schema version of the payload
+    uint16_t length;   ///< Payload bytes following the header
+    uint32_t crc;      ///< CRC32 of version, length and payload
+};
+
+#define CONFIG_BLOB_MAX_LEN (sizeof(ConfigBlobHeader) + sizeof(NetworkConfig))
+
+static_assert(sizeof(ConfigBlobHeader) == 12, "Header layout is part of the flash format");
+static_assert(sizeof(DeviceInfo) <= sizeof(NetworkConfig), "CONFIG_BLOB_MAX_LEN assumes this");
+
+/**
+ * @brief Outcome of decoding a stored section blob.
+ */
+enum class ConfigDecodeStatus {
+    Ok,           ///< Current version, copied out unchanged
+    Migrated,     ///< Older version, upgraded; should be rewritten
+    Corrupt,      ///< Bad magic/length/CRC, or an old blob of the wrong size
+    Unsupported,  ///< Version newer than this firmware or without a migration path
+};
+
+/**
+ * @brief Standard CRC32 (IEEE 802.3, reflected), as used by zlib.
+ * @param crc Running value from a previous call, or 0 to start
+ */
+uint32_t configCrc32(const void* data, size_t len, uint32_t crc = 0);
+
+/**
+ * @brief Current schema version of a section.
+ */
+uint16_t configSectionVersion(ConfigSection section);
+
+/**
+ * @brief Size of a section struct in the current schema.
+ */
+size_t configSectionSize(ConfigSection section);
+
+/**
+ * @brief Size of a section struct as stored at an older schema version.
+ * @return 0 if the version is unknown
+ */
+size_t configSectionSizeAt(ConfigSection section, uint16_t version);
+
+/**
+ * @brief Wrap a section struct in a header with the current version and CRC.
+ * @return Blob length, or 0 if cap is too small
+ */
+size_t configEncode(ConfigSection section, const void* payload, uint8_t* out, size_t cap);
+
+/**
+ * @brief Validate a stored blob and upgrade it to the current schema.
+ * @param out Receives configSectionSize(section) bytes on Ok or Migrated
+ */
+ConfigDecodeStatus configDecode(ConfigSection section, const uint8_t* blob, size_t len,
+                                void* out);
@@ -1,48 +1,77 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <mutex>
 
+#include "config_types.hpp"
 #include "esp_err.h"
-
-#define DEVICE_NAME_MAX_LEN 32
-#define FW_VERSION_MAX_LEN 16
-#define SSID_MAX_LEN 32
-#define PASSWORD_MAX_LEN 64
-#define MAC_ADDR_LEN 18
-#define IP_ADDR_LEN 16
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
 
 /**
- * @brief Structure holding basic device information.
+ * @brief Called on the config bus task after subscribed sections change.
+ * @param sections Changed ConfigSection bits, limited to the subscribed ones
+ * @param config Snapshot with every change so far applied
+ * @param arg Pointer given to ConfigManager::subscribe()
  */
-struct DeviceInfo {
-    char device_name[DEVICE_NAME_MAX_LEN];      ///< Device name string
-    char firmware_version[FW_VERSION_MAX_LEN];  ///< Firmware version string
-};
+using ConfigChangeCallback = void (*)(uint8_t sections, const DeviceConfig& config, void* arg);
 
 /**
- * @brief Structure holding network-related configuration.
+ * @brief Read-only view of one published config.
+ *
+ * The config stays pinned, and so unchanged, for as long as the handle lives.
+ * Drop it promptly: every live handle keeps one of the
+ * CONFIG_CONFIG_MANAGER_SNAPSHOT_SLOTS slots out of reach of writers.
  */
-struct NetworkConfig {
-    char ap_ssid[SSID_MAX_LEN];          ///< SSID for the access point
-    char ap_password[PASSWORD_MAX_LEN];  ///< Password for the access point
-    bool ap_enabled;                     ///< Whether AP mode is enabled
-    bool sta_enabled;                    ///< Whether STA mode is enabled
-    char ssid[SSID_MAX_LEN];             ///< SSID for STA connection
-    char bssid[MAC_ADDR_LEN];            ///< BSSID (MAC) of connected AP
-    char ip_address[IP_ADDR_LEN];        ///< Static IP address (if used)
-    char mac_address[MAC_ADDR_LEN];      ///< Device MAC address
-};
+class ConfigSnapshot {
+   public:
+    ConfigSnapshot() = default;
+    ConfigSnapshot(ConfigSnapshot&& other) noexcept : pins_(other.pins_), config_(other.config_) {
+        other.pins_ = nullptr;
+        other.config_ = nullptr;
+    }
+    ConfigSnapshot& operator=(ConfigSnapshot&& other) noexcept;
+    ConfigSnapshot(const ConfigSnapshot&) = delete;
+    ConfigSnapshot& operator=(const ConfigSnapshot&) = delete;
+    ~ConfigSnapshot();
 
-/**
- * @brief Structure holding the full device configuration.
- */
-struct DeviceConfig {
-    DeviceInfo info;        ///< Device-specific info
-    NetworkConfig network;  ///< Network-specific config
+    const DeviceConfig* get() const {
+        return config_;
+    }
+
+    const DeviceConfig& operator*() const {
+        return *config_;
+    }
+
+    const DeviceConfig* operator->() const {
+        return config_;
+    }
+
+   private:
+    friend class ConfigManager;
+
+    ConfigSnapshot(std::atomic<uint32_t>* pins, const DeviceConfig* config)
+        : pins_(pins), config_(config) {}
+
+    std::atomic<uint32_t>* pins_ = nullptr;
+    const DeviceConfig* config_ = nullptr;
 };
 
 /**
  * @brief Singleton class for managing persistent device configuration using NVS.
+ *
+ * The current config is an immutable snapshot in one of a fixed set of slots,
+ * published through an atomic slot index. A reader loads the index and pins
+ * the slot with one atomic increment, without a lock, so it never waits on a
+ * writer or on flash. A writer fills a slot nobody has pinned and then
+ * publishes its index. A read repeats only if a writer reclaimed the slot in
+ * the instant between the load and the increment. Updates only replace the
+ * snapshot and mark the changed sections dirty. A background task writes dirty
+ * sections once updates have been quiet for
+ * CONFIG_CONFIG_MANAGER_FLUSH_DELAY_MS, and never later than
+ * CONFIG_CONFIG_MANAGER_FLUSH_MAX_LATENCY_MS after the first unwritten change.
  */
 class ConfigManager {
    public:
@@ -54,6 +83,15 @@ class ConfigManager {
 
     // === Full config ===
 
+    /**
+     * @brief Get the current configuration without copying it.
+     *
+     * The snapshot never changes; later updates publish a new one. Prefer this
+     * over getConfig() on hot paths.
+     * @return Handle pinning the current configuration
+     */
+    ConfigSnapshot getSnapshot() const;
+
     /**
      * @brief Retrieve the current full device configuration.
      * @return DeviceConfig structure
@@ -61,7 +99,7 @@ class ConfigManager {
     DeviceConfig getConfig();
 
     /**
-     * @brief Update the entire device configuration.
+     * @brief Update the entire device configuration; persisted by the next flush.
      * @param config New configuration to store
      */
     void updateConfig(const DeviceConfig& config);
@@ -75,7 +113,7 @@ class ConfigManager {
     DeviceInfo getDeviceInfo();
 
     /**
-     * @brief Update and save device information.
+     * @brief Update device information; persisted by the next flush.
      * @param info New device info to store
      */
     void updateDeviceInfo(const DeviceInfo& info);
@@ -89,21 +127,78 @@ class ConfigManager {
     NetworkConfig getNetworkConfig();
 
     /**
-     * @brief Update and save network configuration.
+     * @brief Update network configuration; persisted by the next flush.
      * @param netConfig New network configuration
      */
     void updateNetworkConfig(const NetworkConfig& netConfig);
 
-    // === Internal Operations ===
+    /**
+     * @brief Get the configuration generation.
+     *
+     * Bumped on every change, so callers can tell whether anything derived from
+     * the config is stale without taking the lock.
+     * @return Current generation counter
+     */
+    uint32_t getGeneration() const;
+
+    // === Change notifications ===
 
     /**
-     * @brief Load configuration from NVS.
+     * @brief Get called whenever any of the given sections changes.
+     *
+     * Callbacks run on a low-priority bus task, never on the writer's stack.
+     * Changes that arrive while the task is busy are coalesced, so a callback
+     * sees the latest snapshot once rather than every intermediate one.
+     * @param sections Mask of ConfigSection bits
+     * @param callback Function to call
+     * @param arg Passed through to callback
+     * @return Subscription id, or -1 if all CONFIG_CONFIG_MANAGER_MAX_SUBSCRIBERS slots are taken
+     */
+    int subscribe(uint8_t sections, ConfigChangeCallback callback, void* arg);
+
+    /**
+     * @brief Remove a subscription. A callback already running is not waited for.
+     * @param id Value returned by subscribe()
+     */
+    void unsubscribe(int id);
+
+    // === Persistence ===
+
+    /**
+     * @brief Write any dirty sections to NVS now.
+     *
+     * For shutdown and restart paths; a no-op when nothing is dirty.
      * @return ESP_OK on success, or error code
      */
+    esp_err_t flush();
+
+    /**
+     * @brief Get the sections changed since the last successful write.
+     * @return Mask of ConfigSection bits
+     */
+    uint8_t getDirtySections();
+
+    /**
+     * @brief Get the number of NVS commits so far.
+     * @return Commit counter
+     */
+    uint32_t getFlushCount() const;
+
+    // === Internal Operations ===
+
+    /**
+     * @brief Load configuration from NVS, one section at a time.
+     *
+     * Sections that are missing or invalid fall back to their defaults and are
+     * marked dirty; the others keep their stored values.
+     * @return ESP_OK if every section loaded, or the first error
+     */
     esp_err_t loadFromNVS();
 
     /**
-     * @brief Save current configuration to NVS.
+     * @brief Save every section to NVS immediately.
+     *
+     * Sections whose stored value is already identical are not rewritten.
      * @return ESP_OK on success, or error code
      */
     esp_err_t saveToNVS();
@@ -125,6 +220,67 @@ class ConfigManager {
      */
     ConfigManager();
 
-    DeviceConfig config_;  ///< Internal storage for current config
-    std::mutex mutex_;     ///< Mutex to protect concurrent access
+    /**
+     * @brief Swap in a new snapshot and mark changed sections dirty; caller holds mutex_.
+     */
+    void publish(const DeviceConfig& next);
+
+    /**
+     * @brief Claim a slot that is neither current nor pinned; caller holds mutex_.
+     */
+    uint8_t claimSlot();
+
+    /**
+     * @brief Mark sections dirty; caller holds mutex_.
+     */
+    void markDirty(uint8_t sections);
+
+    /**
+     * @brief Wake the flush task, or flush inline if it could not be created.
+     */
+    void scheduleFlush();
+
+    /**
+     * @brief Write the changed sections of a config snapshot to NVS and commit.
+     */
+    esp_err_t writeToNVS(const DeviceConfig& config, uint8_t sections);
+
+    static void flushTask(void* arg);
+    void runFlushTask();
+
+    static void busTask(void* arg);
+    void runBusTask();
+
+    struct Subscriber {
+        uint8_t sections;
+        ConfigChangeCallback callback;
+        void* arg;
+    };
+
+    struct SnapshotSlot {
+        DeviceConfig config;
+        std::atomic<uint32_t> pins{0};  ///< Live ConfigSnapshot handles, plus SLOT_WRITING
+    };
+
+    mutable SnapshotSlot slots_[CONFIG_CONFIG_MANAGER_SNAPSHOT_SLOTS];
+    std::atomic<uint8_t> current_{0};      ///< Index of the published slot
+    std::mutex mutex_;                     ///< Serializes writers; readers never take it
+    std::atomic<uint32_t> generation_{0};  ///< Bumped on every config change
+
+    // Guarded by mutex_
+    bool published_ = false;        ///< slots_[current_] holds a config
+    uint8_t dirty_ = 0;             ///< ConfigSection bits not yet written to NVS
+    TickType_t first_dirty_ = 0;    ///< When dirty_ last became non-zero
+    TickType_t last_change_ = 0;    ///< Latest change to a dirty section
+    TickType_t failed_at_ = 0;      ///< When the last failed write finished
+    TickType_t retry_backoff_ = 0;  ///< Wait after failed_at_; 0 after a successful write
+
+    std::mutex flush_mutex_;                ///< Serializes NVS writes; taken before mutex_
+    std::atomic<uint32_t> flush_count_{0};  ///< Successful NVS commits
+    TaskHandle_t flush_task_ = nullptr;     ///< Debounced writer, created by the constructor
+
+    Subscriber subscribers_[CONFIG_CONFIG_MANAGER_MAX_SUBSCRIBERS] = {};
+    std::mutex subscribers_mutex_;             ///< Guards subscribers_
+    std::atomic<uint8_t> pending_changes_{0};  ///< Sections changed since the last delivery
+    TaskHandle_t bus_task_ = nullptr;          ///< Delivers change callbacks
 };
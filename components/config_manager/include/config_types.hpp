@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+
+// Plain config structs, kept free of ESP-IDF headers so the storage format
+// code can be built and tested on the host.
+
+#define DEVICE_NAME_MAX_LEN 32
+#define FW_VERSION_MAX_LEN 16
+#define SSID_MAX_LEN 32
+#define PASSWORD_MAX_LEN 64
+#define MAC_ADDR_LEN 18
+#define IP_ADDR_LEN 16
+
+/**
+ * @brief Structure holding basic device information.
+ */
+struct DeviceInfo {
+    char device_name[DEVICE_NAME_MAX_LEN];      ///< Device name string
+    char firmware_version[FW_VERSION_MAX_LEN];  ///< Firmware version string
+};
+
+/**
+ * @brief Structure holding network-related configuration.
+ */
+struct NetworkConfig {
+    char ap_ssid[SSID_MAX_LEN];          ///< SSID for the access point
+    char ap_password[PASSWORD_MAX_LEN];  ///< Password for the access point
+    bool ap_enabled;                     ///< Whether AP mode is enabled
+    bool sta_enabled;                    ///< Whether STA mode is enabled
+    char ssid[SSID_MAX_LEN];             ///< SSID for STA connection
+    char bssid[MAC_ADDR_LEN];            ///< BSSID (MAC) of the last AP joined, for fast reconnect
+    char ip_address[IP_ADDR_LEN];        ///< Static IP address (if used)
+    char mac_address[MAC_ADDR_LEN];      ///< Device MAC address
+    char password[PASSWORD_MAX_LEN];     ///< Password for STA connection
+    uint8_t channel;                     ///< Channel of bssid, 0 if not known yet
+};
+
+/**
+ * @brief Structure holding the full device configuration.
+ */
+struct DeviceConfig {
+    DeviceInfo info;        ///< Device-specific info
+    NetworkConfig network;  ///< Network-specific config
+};
+
+/**
+ * @brief Config sections, as bits of a dirty mask.
+ */
+enum ConfigSection : uint8_t {
+    CONFIG_SECTION_INFO = 1 << 0,     ///< DeviceConfig::info
+    CONFIG_SECTION_NETWORK = 1 << 1,  ///< DeviceConfig::network
+    CONFIG_SECTION_ALL = CONFIG_SECTION_INFO | CONFIG_SECTION_NETWORK,
+};
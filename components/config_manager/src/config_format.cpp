@@ -0,0 +1,157 @@
+#include "config_format.hpp"
+
+#include <cstddef>
+#include <cstring>
+
+constexpr size_t MIGRATION_BUFFER_LEN = 256;
+
+// Frozen payload sizes of older schemas
+constexpr size_t NETWORK_CONFIG_V1_SIZE = 182;  // Up to and including mac_address
+
+static_assert(NETWORK_CONFIG_V1_SIZE == offsetof(NetworkConfig, password),
+              "Version 2 only appends to NetworkConfig");
+
+/**
+ * @brief One upgrade step of a section's schema.
+ */
+struct ConfigMigration {
+    ConfigSection section;
+    uint16_t from_version;  ///< Produces from_version + 1
+    size_t from_size;       ///< Payload size at from_version
+    size_t to_size;         ///< Payload size at from_version + 1
+    void (*migrate)(const uint8_t* in, uint8_t* out);
+};
+
+template <size_t N>
+static void copyUnchanged(const uint8_t* in, uint8_t* out) {
+    memcpy(out, in, N);
+}
+
+// Copies the old payload and zeroes the fields a newer version appends
+template <size_t From, size_t To>
+static void zeroExtend(const uint8_t* in, uint8_t* out) {
+    memcpy(out, in, From);
+    memset(out + From, 0, To - From);
+}
+
+// Append a step here whenever a section struct changes, and bump its
+// CONFIG_*_VERSION. Steps run in order until the blob reaches the current
+// version, so old devices can skip any number of releases.
+constexpr ConfigMigration MIGRATIONS[] = {
+    // Version 0 is the raw struct stored before the header existed; same layout as 1
+    {CONFIG_SECTION_INFO, 0, sizeof(DeviceInfo), sizeof(DeviceInfo),
+     copyUnchanged<sizeof(DeviceInfo)>},
+    {CONFIG_SECTION_NETWORK, 0, NETWORK_CONFIG_V1_SIZE, NETWORK_CONFIG_V1_SIZE,
+     copyUnchanged<NETWORK_CONFIG_V1_SIZE>},
+    // Version 2 adds the STA password and the channel cached next to bssid
+    {CONFIG_SECTION_NETWORK, 1, NETWORK_CONFIG_V1_SIZE, sizeof(NetworkConfig),
+     zeroExtend<NETWORK_CONFIG_V1_SIZE, sizeof(NetworkConfig)>},
+};
+
+static const ConfigMigration* findMigration(ConfigSection section, uint16_t from_version) {
+    for (const ConfigMigration& step : MIGRATIONS) {
+        if (step.section == section && step.from_version == from_version) return &step;
+    }
+    return nullptr;
+}
+
+uint32_t configCrc32(const void* data, size_t len, uint32_t crc) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    while (len--) {
+        crc ^= *p++;
+        for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+    }
+    return ~crc;
+}
+
+uint16_t configSectionVersion(ConfigSection section) {
+    switch (section) {
+        case CONFIG_SECTION_INFO:
+            return CONFIG_INFO_VERSION;
+        case CONFIG_SECTION_NETWORK:
+            return CONFIG_NETWORK_VERSION;
+        default:
+            return 0;
+    }
+}
+
+size_t configSectionSize(ConfigSection section) {
+    switch (section) {
+        case CONFIG_SECTION_INFO:
+            return sizeof(DeviceInfo);
+        case CONFIG_SECTION_NETWORK:
+            return sizeof(NetworkConfig);
+        default:
+            return 0;
+    }
+}
+
+size_t configSectionSizeAt(ConfigSection section, uint16_t version) {
+    if (version == configSectionVersion(section)) return configSectionSize(section);
+    const ConfigMigration* step = findMigration(section, version);
+    return step ? step->from_size : 0;
+}
+
+/**
+ * @brief CRC over the version, length and payload, so a flipped header bit is caught too
+ */
+static uint32_t blobCrc(const ConfigBlobHeader& header, const uint8_t* payload) {
+    uint32_t crc = configCrc32(&header.version, sizeof(header.version));
+    crc = configCrc32(&header.length, sizeof(header.length), crc);
+    return configCrc32(payload, header.length, crc);
+}
+
+size_t configEncode(ConfigSection section, const void* payload, uint8_t* out, size_t cap) {
+    size_t size = configSectionSize(section);
+    size_t len = sizeof(ConfigBlobHeader) + size;
+    if (size == 0 || len > cap) return 0;
+
+    ConfigBlobHeader header = {CONFIG_BLOB_MAGIC, configSectionVersion(section),
+                               static_cast<uint16_t>(size), 0};
+    header.crc = blobCrc(header, static_cast<const uint8_t*>(payload));
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + sizeof(header), payload, size);
+    return len;
+}
+
+ConfigDecodeStatus configDecode(ConfigSection section, const uint8_t* blob, size_t len,
+                                void* out) {
+    const uint8_t* payload = blob;
+    size_t payload_len = len;
+    uint16_t version = 0;
+
+    ConfigBlobHeader header = {};
+    if (len >= sizeof(header)) memcpy(&header, blob, sizeof(header));
+    if (header.magic == CONFIG_BLOB_MAGIC) {
+        payload += sizeof(header);
+        payload_len -= sizeof(header);
+        if (header.length != payload_len || header.crc != blobCrc(header, payload)) {
+            return ConfigDecodeStatus::Corrupt;
+        }
+        version = header.version;
+    }
+
+    uint16_t current = configSectionVersion(section);
+    if (current == 0 || version > current) return ConfigDecodeStatus::Unsupported;
+
+    // Ping-pong between two buffers so each step reads the previous step's output
+    uint8_t buffers[2][MIGRATION_BUFFER_LEN];
+    size_t next = 0;
+    bool migrated = false;
+    for (; version < current; version++) {
+        const ConfigMigration* step = findMigration(section, version);
+        if (!step || step->to_size > MIGRATION_BUFFER_LEN) return ConfigDecodeStatus::Unsupported;
+        if (payload_len != step->from_size) return ConfigDecodeStatus::Corrupt;
+
+        step->migrate(payload, buffers[next]);
+        payload = buffers[next];
+        payload_len = step->to_size;
+        next ^= 1;
+        migrated = true;
+    }
+
+    if (payload_len != configSectionSize(section)) return ConfigDecodeStatus::Corrupt;
+    memcpy(out, payload, payload_len);
+    return migrated ? ConfigDecodeStatus::Migrated : ConfigDecodeStatus::Ok;
+}
@@ -1,15 +1,68 @@
 #include "config_manager.hpp"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
 #include <mutex>
 
+#include "config_format.hpp"
 #include "esp_log.h"
 #include "nvs.h"
 #include "nvs_flash.h"
 
 static const char* TAG = "config_manager";
+
+/// Set in SnapshotSlot::pins while a writer fills the slot; readers back off
+static constexpr uint32_t SLOT_WRITING = 0x80000000u;
+
+static_assert(CONFIG_CONFIG_MANAGER_SNAPSHOT_SLOTS >= 3,
+              "need a current slot, a slot to fill and at least one to pin");
+
+ConfigSnapshot& ConfigSnapshot::operator=(ConfigSnapshot&& other) noexcept {
+    if (this != &other) {
+        if (pins_) pins_->fetch_sub(1, std::memory_order_release);
+        pins_ = other.pins_;
+        config_ = other.config_;
+        other.pins_ = nullptr;
+        other.config_ = nullptr;
+    }
+    return *this;
+}
+
+ConfigSnapshot::~ConfigSnapshot() {
+    // Release orders our reads of the slot before a writer can reclaim it
+    if (pins_) pins_->fetch_sub(1, std::memory_order_release);
+}
 constexpr const char* NVS_NAMESPACE = "storage";
-constexpr const char* NVS_KEY = "dev_config";
+constexpr const char* LEGACY_NVS_KEY = "dev_config";  // Whole DeviceConfig, before per-section keys
+
+/**
+ * @brief Where each config section lives in NVS and in DeviceConfig.
+ */
+struct SectionKey {
+    ConfigSection section;
+    const char* key;
+    size_t offset;
+};
+
+constexpr SectionKey SECTION_KEYS[] = {
+    {CONFIG_SECTION_INFO, "dev_info", offsetof(DeviceConfig, info)},
+    {CONFIG_SECTION_NETWORK, "net_config", offsetof(DeviceConfig, network)},
+};
+
+constexpr uint32_t FLUSH_TASK_STACK = 3072;
+constexpr UBaseType_t FLUSH_TASK_PRIORITY = 2;  // Below httpd and the sensor task
+constexpr TickType_t FLUSH_DELAY = pdMS_TO_TICKS(CONFIG_CONFIG_MANAGER_FLUSH_DELAY_MS);
+constexpr TickType_t FLUSH_MAX_LATENCY = pdMS_TO_TICKS(CONFIG_CONFIG_MANAGER_FLUSH_MAX_LATENCY_MS);
+// Wait after a failed write, doubled on every further failure
+constexpr TickType_t FLUSH_RETRY_MIN = pdMS_TO_TICKS(1000);
+constexpr TickType_t FLUSH_RETRY_MAX = pdMS_TO_TICKS(60000);
+
+static_assert(FLUSH_DELAY > 0 && FLUSH_MAX_LATENCY > 0,
+              "A zero flush deadline would make the flush task spin");
+
+constexpr uint32_t BUS_TASK_STACK = 4096;  // Subscribers reconfigure Wi-Fi from here
+constexpr UBaseType_t BUS_TASK_PRIORITY = 1;
 
 /**
  * @brief Get singleton instance of ConfigManager
@@ -27,13 +80,74 @@ ConfigManager& ConfigManager::getInstance() {
 ConfigManager::ConfigManager() {
     ESP_LOGI(TAG, "Initializing ConfigManager");
 
-    if (loadFromNVS() != ESP_OK || !isValid()) {
-        ESP_LOGW(TAG, "Invalid or missing config, using defaults");
-        setDefaults();
-        saveToNVS();
+    if (loadFromNVS() != ESP_OK) {
+        // Sections that failed were reset on their own; write them inline, the
+        // flush task does not exist yet
+        ESP_LOGW(TAG, "Invalid or missing config sections, using defaults for them");
+        flush();
     } else {
         ESP_LOGI(TAG, "Loaded valid config from NVS");
     }
+
+    if (xTaskCreate(flushTask, "config_flush", FLUSH_TASK_STACK, this, FLUSH_TASK_PRIORITY,
+                    &flush_task_) != pdPASS) {
+        flush_task_ = nullptr;
+        ESP_LOGE(TAG, "Failed to create flush task, updates will be written synchronously");
+    }
+
+    if (xTaskCreate(busTask, "config_bus", BUS_TASK_STACK, this, BUS_TASK_PRIORITY, &bus_task_) !=
+        pdPASS) {
+        bus_task_ = nullptr;
+        ESP_LOGE(TAG, "Failed to create bus task, change callbacks are disabled");
+    }
+}
+
+/**
+ * @brief Get the current config snapshot
+ *
+ * Lock-free: pins the published slot with one atomic increment. Retries only
+ * if a writer reclaimed the slot between loading the index and pinning it.
+ *
+ * @return Handle pinning an immutable DeviceConfig
+ */
+ConfigSnapshot ConfigManager::getSnapshot() const {
+    for (;;) {
+        SnapshotSlot& slot = slots_[current_.load(std::memory_order_acquire)];
+        // Acquire pairs with the release that ended the slot's last write
+        uint32_t prev = slot.pins.fetch_add(1, std::memory_order_acquire);
+        if (!(prev & SLOT_WRITING)) return ConfigSnapshot(&slot.pins, &slot.config);
+        slot.pins.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Claim a snapshot slot for the next publish
+ *
+ * Caller must hold mutex_, so there is only ever one writer. Waits while every
+ * other slot is pinned by a reader.
+ *
+ * @return Index of a slot marked SLOT_WRITING
+ */
+uint8_t ConfigManager::claimSlot() {
+    uint8_t current = current_.load(std::memory_order_relaxed);
+    bool warned = false;
+    for (;;) {
+        for (uint8_t i = 0; i < CONFIG_CONFIG_MANAGER_SNAPSHOT_SLOTS; i++) {
+            if (i == current) continue;
+            uint32_t expected = 0;
+            // Acquire pairs with the release of the last reader unpinning it
+            if (slots_[i].pins.compare_exchange_strong(expected, SLOT_WRITING,
+                                                       std::memory_order_acquire,
+                                                       std::memory_order_relaxed)) {
+                return i;
+            }
+        }
+        if (!warned) {
+            ESP_LOGW(TAG, "All config snapshot slots pinned, waiting");
+            warned = true;
+        }
+        vTaskDelay(1);
+    }
 }
 
 /**
@@ -42,21 +156,24 @@ ConfigManager::ConfigManager() {
  * @return DeviceInfo structure
  */
 DeviceInfo ConfigManager::getDeviceInfo() {
-    std::lock_guard<std::mutex> lock(mutex_);
     ESP_LOGD(TAG, "Returning device info");
-    return config_.info;
+    return getSnapshot()->info;
 }
 
 /**
- * @brief Update device info and save to NVS
+ * @brief Update device info and schedule a flush
  *
  * @param info New device info
  */
 void ConfigManager::updateDeviceInfo(const DeviceInfo& info) {
-    std::lock_guard<std::mutex> lock(mutex_);
     ESP_LOGI(TAG, "Updating device info: name=%s, fw=%s", info.device_name, info.firmware_version);
-    config_.info = info;
-    saveToNVS();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        DeviceConfig next = *getSnapshot();
+        next.info = info;
+        publish(next);
+    }
+    scheduleFlush();
 }
 
 /**
@@ -65,21 +182,24 @@ void ConfigManager::updateDeviceInfo(const DeviceInfo& info) {
  * @return NetworkConfig structure
  */
 NetworkConfig ConfigManager::getNetworkConfig() {
-    std::lock_guard<std::mutex> lock(mutex_);
     ESP_LOGD(TAG, "Returning network config");
-    return config_.network;
+    return getSnapshot()->network;
 }
 
 /**
- * @brief Update network configuration and save to NVS
+ * @brief Update network configuration and schedule a flush
  *
  * @param netConfig New network configuration
  */
 void ConfigManager::updateNetworkConfig(const NetworkConfig& netConfig) {
-    std::lock_guard<std::mutex> lock(mutex_);
     ESP_LOGI(TAG, "Updating network config: AP=%s", netConfig.ap_ssid);
-    config_.network = netConfig;
-    saveToNVS();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        DeviceConfig next = *getSnapshot();
+        next.network = netConfig;
+        publish(next);
+    }
+    scheduleFlush();
 }
 
 /**
@@ -88,32 +208,219 @@ void ConfigManager::updateNetworkConfig(const NetworkConfig& netConfig) {
  * @return DeviceConfig structure
  */
 DeviceConfig ConfigManager::getConfig() {
-    std::lock_guard<std::mutex> lock(mutex_);
     ESP_LOGD(TAG, "Returning full config");
-    return config_;
+    return *getSnapshot();
 }
 
 /**
- * @brief Update full configuration and save to NVS
+ * @brief Update full configuration and schedule a flush
  *
  * @param newConfig New configuration
  */
 void ConfigManager::updateConfig(const DeviceConfig& newConfig) {
-    std::lock_guard<std::mutex> lock(mutex_);
     ESP_LOGI(TAG, "Updating full config");
-    config_ = newConfig;
-    saveToNVS();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        publish(newConfig);
+    }
+    scheduleFlush();
 }
 
 /**
- * @brief Save current config to NVS
+ * @brief Publish a new snapshot and mark the sections that differ as dirty
+ *
+ * Caller must hold mutex_. Readers holding the old snapshot keep its slot
+ * pinned until they drop it.
+ *
+ * @param next New configuration
+ */
+void ConfigManager::publish(const DeviceConfig& next) {
+    // Only writers change slots_[current_], and the caller holds mutex_
+    const DeviceConfig& current = slots_[current_.load(std::memory_order_relaxed)].config;
+    uint8_t changed = 0;
+    if (!published_ || memcmp(&current.info, &next.info, sizeof(next.info)) != 0) {
+        changed |= CONFIG_SECTION_INFO;
+    }
+    if (!published_ || memcmp(&current.network, &next.network, sizeof(next.network)) != 0) {
+        changed |= CONFIG_SECTION_NETWORK;
+    }
+    if (changed) markDirty(changed);
+
+    uint8_t index = claimSlot();
+    SnapshotSlot& slot = slots_[index];
+    slot.config = next;
+    slot.pins.fetch_and(~SLOT_WRITING, std::memory_order_release);
+    current_.store(index, std::memory_order_release);
+    published_ = true;
+    generation_.fetch_add(1, std::memory_order_release);
+
+    if (changed) {
+        pending_changes_.fetch_or(changed, std::memory_order_release);
+        if (bus_task_) xTaskNotifyGive(bus_task_);
+    }
+}
+
+/**
+ * @brief Subscribe to changes of the given sections
+ *
+ * @param sections Mask of ConfigSection bits
+ * @param callback Function called on the bus task
+ * @param arg Passed through to callback
+ * @return int Subscription id, or -1 if no slot is free
+ */
+int ConfigManager::subscribe(uint8_t sections, ConfigChangeCallback callback, void* arg) {
+    if (!sections || !callback) return -1;
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+
+    for (int id = 0; id < CONFIG_CONFIG_MANAGER_MAX_SUBSCRIBERS; id++) {
+        if (subscribers_[id].callback) continue;
+        subscribers_[id] = {sections, callback, arg};
+        return id;
+    }
+    ESP_LOGE(TAG, "No free config subscriber slot");
+    return -1;
+}
+
+/**
+ * @brief Remove a subscription
+ *
+ * @param id Value returned by subscribe()
+ */
+void ConfigManager::unsubscribe(int id) {
+    if (id < 0 || id >= CONFIG_CONFIG_MANAGER_MAX_SUBSCRIBERS) return;
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    subscribers_[id] = {};
+}
+
+/**
+ * @brief Get the configuration generation
+ *
+ * @return Counter bumped on every config change
+ */
+uint32_t ConfigManager::getGeneration() const {
+    return generation_.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Get the sections not yet written to NVS
+ *
+ * @return Mask of ConfigSection bits
+ */
+uint8_t ConfigManager::getDirtySections() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dirty_;
+}
+
+/**
+ * @brief Get the number of successful NVS commits
+ *
+ * @return Commit counter
+ */
+uint32_t ConfigManager::getFlushCount() const {
+    return flush_count_.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Mark sections dirty, restarting the quiet period
+ *
+ * Caller must hold mutex_.
+ *
+ * @param sections ConfigSection bits
+ */
+void ConfigManager::markDirty(uint8_t sections) {
+    TickType_t now = xTaskGetTickCount();
+    if (!dirty_) first_dirty_ = now;
+    dirty_ |= sections;
+    last_change_ = now;
+}
+
+/**
+ * @brief Hand pending changes to the flush task
+ */
+void ConfigManager::scheduleFlush() {
+    if (flush_task_) {
+        xTaskNotifyGive(flush_task_);
+    } else {
+        flush();
+    }
+}
+
+/**
+ * @brief Write dirty sections to NVS now
+ *
+ * The snapshot is written without holding mutex_, so updaters never wait on
+ * flash, and readers never take mutex_ at all.
  *
  * @return esp_err_t ESP_OK on success or error code
  */
-esp_err_t ConfigManager::saveToNVS() {
+esp_err_t ConfigManager::flush() {
+    std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+
+    ConfigSnapshot snapshot;
+    uint8_t sections;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sections = dirty_;
+        if (!sections) return ESP_OK;
+        snapshot = getSnapshot();
+        dirty_ = 0;
+    }
+
+    esp_err_t err = writeToNVS(*snapshot, sections);
     std::lock_guard<std::mutex> lock(mutex_);
-    ESP_LOGI(TAG, "Saving device config to NVS");
+    if (err != ESP_OK) {
+        // The flush task backs off before trying again, so failing flash is not hammered
+        retry_backoff_ = retry_backoff_ ? std::min<TickType_t>(retry_backoff_ * 2, FLUSH_RETRY_MAX)
+                                        : FLUSH_RETRY_MIN;
+        failed_at_ = xTaskGetTickCount();
+        markDirty(sections);
+    } else {
+        retry_backoff_ = 0;
+    }
+    return err;
+}
+
+/**
+ * @brief Save current config to NVS immediately
+ *
+ * @return esp_err_t ESP_OK on success or error code
+ */
+esp_err_t ConfigManager::saveToNVS() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        markDirty(CONFIG_SECTION_ALL);
+    }
+    return flush();
+}
 
+/**
+ * @brief Check whether NVS already holds exactly this blob
+ *
+ * @param nvs Open NVS handle
+ * @param key Section key
+ * @param data Encoded section blob
+ * @param size Blob size
+ * @return true if the stored blob is identical
+ */
+static bool storedEquals(nvs_handle_t nvs, const char* key, const void* data, size_t size) {
+    uint8_t stored[CONFIG_BLOB_MAX_LEN];
+    size_t stored_size = sizeof(stored);
+    return nvs_get_blob(nvs, key, stored, &stored_size) == ESP_OK && stored_size == size &&
+           memcmp(stored, data, size) == 0;
+}
+
+/**
+ * @brief Write changed sections of a config snapshot to NVS and commit them
+ *
+ * Each section is stored with a versioned, CRC-protected header (see
+ * config_format.hpp). Sections whose stored blob already matches are skipped, and nothing is
+ * committed when no section changed.
+ *
+ * @param config Snapshot to write
+ * @param sections ConfigSection bits to consider
+ * @return esp_err_t ESP_OK on success or error code
+ */
+esp_err_t ConfigManager::writeToNVS(const DeviceConfig& config, uint8_t sections) {
     nvs_handle_t nvs;
     esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs);
     if (err != ESP_OK) {
@@ -121,16 +428,34 @@ esp_err_t ConfigManager::saveToNVS() {
         return err;
     }
 
-    err = nvs_set_blob(nvs, NVS_KEY, &config_, sizeof(config_));
-    if (err == ESP_OK) {
+    unsigned written = 0;
+    for (const SectionKey& section : SECTION_KEYS) {
+        if (!(sections & section.section)) continue;
+
+        uint8_t blob[CONFIG_BLOB_MAX_LEN];
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(&config) + section.offset;
+        size_t len = configEncode(section.section, data, blob, sizeof(blob));
+        if (storedEquals(nvs, section.key, blob, len)) continue;
+
+        err = nvs_set_blob(nvs, section.key, blob, len);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to set %s: %s", section.key, esp_err_to_name(err));
+            break;
+        }
+        written++;
+    }
+
+    // Drop the pre-section blob once its contents live under the section keys
+    if (err == ESP_OK && nvs_erase_key(nvs, LEGACY_NVS_KEY) == ESP_OK) written++;
+
+    if (err == ESP_OK && written > 0) {
         err = nvs_commit(nvs);
         if (err == ESP_OK) {
-            ESP_LOGI(TAG, "Config saved successfully");
+            flush_count_.fetch_add(1, std::memory_order_relaxed);
+            ESP_LOGI(TAG, "Config saved (%u entries changed)", written);
         } else {
             ESP_LOGE(TAG, "Failed to commit config: %s", esp_err_to_name(err));
         }
-    } else {
-        ESP_LOGE(TAG, "Failed to set config blob: %s", esp_err_to_name(err));
     }
 
     nvs_close(nvs);
@@ -138,58 +463,243 @@ esp_err_t ConfigManager::saveToNVS() {
 }
 
 /**
- * @brief Load config from NVS
+ * @brief Bus task entry point
  *
- * @return esp_err_t ESP_OK on success or error code
+ * @param arg ConfigManager instance
+ */
+void ConfigManager::busTask(void* arg) {
+    static_cast<ConfigManager*>(arg)->runBusTask();
+}
+
+/**
+ * @brief Deliver coalesced section changes to subscribers
+ */
+void ConfigManager::runBusTask() {
+    while (true) {
+        uint8_t changed = pending_changes_.exchange(0, std::memory_order_acquire);
+        if (!changed) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        // Callbacks run without the lock so they may subscribe or update the config
+        Subscriber subscribers[CONFIG_CONFIG_MANAGER_MAX_SUBSCRIBERS];
+        {
+            std::lock_guard<std::mutex> lock(subscribers_mutex_);
+            memcpy(subscribers, subscribers_, sizeof(subscribers));
+        }
+
+        ConfigSnapshot config = getSnapshot();
+        for (const Subscriber& subscriber : subscribers) {
+            uint8_t sections = changed & subscriber.sections;
+            if (subscriber.callback && sections) {
+                subscriber.callback(sections, *config, subscriber.arg);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Flush task entry point
+ *
+ * @param arg ConfigManager instance
+ */
+void ConfigManager::flushTask(void* arg) {
+    static_cast<ConfigManager*>(arg)->runFlushTask();
+}
+
+/**
+ * @brief Flush once updates go quiet or the oldest change reaches the latency bound
+ */
+void ConfigManager::runFlushTask() {
+    while (true) {
+        TickType_t wait = portMAX_DELAY;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (dirty_) {
+                TickType_t now = xTaskGetTickCount();
+                TickType_t quiet = now - last_change_;
+                TickType_t age = now - first_dirty_;
+                if (quiet >= FLUSH_DELAY || age >= FLUSH_MAX_LATENCY) {
+                    wait = 0;
+                } else {
+                    wait = std::min(FLUSH_DELAY - quiet, FLUSH_MAX_LATENCY - age);
+                }
+
+                TickType_t since_failure = now - failed_at_;
+                if (retry_backoff_ && since_failure < retry_backoff_) {
+                    wait = std::max(wait, retry_backoff_ - since_failure);
+                }
+            }
+        }
+
+        if (wait == 0) {
+            flush();
+        } else {
+            // Every update notifies us, so the deadline is recomputed after each change
+            ulTaskNotifyTake(pdTRUE, wait);
+        }
+    }
+}
+
+/**
+ * @brief Check that a fixed-size string field is terminated and non-empty
+ */
+static bool hasText(const char* field, size_t size) {
+    size_t len = strnlen(field, size);
+    return len > 0 && len < size;
+}
+
+static bool isValidDeviceInfo(const DeviceInfo& info) {
+    return hasText(info.device_name, sizeof(info.device_name)) &&
+           hasText(info.firmware_version, sizeof(info.firmware_version));
+}
+
+static bool isValidNetworkConfig(const NetworkConfig& network) {
+    return hasText(network.ap_ssid, sizeof(network.ap_ssid));
+}
+
+static DeviceInfo defaultDeviceInfo() {
+    DeviceInfo info = {};
+    strcpy(info.device_name, "esp32-project");
+    strcpy(info.firmware_version, "0.001");
+    return info;
+}
+
+static NetworkConfig defaultNetworkConfig() {
+    NetworkConfig network = {};
+    strcpy(network.ap_ssid, "ESP32_default_AP");
+    network.ap_enabled = true;
+    network.sta_enabled = false;
+    return network;
+}
+
+/**
+ * @brief Decode one stored section into a DeviceConfig
+ *
+ * @param section Section being decoded
+ * @param blob Stored bytes
+ * @param len Stored length
+ * @param config Receives the section on success
+ * @param migrated Gets the section bit if it was upgraded from an older schema
+ * @return esp_err_t ESP_OK, ESP_ERR_INVALID_CRC or ESP_ERR_NOT_SUPPORTED
+ */
+static esp_err_t decodeSection(const SectionKey& section, const uint8_t* blob, size_t len,
+                               DeviceConfig& config, uint8_t& migrated) {
+    uint8_t* out = reinterpret_cast<uint8_t*>(&config) + section.offset;
+    switch (configDecode(section.section, blob, len, out)) {
+        case ConfigDecodeStatus::Ok:
+            return ESP_OK;
+        case ConfigDecodeStatus::Migrated:
+            ESP_LOGI(TAG, "Migrated %s to version %u", section.key,
+                     configSectionVersion(section.section));
+            migrated |= section.section;
+            return ESP_OK;
+        case ConfigDecodeStatus::Corrupt:
+            return ESP_ERR_INVALID_CRC;
+        default:
+            return ESP_ERR_NOT_SUPPORTED;
+    }
+}
+
+/**
+ * @brief Load config from NVS, one section at a time
+ *
+ * A section that is missing, fails its CRC or validation, or comes from a
+ * newer schema is reset to its defaults and marked dirty; the other sections
+ * keep their stored values. Sections from an older schema, including the
+ * single blob written by older firmware, are migrated in place and rewritten
+ * in the current format on the next flush.
+ *
+ * @return esp_err_t ESP_OK if every section loaded, otherwise the first error
  */
 esp_err_t ConfigManager::loadFromNVS() {
     std::lock_guard<std::mutex> lock(mutex_);
     ESP_LOGI(TAG, "Loading device config from NVS");
 
     nvs_handle_t nvs;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(err));
-        return err;
+    esp_err_t result = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (result != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(result));
     }
 
-    size_t required_size = sizeof(config_);
-    err = nvs_get_blob(nvs, NVS_KEY, &config_, &required_size);
-    nvs_close(nvs);
+    DeviceConfig loaded = {};
+    uint8_t missing = 0;
+    uint8_t migrated = 0;
+    if (result == ESP_OK) {
+        for (const SectionKey& section : SECTION_KEYS) {
+            uint8_t blob[CONFIG_BLOB_MAX_LEN];
+            size_t len = sizeof(blob);
+            esp_err_t err = nvs_get_blob(nvs, section.key, blob, &len);
+            if (err == ESP_OK) err = decodeSection(section, blob, len, loaded, migrated);
+            if (err != ESP_OK) {
+                ESP_LOGW(TAG, "No valid %s found: %s", section.key, esp_err_to_name(err));
+                missing |= section.section;
+                if (result == ESP_OK) result = err;
+            }
+        }
 
-    if (err == ESP_OK) {
-        ESP_LOGI(TAG, "Config loaded successfully");
+        // The single blob is the version 0 sections back to back, as the
+        // DeviceConfig of that release laid them out
+        uint8_t legacy[sizeof(DeviceConfig)];
+        size_t legacy_len = 0;
+        for (const SectionKey& section : SECTION_KEYS) {
+            legacy_len += configSectionSizeAt(section.section, 0);
+        }
+        size_t size = sizeof(legacy);
+        if (missing == CONFIG_SECTION_ALL &&
+            nvs_get_blob(nvs, LEGACY_NVS_KEY, legacy, &size) == ESP_OK && size == legacy_len) {
+            ESP_LOGI(TAG, "Migrating single-blob config to per-section keys");
+            missing = 0;
+            result = ESP_OK;
+            size_t offset = 0;
+            for (const SectionKey& section : SECTION_KEYS) {
+                size_t len = configSectionSizeAt(section.section, 0);
+                decodeSection(section, legacy + offset, len, loaded, migrated);
+                offset += len;
+            }
+        }
+        nvs_close(nvs);
     } else {
-        ESP_LOGW(TAG, "No valid config found: %s", esp_err_to_name(err));
+        missing = CONFIG_SECTION_ALL;
     }
 
-    return err;
+    if (!(missing & CONFIG_SECTION_INFO) && !isValidDeviceInfo(loaded.info)) {
+        ESP_LOGW(TAG, "Stored device info is invalid");
+        missing |= CONFIG_SECTION_INFO;
+        if (result == ESP_OK) result = ESP_ERR_INVALID_STATE;
+    }
+    if (!(missing & CONFIG_SECTION_NETWORK) && !isValidNetworkConfig(loaded.network)) {
+        ESP_LOGW(TAG, "Stored network config is invalid");
+        missing |= CONFIG_SECTION_NETWORK;
+        if (result == ESP_OK) result = ESP_ERR_INVALID_STATE;
+    }
+
+    if (missing & CONFIG_SECTION_INFO) loaded.info = defaultDeviceInfo();
+    if (missing & CONFIG_SECTION_NETWORK) loaded.network = defaultNetworkConfig();
+    publish(loaded);
+    dirty_ = 0;  // Sections loaded as-is already match flash
+    if (missing | migrated) markDirty(missing | migrated);
+
+    if (result == ESP_OK) ESP_LOGI(TAG, "Config loaded successfully");
+    return result;
 }
 
 /**
- * @brief Set config to default values
+ * @brief Set config to default values and schedule a flush
  */
 void ConfigManager::setDefaults() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    ESP_LOGW(TAG, "Setting default config");
-
-    std::memset(&config_, 0, sizeof(config_));
-
-    // Device Info
-    strcpy(config_.info.device_name, "esp32-project");
-    strcpy(config_.info.firmware_version, "0.001");
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ESP_LOGW(TAG, "Setting default config");
 
-    // Network defaults
-    strcpy(config_.network.ap_ssid, "ESP32_default_AP");
-    config_.network.ap_password[0] = '\0';
-    config_.network.ap_enabled = true;
-    config_.network.sta_enabled = false;
-    config_.network.ssid[0] = '\0';
-    config_.network.bssid[0] = '\0';
-    config_.network.ip_address[0] = '\0';
-    config_.network.mac_address[0] = '\0';
-
-    ESP_LOGI(TAG, "Default config set");
+        DeviceConfig defaults = {};
+        defaults.info = defaultDeviceInfo();
+        defaults.network = defaultNetworkConfig();
+        publish(defaults);
+        ESP_LOGI(TAG, "Default config set");
+    }
+    scheduleFlush();
 }
 
 /**
@@ -198,11 +708,10 @@ void ConfigManager::setDefaults() {
  * @return true if valid, false otherwise
  */
 bool ConfigManager::isValid() {
-    std::lock_guard<std::mutex> lock(mutex_);
     bool valid = true;
 
-    if (strlen(config_.info.device_name) == 0 || strlen(config_.info.firmware_version) == 0 ||
-        strlen(config_.network.ap_ssid) == 0) {
+    ConfigSnapshot config = getSnapshot();
+    if (!isValidDeviceInfo(config->info) || !isValidNetworkConfig(config->network)) {
         valid = false;
     }
 
@@ -28,6 +28,19 @@ void test_validation_fails_with_empty_device_name();
 void test_validation_fails_with_empty_firmware_version();
 void test_validation_fails_with_empty_ap_ssid();
 void test_config_fails_to_load_with_wrong_blob_size();
+void test_legacy_single_blob_is_migrated();
+void test_generation_bumps_on_update();
+void test_updates_are_coalesced_until_flush();
+void test_flush_task_writes_after_quiet_period();
+void test_unchanged_sections_are_not_rewritten();
+void test_snapshots_are_immutable();
+void test_change_callbacks_are_coalesced_per_section();
+
+// config format tests
+void test_config_format_round_trips_current_version();
+void test_config_format_rejects_corrupt_blobs();
+void test_config_format_migrates_version_0();
+void test_config_format_migrates_network_version_1();
 
 #ifdef __cplusplus
 }
@@ -81,6 +94,50 @@ TEST_CASE("NVS: Load fails with wrong blob size, loads defaults", "[nvs]") {
     test_config_fails_to_load_with_wrong_blob_size();
 }
 
+TEST_CASE("NVS: Migrates the single-blob config", "[nvs]") {
+    test_legacy_single_blob_is_migrated();
+}
+
+TEST_CASE("Config: Generation bumps on every update", "[config]") {
+    test_generation_bumps_on_update();
+}
+
+TEST_CASE("NVS: Updates are coalesced until flush", "[nvs]") {
+    test_updates_are_coalesced_until_flush();
+}
+
+TEST_CASE("NVS: Flush task writes after quiet period", "[nvs]") {
+    test_flush_task_writes_after_quiet_period();
+}
+
+TEST_CASE("NVS: Unchanged sections are not rewritten", "[nvs]") {
+    test_unchanged_sections_are_not_rewritten();
+}
+
+TEST_CASE("Config: Snapshots are immutable", "[config]") {
+    test_snapshots_are_immutable();
+}
+
+TEST_CASE("Config: Change callbacks are coalesced per section", "[config]") {
+    test_change_callbacks_are_coalesced_per_section();
+}
+
+TEST_CASE("Format: Round-trips current version", "[format]") {
+    test_config_format_round_trips_current_version();
+}
+
+TEST_CASE("Format: Rejects corrupt blobs", "[format]") {
+    test_config_format_rejects_corrupt_blobs();
+}
+
+TEST_CASE("Format: Migrates version 0 blobs", "[format]") {
+    test_config_format_migrates_version_0();
+}
+
+TEST_CASE("Format: Migrates network version 1 blobs", "[format]") {
+    test_config_format_migrates_network_version_1();
+}
+
 void app_main(void) {
     // Global test setup before UNITY_BEGIN
     esp_err_t ret = nvs_flash_init();
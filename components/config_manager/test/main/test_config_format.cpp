@@ -0,0 +1,115 @@
+#include <cstddef>
+#include <cstring>
+
+#include "config_format.hpp"
+#include "unity.h"
+
+static DeviceInfo sampleInfo() {
+    DeviceInfo info = {};
+    strcpy(info.device_name, "format-device");
+    strcpy(info.firmware_version, "1.2.3");
+    return info;
+}
+
+/// @brief Verifies the CRC and an encode/decode round-trip at the current version.
+extern "C" void test_config_format_round_trips_current_version() {
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, configCrc32("123456789", 9));
+
+    DeviceInfo info = sampleInfo();
+    uint8_t blob[CONFIG_BLOB_MAX_LEN];
+    size_t len = configEncode(CONFIG_SECTION_INFO, &info, blob, sizeof(blob));
+    TEST_ASSERT_EQUAL(sizeof(ConfigBlobHeader) + sizeof(DeviceInfo), len);
+    TEST_ASSERT_EQUAL(0, configEncode(CONFIG_SECTION_INFO, &info, blob, len - 1));
+
+    DeviceInfo out = {};
+    TEST_ASSERT_EQUAL(ConfigDecodeStatus::Ok, configDecode(CONFIG_SECTION_INFO, blob, len, &out));
+    TEST_ASSERT_EQUAL_MEMORY(&info, &out, sizeof(info));
+}
+
+/// @brief Verifies that damaged blobs and unknown versions are rejected.
+extern "C" void test_config_format_rejects_corrupt_blobs() {
+    NetworkConfig net = {};
+    strcpy(net.ap_ssid, "FormatAP");
+    uint8_t blob[CONFIG_BLOB_MAX_LEN];
+    size_t len = configEncode(CONFIG_SECTION_NETWORK, &net, blob, sizeof(blob));
+    NetworkConfig out;
+
+    // Flipped payload bit, flipped version bit, truncated blob
+    blob[len - 1] ^= 0x01;
+    TEST_ASSERT_EQUAL(ConfigDecodeStatus::Corrupt,
+                      configDecode(CONFIG_SECTION_NETWORK, blob, len, &out));
+    blob[len - 1] ^= 0x01;
+    blob[offsetof(ConfigBlobHeader, version)] ^= 0x02;
+    TEST_ASSERT_EQUAL(ConfigDecodeStatus::Corrupt,
+                      configDecode(CONFIG_SECTION_NETWORK, blob, len, &out));
+    blob[offsetof(ConfigBlobHeader, version)] ^= 0x02;
+    TEST_ASSERT_EQUAL(ConfigDecodeStatus::Corrupt,
+                      configDecode(CONFIG_SECTION_NETWORK, blob, len - 1, &out));
+
+    // A well-formed blob from newer firmware
+    ConfigBlobHeader header = {CONFIG_BLOB_MAGIC, CONFIG_NETWORK_VERSION + 1, 4, 0};
+    uint8_t payload[4] = {1, 2, 3, 4};
+    header.crc = configCrc32(&header.version, sizeof(header.version));
+    header.crc = configCrc32(&header.length, sizeof(header.length), header.crc);
+    header.crc = configCrc32(payload, sizeof(payload), header.crc);
+    memcpy(blob, &header, sizeof(header));
+    memcpy(blob + sizeof(header), payload, sizeof(payload));
+    TEST_ASSERT_EQUAL(ConfigDecodeStatus::Unsupported,
+                      configDecode(CONFIG_SECTION_NETWORK, blob, sizeof(header) + 4, &out));
+}
+
+/// @brief Verifies that headerless blobs from older firmware migrate to the current version.
+extern "C" void test_config_format_migrates_version_0() {
+    DeviceInfo info = sampleInfo();
+    DeviceInfo out = {};
+    const uint8_t* raw = reinterpret_cast<const uint8_t*>(&info);
+
+    TEST_ASSERT_EQUAL(ConfigDecodeStatus::Migrated,
+                      configDecode(CONFIG_SECTION_INFO, raw, sizeof(info), &out));
+    TEST_ASSERT_EQUAL_MEMORY(&info, &out, sizeof(info));
+
+    // A raw blob of any other size cannot be an old struct
+    TEST_ASSERT_EQUAL(ConfigDecodeStatus::Corrupt,
+                      configDecode(CONFIG_SECTION_INFO, raw, sizeof(info) - 1, &out));
+    TEST_ASSERT_EQUAL(ConfigDecodeStatus::Corrupt, configDecode(CONFIG_SECTION_INFO, raw, 0, &out));
+
+    // Re-encoding the migrated section yields a current-version blob
+    uint8_t blob[CONFIG_BLOB_MAX_LEN];
+    size_t len = configEncode(CONFIG_SECTION_INFO, &out, blob, sizeof(blob));
+    TEST_ASSERT_EQUAL(ConfigDecodeStatus::Ok, configDecode(CONFIG_SECTION_INFO, blob, len, &out));
+}
+
+/// @brief Verifies that a version 1 network blob gains an empty STA password and channel.
+extern "C" void test_config_format_migrates_network_version_1() {
+    NetworkConfig net = {};
+    strcpy(net.ap_ssid, "FormatAP");
+    strcpy(net.ssid, "HomeNet");
+    strcpy(net.bssid, "02:00:00:5A:11:01");
+    strcpy(net.mac_address, "02:00:00:00:00:01");
+    net.sta_enabled = true;
+
+    // Version 1 ended at mac_address
+    const uint16_t v1_len = offsetof(NetworkConfig, password);
+    TEST_ASSERT_EQUAL(v1_len, configSectionSizeAt(CONFIG_SECTION_NETWORK, 1));
+    ConfigBlobHeader header = {CONFIG_BLOB_MAGIC, 1, v1_len, 0};
+    header.crc = configCrc32(&header.version, sizeof(header.version));
+    header.crc = configCrc32(&header.length, sizeof(header.length), header.crc);
+    header.crc = configCrc32(&net, v1_len, header.crc);
+    uint8_t blob[CONFIG_BLOB_MAX_LEN];
+    memcpy(blob, &header, sizeof(header));
+    memcpy(blob + sizeof(header), &net, v1_len);
+
+    NetworkConfig out;
+    memset(&out, 0xAA, sizeof(out));
+    TEST_ASSERT_EQUAL(ConfigDecodeStatus::Migrated,
+                      configDecode(CONFIG_SECTION_NETWORK, blob, sizeof(header) + v1_len, &out));
+    TEST_ASSERT_EQUAL_MEMORY(&net, &out, v1_len);
+    TEST_ASSERT_EQUAL_STRING("", out.password);
+    TEST_ASSERT_EQUAL(0, out.channel);
+
+    // Headerless version 0 blobs take both steps
+    TEST_ASSERT_EQUAL(ConfigDecodeStatus::Migrated,
+                      configDecode(CONFIG_SECTION_NETWORK, blob + sizeof(header), v1_len, &out));
+    TEST_ASSERT_EQUAL_STRING("HomeNet", out.ssid);
+    TEST_ASSERT_EQUAL(0, out.channel);
+}
@@ -1,5 +1,7 @@
+#include <cstdio>
 #include <cstring>
 
+#include "config_format.hpp"
 #include "config_manager.hpp"
 #include "nvs_flash.h"
 #include "unity.h"
@@ -177,18 +179,238 @@ extern "C" void test_validation_fails_with_empty_ap_ssid() {
     TEST_ASSERT_FALSE(cm.isValid());
 }
 
-/// @brief Tests what happens when the config blob size is incorrect.
+/// @brief Tests that a section with the wrong blob size falls back to defaults on its own.
 extern "C" void test_config_fails_to_load_with_wrong_blob_size() {
+    resetConfigManagerForTest();
+    ConfigManager& cm = ConfigManager::getInstance();
+    NetworkConfig net = cm.getNetworkConfig();
+    strcpy(net.ap_ssid, "KeptAP");
+    cm.updateNetworkConfig(net);
+    TEST_ASSERT_EQUAL(ESP_OK, cm.flush());
+
     // Manually simulate incorrect blob write
     nvs_handle_t nvs;
     TEST_ASSERT_EQUAL(ESP_OK, nvs_open("storage", NVS_READWRITE, &nvs));
     uint8_t fake_data[10] = {0};  // too small
-    TEST_ASSERT_EQUAL(ESP_OK, nvs_set_blob(nvs, "dev_config", fake_data, sizeof(fake_data)));
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_set_blob(nvs, "dev_info", fake_data, sizeof(fake_data)));
     TEST_ASSERT_EQUAL(ESP_OK, nvs_commit(nvs));
     nvs_close(nvs);
 
-    ConfigManager& cm = ConfigManager::getInstance();
-    // Should reload defaults after failing to load
+    // Should reload defaults for the broken section only
+    TEST_ASSERT_NOT_EQUAL(ESP_OK, cm.loadFromNVS());
     DeviceInfo info = cm.getDeviceInfo();
     TEST_ASSERT_EQUAL_STRING("esp32-project", info.device_name);
+    TEST_ASSERT_EQUAL_STRING("KeptAP", cm.getNetworkConfig().ap_ssid);
+    TEST_ASSERT_EQUAL(CONFIG_SECTION_INFO, cm.getDirtySections());
+    TEST_ASSERT_EQUAL(ESP_OK, cm.flush());
+}
+
+/// @brief Verifies that a pre-section dev_config blob is split into the section keys.
+extern "C" void test_legacy_single_blob_is_migrated() {
+    resetConfigManagerForTest();
+    ConfigManager& cm = ConfigManager::getInstance();
+
+    // The baseline DeviceConfig: both version 0 sections back to back
+    const size_t info_len = configSectionSizeAt(CONFIG_SECTION_INFO, 0);
+    const size_t net_len = configSectionSizeAt(CONFIG_SECTION_NETWORK, 0);
+    TEST_ASSERT_EQUAL(230, info_len + net_len);
+
+    DeviceInfo info = cm.getDeviceInfo();
+    NetworkConfig net = cm.getNetworkConfig();
+    strcpy(info.device_name, "legacy-device");
+    strcpy(net.ap_ssid, "LegacyAP");
+    uint8_t legacy[230];
+    memcpy(legacy, &info, info_len);
+    memcpy(legacy + info_len, &net, net_len);
+
+    nvs_handle_t nvs;
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_open("storage", NVS_READWRITE, &nvs));
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_erase_key(nvs, "dev_info"));
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_erase_key(nvs, "net_config"));
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_set_blob(nvs, "dev_config", legacy, sizeof(legacy)));
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_commit(nvs));
+    nvs_close(nvs);
+
+    TEST_ASSERT_EQUAL(ESP_OK, cm.loadFromNVS());
+    TEST_ASSERT_EQUAL_STRING("legacy-device", cm.getDeviceInfo().device_name);
+    TEST_ASSERT_EQUAL_STRING("LegacyAP", cm.getNetworkConfig().ap_ssid);
+    TEST_ASSERT_EQUAL(CONFIG_SECTION_ALL, cm.getDirtySections());
+
+    // The flush writes both section keys and drops the old blob
+    TEST_ASSERT_EQUAL(ESP_OK, cm.flush());
+    TEST_ASSERT_EQUAL(0, cm.getDirtySections());
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_open("storage", NVS_READONLY, &nvs));
+    size_t len = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_get_blob(nvs, "dev_info", nullptr, &len));
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_get_blob(nvs, "net_config", nullptr, &len));
+    TEST_ASSERT_EQUAL(ESP_ERR_NVS_NOT_FOUND, nvs_get_blob(nvs, "dev_config", nullptr, &len));
+    nvs_close(nvs);
+
+    // And the next boot reads the sections as-is
+    TEST_ASSERT_EQUAL(ESP_OK, cm.loadFromNVS());
+    TEST_ASSERT_EQUAL_STRING("legacy-device", cm.getDeviceInfo().device_name);
+    TEST_ASSERT_EQUAL(0, cm.getDirtySections());
+}
+
+/// @brief Verifies that every update bumps the generation counter.
+extern "C" void test_generation_bumps_on_update() {
+    resetConfigManagerForTest();
+    ConfigManager& cm = ConfigManager::getInstance();
+
+    uint32_t before = cm.getGeneration();
+    cm.updateDeviceInfo(cm.getDeviceInfo());
+    TEST_ASSERT_EQUAL_UINT32(before + 1, cm.getGeneration());
+
+    cm.updateNetworkConfig(cm.getNetworkConfig());
+    cm.updateConfig(cm.getConfig());
+    TEST_ASSERT_EQUAL_UINT32(before + 3, cm.getGeneration());
+
+    // Reads leave it alone
+    cm.getConfig();
+    TEST_ASSERT_EQUAL_UINT32(before + 3, cm.getGeneration());
+}
+
+/// @brief Verifies that a burst of updates is held in memory and written once.
+extern "C" void test_updates_are_coalesced_until_flush() {
+    resetConfigManagerForTest();
+    ConfigManager& cm = ConfigManager::getInstance();
+    TEST_ASSERT_EQUAL(0, cm.getDirtySections());
+    uint32_t before = cm.getFlushCount();
+
+    DeviceInfo info = cm.getDeviceInfo();
+    for (int i = 0; i < 5; i++) {
+        snprintf(info.device_name, sizeof(info.device_name), "burst-%d", i);
+        cm.updateDeviceInfo(info);
+    }
+    TEST_ASSERT_EQUAL(CONFIG_SECTION_INFO, cm.getDirtySections());
+    TEST_ASSERT_EQUAL_UINT32(before, cm.getFlushCount());
+
+    TEST_ASSERT_EQUAL(ESP_OK, cm.flush());
+    TEST_ASSERT_EQUAL(0, cm.getDirtySections());
+    TEST_ASSERT_EQUAL_UINT32(before + 1, cm.getFlushCount());
+
+    // Nothing left to write, and an update that changes nothing stays clean
+    TEST_ASSERT_EQUAL(ESP_OK, cm.flush());
+    cm.updateDeviceInfo(cm.getDeviceInfo());
+    TEST_ASSERT_EQUAL(0, cm.getDirtySections());
+    TEST_ASSERT_EQUAL_UINT32(before + 1, cm.getFlushCount());
+}
+
+/// @brief Verifies that the flush task writes pending changes after the quiet period.
+extern "C" void test_flush_task_writes_after_quiet_period() {
+    resetConfigManagerForTest();
+    ConfigManager& cm = ConfigManager::getInstance();
+    uint32_t before = cm.getFlushCount();
+
+    NetworkConfig net = cm.getNetworkConfig();
+    strcpy(net.ap_ssid, "DebouncedAP");
+    cm.updateNetworkConfig(net);
+    TEST_ASSERT_EQUAL(CONFIG_SECTION_NETWORK, cm.getDirtySections());
+
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_CONFIG_MANAGER_FLUSH_DELAY_MS + 500));
+    TEST_ASSERT_EQUAL(0, cm.getDirtySections());
+    TEST_ASSERT_EQUAL_UINT32(before + 1, cm.getFlushCount());
+}
+
+/// @brief Verifies that saving skips sections whose stored value is unchanged.
+extern "C" void test_unchanged_sections_are_not_rewritten() {
+    resetConfigManagerForTest();
+    ConfigManager& cm = ConfigManager::getInstance();
+    uint32_t before = cm.getFlushCount();
+
+    // Everything already matches NVS, so there is nothing to commit
+    TEST_ASSERT_EQUAL(ESP_OK, cm.saveToNVS());
+    TEST_ASSERT_EQUAL_UINT32(before, cm.getFlushCount());
+
+    DeviceInfo info = cm.getDeviceInfo();
+    strcpy(info.device_name, "diff-device");
+    cm.updateDeviceInfo(info);
+    TEST_ASSERT_EQUAL(ESP_OK, cm.saveToNVS());
+    TEST_ASSERT_EQUAL_UINT32(before + 1, cm.getFlushCount());
+
+    TEST_ASSERT_EQUAL(ESP_OK, cm.loadFromNVS());
+    TEST_ASSERT_EQUAL_STRING("diff-device", cm.getDeviceInfo().device_name);
+}
+
+/// @brief Verifies that a snapshot held by a reader is unaffected by later updates.
+extern "C" void test_snapshots_are_immutable() {
+    resetConfigManagerForTest();
+    ConfigManager& cm = ConfigManager::getInstance();
+
+    ConfigSnapshot before = cm.getSnapshot();
+    TEST_ASSERT_EQUAL_PTR(before.get(), cm.getSnapshot().get());
+
+    DeviceInfo info = cm.getDeviceInfo();
+    strcpy(info.device_name, "snapshot-device");
+    cm.updateDeviceInfo(info);
+
+    ConfigSnapshot after = cm.getSnapshot();
+    TEST_ASSERT_TRUE(before.get() != after.get());
+    TEST_ASSERT_EQUAL_STRING("esp32-project", before->info.device_name);
+    TEST_ASSERT_EQUAL_STRING("snapshot-device", after->info.device_name);
+    TEST_ASSERT_EQUAL_STRING(before->network.ap_ssid, after->network.ap_ssid);
+
+    // More updates than there are slots must not recycle a pinned one
+    for (int i = 0; i < 2 * CONFIG_CONFIG_MANAGER_SNAPSHOT_SLOTS; i++) {
+        snprintf(info.device_name, sizeof(info.device_name), "churn-%d", i);
+        cm.updateDeviceInfo(info);
+    }
+    TEST_ASSERT_EQUAL_STRING("esp32-project", before->info.device_name);
+    TEST_ASSERT_EQUAL_STRING("snapshot-device", after->info.device_name);
+}
+
+struct ChangeLog {
+    int calls;
+    uint8_t sections;
+    TaskHandle_t task;
+    char device_name[DEVICE_NAME_MAX_LEN];
+};
+
+static void recordChange(uint8_t sections, const DeviceConfig& config, void* arg) {
+    auto* log = static_cast<ChangeLog*>(arg);
+    log->calls++;
+    log->sections |= sections;
+    log->task = xTaskGetCurrentTaskHandle();
+    strcpy(log->device_name, config.info.device_name);
+}
+
+/// @brief Verifies that change callbacks are filtered, coalesced and run off the writer's task.
+extern "C" void test_change_callbacks_are_coalesced_per_section() {
+    resetConfigManagerForTest();
+    ConfigManager& cm = ConfigManager::getInstance();
+    vTaskDelay(pdMS_TO_TICKS(50));  // Let the reset above be delivered first
+
+    ChangeLog all = {};
+    ChangeLog network_only = {};
+    int all_id = cm.subscribe(CONFIG_SECTION_ALL, recordChange, &all);
+    int network_id = cm.subscribe(CONFIG_SECTION_NETWORK, recordChange, &network_only);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, all_id);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, network_id);
+
+    // Outrank the bus task so the whole burst is queued before it runs
+    UBaseType_t priority = uxTaskPriorityGet(nullptr);
+    vTaskPrioritySet(nullptr, priority + 1);
+    DeviceInfo info = cm.getDeviceInfo();
+    for (int i = 0; i < 5; i++) {
+        snprintf(info.device_name, sizeof(info.device_name), "bus-%d", i);
+        cm.updateDeviceInfo(info);
+    }
+    vTaskPrioritySet(nullptr, priority);
+    vTaskDelay(pdMS_TO_TICKS(50));
+
+    TEST_ASSERT_EQUAL(1, all.calls);
+    TEST_ASSERT_EQUAL(CONFIG_SECTION_INFO, all.sections);
+    TEST_ASSERT_EQUAL_STRING("bus-4", all.device_name);
+    TEST_ASSERT_TRUE(all.task != xTaskGetCurrentTaskHandle());
+    TEST_ASSERT_EQUAL(0, network_only.calls);
+
+    // An update that changes nothing is not announced
+    int calls = all.calls;
+    cm.updateDeviceInfo(info);
+    vTaskDelay(pdMS_TO_TICKS(50));
+    TEST_ASSERT_EQUAL(calls, all.calls);
+
+    cm.unsubscribe(all_id);
+    cm.unsubscribe(network_id);
+    TEST_ASSERT_EQUAL(ESP_OK, cm.flush());
 }
@@ -2,21 +2,66 @@
 
 #include <cstdint>
 
-#include "driver/gpio.h"
+#include "onewire_bus.hpp"
+
+#define DS18B20_SCRATCHPAD_LEN 9
+#define DS18B20_DEFAULT_RETRIES 2
+
+/**
+ * @brief Per-sensor read health counters.
+ */
+struct DS18B20Stats {
+    uint32_t reads;        ///< Scratchpad reads that passed CRC
+    uint32_t crc_errors;   ///< Reads rejected by CRC or sanity check
+    uint32_t no_presence;  ///< Reads where nothing answered the reset pulse
+    uint32_t retries;      ///< Scratchpad re-reads after a failed attempt
+    uint32_t failures;     ///< fetchResult() calls that exhausted every retry
+};
 
 class DS18B20 {
    public:
-    explicit DS18B20(gpio_num_t pin);
+    static constexpr uint8_t FAMILY_CODE = 0x28;
+
+    // An address of 0 talks to the only sensor on the bus via Skip ROM.
+    explicit DS18B20(OneWireBus& bus, OneWireAddress address = 0);
 
     bool init();
+    OneWireAddress address() const;
+
+    // Blocking convenience wrapper: start, wait, fetch. Returns -1000 on failure.
     float readTemperature();
 
+    // Sets the conversion resolution (9..12 bits) in the sensor's config register.
+    bool setResolution(uint8_t bits);
+    uint8_t getResolution() const;
+
+    // Worst-case Convert T duration for the configured resolution (93.75 ms .. 750 ms).
+    uint32_t conversionTimeMs() const;
+    static uint32_t conversionTimeMs(uint8_t bits);
+
+    // Split conversion API: issue Convert T, poll the busy flag, then read the result.
+    // fetchResult() re-reads the scratchpad up to the retry limit on a CRC failure
+    // and never touches the conversion.
+    bool startConversion();
+    bool isConversionDone();
+    bool fetchResult(float& temperature);
+
+    // Read and CRC-check the full 9-byte scratchpad once.
+    bool readScratchpad(uint8_t (&scratchpad)[DS18B20_SCRATCHPAD_LEN]);
+
+    void setRetryLimit(uint8_t retries);
+    const DS18B20Stats& stats() const;
+
+    // Broadcast Convert T to every sensor on the bus. The busy flag then reads 1
+    // only once all of them have finished.
+    static bool startConversionAll(OneWireBus& bus);
+
    private:
-    gpio_num_t _pin;
+    OneWireBus& _bus;
+    OneWireAddress _address;
+    uint8_t _resolution = 12;
+    uint8_t _retry_limit = DS18B20_DEFAULT_RETRIES;
+    DS18B20Stats _stats = {};
 
-    void writeBit(bool bit);
-    bool readBit();
-    void writeByte(uint8_t byte);
-    uint8_t readByte();
-    bool resetPulse();
+    bool selectDevice();
 };
@@ -1,76 +1,119 @@
 #include "ds18b20.hpp"
 
-#include "esp_rom_sys.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "onewire_crc.hpp"
 
-DS18B20::DS18B20(gpio_num_t pin) : _pin(pin) {
-    gpio_set_direction(_pin, GPIO_MODE_INPUT_OUTPUT_OD);
-    gpio_set_level(_pin, 1);
+DS18B20::DS18B20(OneWireBus& bus, OneWireAddress address) : _bus(bus), _address(address) {}
+
+bool DS18B20::selectDevice() {
+    return _address ? _bus.select(_address) : _bus.selectAll();
 }
 
-bool DS18B20::resetPulse() {
-    gpio_set_level(_pin, 0);
-    esp_rom_delay_us(480);
-    gpio_set_level(_pin, 1);
-    esp_rom_delay_us(70);
-    bool presence = !gpio_get_level(_pin);
-    esp_rom_delay_us(410);
-    return presence;
+bool DS18B20::init() {
+    return _bus.reset();
 }
 
-void DS18B20::writeBit(bool bit) {
-    gpio_set_level(_pin, 0);
-    esp_rom_delay_us(bit ? 6 : 60);
-    gpio_set_level(_pin, 1);
-    esp_rom_delay_us(bit ? 64 : 10);
+OneWireAddress DS18B20::address() const {
+    return _address;
 }
 
-bool DS18B20::readBit() {
-    gpio_set_level(_pin, 0);
-    esp_rom_delay_us(6);
-    gpio_set_level(_pin, 1);
-    esp_rom_delay_us(9);
-    bool bit = gpio_get_level(_pin);
-    esp_rom_delay_us(55);
-    return bit;
+bool DS18B20::setResolution(uint8_t bits) {
+    if (bits < 9 || bits > 12) return false;
+    if (!selectDevice()) return false;
+
+    // Write Scratchpad: TH, TL (alarms unused), then config R1 R0 1 1 1 1 1
+    const uint8_t frame[4] = {0x4E, 0x00, 0x00, static_cast<uint8_t>(((bits - 9) << 5) | 0x1F)};
+    _bus.writeBytes(frame, sizeof(frame));
+
+    _resolution = bits;
+    return true;
 }
 
-void DS18B20::writeByte(uint8_t byte) {
-    for (int i = 0; i < 8; i++) {
-        writeBit(byte & 0x01);
-        byte >>= 1;
-    }
+uint8_t DS18B20::getResolution() const {
+    return _resolution;
 }
 
-uint8_t DS18B20::readByte() {
-    uint8_t byte = 0;
-    for (int i = 0; i < 8; i++) {
-        if (readBit()) byte |= (1 << i);
-    }
-    return byte;
+uint32_t DS18B20::conversionTimeMs(uint8_t bits) {
+    // 750 ms at 12 bits, halved for every bit dropped (rounded up)
+    return (750 + (1u << (12 - bits)) - 1) >> (12 - bits);
 }
 
-bool DS18B20::init() {
-    return resetPulse();
+uint32_t DS18B20::conversionTimeMs() const {
+    return conversionTimeMs(_resolution);
 }
 
-float DS18B20::readTemperature() {
-    if (!resetPulse()) return -1000.0f;
+bool DS18B20::startConversion() {
+    if (!selectDevice()) return false;
+
+    _bus.writeByte(0x44);  // Convert T
+    return true;
+}
+
+bool DS18B20::startConversionAll(OneWireBus& bus) {
+    if (!bus.selectAll()) return false;
+
+    bus.writeByte(0x44);  // Convert T
+    return true;
+}
+
+bool DS18B20::isConversionDone() {
+    // After Convert T the sensor holds read slots at 0 while busy, 1 when done
+    return _bus.readBit();
+}
 
-    writeByte(0xCC);  // Skip ROM
-    writeByte(0x44);  // Convert T
+bool DS18B20::readScratchpad(uint8_t (&scratchpad)[DS18B20_SCRATCHPAD_LEN]) {
+    if (!selectDevice()) {
+        _stats.no_presence++;
+        return false;
+    }
+
+    _bus.writeByte(0xBE);  // Read Scratchpad
+    _bus.readBytes(scratchpad, DS18B20_SCRATCHPAD_LEN);
+
+    // A shorted bus reads all zeros, which passes CRC; the config register's
+    // low five bits are hard-wired to 1 and catch that case.
+    if (oneWireCrc8(scratchpad, DS18B20_SCRATCHPAD_LEN) != 0 || (scratchpad[4] & 0x1F) != 0x1F) {
+        _stats.crc_errors++;
+        return false;
+    }
 
-    vTaskDelay(pdMS_TO_TICKS(750));  // Wait for conversion
+    _stats.reads++;
+    return true;
+}
+
+bool DS18B20::fetchResult(float& temperature) {
+    uint8_t scratchpad[DS18B20_SCRATCHPAD_LEN];
 
-    if (!resetPulse()) return -1000.0f;
+    for (uint8_t attempt = 0; attempt <= _retry_limit; attempt++) {
+        if (attempt > 0) _stats.retries++;
+        if (!readScratchpad(scratchpad)) continue;
+
+        // Undefined low bits are masked off at reduced resolution
+        int16_t raw = (scratchpad[1] << 8) | scratchpad[0];
+        raw &= ~((1 << (12 - _resolution)) - 1);
+        temperature = raw / 16.0f;
+        return true;
+    }
 
-    writeByte(0xCC);  // Skip ROM
-    writeByte(0xBE);  // Read Scratchpad
+    _stats.failures++;
+    return false;
+}
+
+void DS18B20::setRetryLimit(uint8_t retries) {
+    _retry_limit = retries;
+}
+
+const DS18B20Stats& DS18B20::stats() const {
+    return _stats;
+}
+
+float DS18B20::readTemperature() {
+    if (!startConversion()) return -1000.0f;
 
-    uint8_t lsb = readByte();
-    uint8_t msb = readByte();
+    vTaskDelay(pdMS_TO_TICKS(conversionTimeMs()));  // Wait for conversion
 
-    int16_t raw = (msb << 8) | lsb;
-    return raw / 16.0f;
+    float temperature;
+    if (!fetchResult(temperature)) return -1000.0f;
+    return temperature;
 }
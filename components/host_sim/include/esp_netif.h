@@ -0,0 +1,58 @@
+#pragma once
+
+// Linux-target stand-in for the parts of esp_netif used with Wi-Fi. Interfaces
+// are fixed records with the addresses the device would have on its own AP.
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_event.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct esp_netif_obj esp_netif_t;
+
+typedef struct {
+    uint32_t addr;  ///< Network byte order
+} esp_ip4_addr_t;
+
+typedef struct {
+    esp_ip4_addr_t ip;
+    esp_ip4_addr_t netmask;
+    esp_ip4_addr_t gw;
+} esp_netif_ip_info_t;
+
+#define esp_ip4_addr1(ipaddr) (((const uint8_t*)(&(ipaddr)->addr))[0])
+#define esp_ip4_addr2(ipaddr) (((const uint8_t*)(&(ipaddr)->addr))[1])
+#define esp_ip4_addr3(ipaddr) (((const uint8_t*)(&(ipaddr)->addr))[2])
+#define esp_ip4_addr4(ipaddr) (((const uint8_t*)(&(ipaddr)->addr))[3])
+
+#define IPSTR "%d.%d.%d.%d"
+#define IP2STR(ipaddr) \
+    esp_ip4_addr1(ipaddr), esp_ip4_addr2(ipaddr), esp_ip4_addr3(ipaddr), esp_ip4_addr4(ipaddr)
+
+ESP_EVENT_DECLARE_BASE(IP_EVENT);
+
+typedef enum {
+    IP_EVENT_STA_GOT_IP,
+    IP_EVENT_STA_LOST_IP,
+    IP_EVENT_AP_STAIPASSIGNED,
+} ip_event_t;
+
+typedef struct {
+    esp_netif_t* esp_netif;
+    esp_netif_ip_info_t ip_info;
+    bool ip_changed;
+} ip_event_got_ip_t;
+
+esp_err_t esp_netif_init(void);
+esp_netif_t* esp_netif_create_default_wifi_ap(void);
+esp_netif_t* esp_netif_create_default_wifi_sta(void);
+esp_netif_t* esp_netif_get_handle_from_ifkey(const char* if_key);
+esp_err_t esp_netif_get_ip_info(esp_netif_t* esp_netif, esp_netif_ip_info_t* ip_info);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,225 @@
+#pragma once
+
+// Linux-target stand-in for esp_wifi. There is no radio: the driver keeps the
+// requested mode and config and posts the matching WIFI_EVENT/IP_EVENT
+// sequence, so event-driven code runs the same path as on the device.
+// Connecting and scanning take simulated time, connecting longer without a
+// channel hint (see host_wifi.cpp), so reconnect logic can be timed on the host.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_ERR_WIFI_BASE 0x3000
+#define ESP_ERR_WIFI_NOT_INIT (ESP_ERR_WIFI_BASE + 1)
+#define ESP_ERR_WIFI_NOT_STARTED (ESP_ERR_WIFI_BASE + 2)
+#define ESP_ERR_WIFI_MODE (ESP_ERR_WIFI_BASE + 5)
+#define ESP_ERR_WIFI_STATE (ESP_ERR_WIFI_BASE + 6)
+#define ESP_ERR_WIFI_CONN (ESP_ERR_WIFI_BASE + 7)
+#define ESP_ERR_WIFI_SSID (ESP_ERR_WIFI_BASE + 9)
+
+typedef enum {
+    WIFI_MODE_NULL = 0,
+    WIFI_MODE_STA,
+    WIFI_MODE_AP,
+    WIFI_MODE_APSTA,
+    WIFI_MODE_MAX,
+} wifi_mode_t;
+
+typedef enum {
+    WIFI_IF_STA = 0,
+    WIFI_IF_AP = 1,
+} wifi_interface_t;
+
+typedef enum {
+    WIFI_AUTH_OPEN = 0,
+    WIFI_AUTH_WEP,
+    WIFI_AUTH_WPA_PSK,
+    WIFI_AUTH_WPA2_PSK,
+    WIFI_AUTH_WPA_WPA2_PSK,
+    WIFI_AUTH_WPA2_ENTERPRISE,
+    WIFI_AUTH_WPA3_PSK,
+    WIFI_AUTH_WPA2_WPA3_PSK,
+    WIFI_AUTH_MAX,
+} wifi_auth_mode_t;
+
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t password[64];
+    uint8_t ssid_len;
+    uint8_t channel;
+    wifi_auth_mode_t authmode;
+    uint8_t ssid_hidden;
+    uint8_t max_connection;
+    uint16_t beacon_interval;
+} wifi_ap_config_t;
+
+typedef enum {
+    WIFI_FAST_SCAN = 0,     ///< Stop at the first matching AP
+    WIFI_ALL_CHANNEL_SCAN,  ///< Scan every channel, then pick by sort_method
+} wifi_scan_method_t;
+
+typedef enum {
+    WIFI_CONNECT_AP_BY_SIGNAL = 0,
+    WIFI_CONNECT_AP_BY_SECURITY,
+} wifi_sort_method_t;
+
+typedef enum {
+    WIFI_STORAGE_FLASH,
+    WIFI_STORAGE_RAM,
+} wifi_storage_t;
+
+typedef enum {
+    WIFI_REASON_UNSPECIFIED = 1,
+    WIFI_REASON_AUTH_EXPIRE = 2,
+    WIFI_REASON_ASSOC_LEAVE = 8,
+    WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT = 15,
+    WIFI_REASON_BEACON_TIMEOUT = 200,
+    WIFI_REASON_NO_AP_FOUND = 201,
+    WIFI_REASON_AUTH_FAIL = 202,
+    WIFI_REASON_ASSOC_FAIL = 203,
+    WIFI_REASON_HANDSHAKE_TIMEOUT = 204,
+    WIFI_REASON_CONNECTION_FAIL = 205,
+} wifi_err_reason_t;
+
+typedef struct {
+    int8_t rssi;
+    wifi_auth_mode_t authmode;
+} wifi_scan_threshold_t;
+
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t password[64];
+    wifi_scan_method_t scan_method;
+    bool bssid_set;  ///< Only join the AP with this bssid
+    uint8_t bssid[6];
+    uint8_t channel;  ///< Scan this channel first; 0 if unknown
+    uint16_t listen_interval;
+    wifi_sort_method_t sort_method;
+    wifi_scan_threshold_t threshold;
+} wifi_sta_config_t;
+
+typedef enum {
+    WIFI_SCAN_TYPE_ACTIVE = 0,
+    WIFI_SCAN_TYPE_PASSIVE,
+} wifi_scan_type_t;
+
+typedef struct {
+    uint32_t min;  ///< Per channel, ms; 0 for the driver default
+    uint32_t max;
+} wifi_active_scan_time_t;
+
+typedef struct {
+    wifi_active_scan_time_t active;
+    uint32_t passive;
+} wifi_scan_time_t;
+
+typedef struct {
+    uint8_t* ssid;    ///< Only this SSID; nullptr for all
+    uint8_t* bssid;   ///< Only this BSSID; nullptr for all
+    uint8_t channel;  ///< Only this channel; 0 for all
+    bool show_hidden;
+    wifi_scan_type_t scan_type;
+    wifi_scan_time_t scan_time;
+    uint8_t home_chan_dwell_time;  ///< ms back on the home channel between channels
+} wifi_scan_config_t;
+
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t ssid[33];
+    uint8_t primary;  ///< Channel
+    int8_t rssi;
+    wifi_auth_mode_t authmode;
+} wifi_ap_record_t;
+
+typedef union {
+    wifi_ap_config_t ap;
+    wifi_sta_config_t sta;
+} wifi_config_t;
+
+typedef struct {
+    int magic;
+} wifi_init_config_t;
+
+#define WIFI_INIT_CONFIG_MAGIC 0x1F2F3F4F
+#define WIFI_INIT_CONFIG_DEFAULT() {.magic = WIFI_INIT_CONFIG_MAGIC}
+
+ESP_EVENT_DECLARE_BASE(WIFI_EVENT);
+
+typedef enum {
+    WIFI_EVENT_WIFI_READY = 0,
+    WIFI_EVENT_SCAN_DONE,
+    WIFI_EVENT_STA_START,
+    WIFI_EVENT_STA_STOP,
+    WIFI_EVENT_STA_CONNECTED,
+    WIFI_EVENT_STA_DISCONNECTED,
+    WIFI_EVENT_STA_AUTHMODE_CHANGE,
+    WIFI_EVENT_AP_START = 12,
+    WIFI_EVENT_AP_STOP,
+    WIFI_EVENT_AP_STACONNECTED,
+    WIFI_EVENT_AP_STADISCONNECTED,
+} wifi_event_t;
+
+typedef struct {
+    uint32_t status;  ///< 0 on success
+    uint8_t number;
+    uint8_t scan_id;
+} wifi_event_sta_scan_done_t;
+
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t ssid_len;
+    uint8_t bssid[6];
+    uint8_t channel;
+    wifi_auth_mode_t authmode;
+    uint16_t aid;
+} wifi_event_sta_connected_t;
+
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t ssid_len;
+    uint8_t bssid[6];
+    uint8_t reason;
+    int8_t rssi;
+} wifi_event_sta_disconnected_t;
+
+typedef struct {
+    uint8_t mac[6];
+    uint8_t aid;
+    bool is_mesh_child;
+} wifi_event_ap_staconnected_t;
+
+typedef struct {
+    uint8_t mac[6];
+    uint8_t aid;
+    bool is_mesh_child;
+    uint16_t reason;
+} wifi_event_ap_stadisconnected_t;
+
+esp_err_t esp_wifi_init(const wifi_init_config_t* config);
+esp_err_t esp_wifi_deinit(void);
+esp_err_t esp_wifi_set_storage(wifi_storage_t storage);
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode);
+esp_err_t esp_wifi_get_mode(wifi_mode_t* mode);
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t* conf);
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t* conf);
+esp_err_t esp_wifi_start(void);
+esp_err_t esp_wifi_stop(void);
+esp_err_t esp_wifi_connect(void);
+esp_err_t esp_wifi_disconnect(void);
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t* config, bool block);
+esp_err_t esp_wifi_scan_stop(void);
+esp_err_t esp_wifi_scan_get_ap_num(uint16_t* number);
+esp_err_t esp_wifi_scan_get_ap_record(wifi_ap_record_t* ap_record);
+esp_err_t esp_wifi_clear_ap_list(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+#include "driver/gpio.h"
+
+/**
+ * @brief Peripheral model wired to a simulated open-drain GPIO.
+ *
+ * The line reads low whenever either side pulls it low. Time is the simulated
+ * clock from hostSimTimeUs(), so a model sees exactly the slot widths the
+ * driver asked for, independent of host scheduling.
+ */
+class HostGpioDevice {
+   public:
+    virtual ~HostGpioDevice() = default;
+
+    /**
+     * @brief The host changed its output level.
+     * @param level false while the host pulls the line low
+     */
+    virtual void drive(bool level, uint64_t now_us) = 0;
+
+    /**
+     * @brief Level the device puts on the line; true when released.
+     */
+    virtual bool sense(uint64_t now_us) = 0;
+};
+
+/**
+ * @brief Wire a model to a pin, replacing any previous one.
+ * @param device Must outlive the attachment; nullptr detaches
+ */
+esp_err_t hostGpioAttach(gpio_num_t pin, HostGpioDevice* device);
+
+/**
+ * @brief Simulated microsecond clock.
+ *
+ * Advanced only by esp_rom_delay_us(), which the linux build wraps so
+ * bit-banged drivers run at full speed and deterministically.
+ */
+uint64_t hostSimTimeUs();
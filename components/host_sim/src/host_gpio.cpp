@@ -0,0 +1,92 @@
+#include <atomic>
+#include <mutex>
+
+#include "host_gpio.hpp"
+
+struct HostPin {
+    gpio_mode_t mode = GPIO_MODE_DISABLE;
+    bool level = true;  ///< Host output; pulled up while not driven
+    HostGpioDevice* device = nullptr;
+};
+
+static HostPin pins[GPIO_NUM_MAX];
+static std::mutex pins_mutex;
+static std::atomic<uint64_t> sim_time_us{0};
+
+static bool validPin(gpio_num_t pin) {
+    return pin >= 0 && pin < GPIO_NUM_MAX;
+}
+
+static bool canDrive(gpio_mode_t mode) {
+    return mode == GPIO_MODE_OUTPUT || mode == GPIO_MODE_OUTPUT_OD ||
+           mode == GPIO_MODE_INPUT_OUTPUT_OD || mode == GPIO_MODE_INPUT_OUTPUT;
+}
+
+// Level the host puts on the line
+static bool hostLevel(const HostPin& pin) {
+    return !canDrive(pin.mode) || pin.level;
+}
+
+// Apply a pin change and tell the attached model if the line level moved
+template <typename Change>
+static void update(HostPin& pin, Change change) {
+    bool before = hostLevel(pin);
+    change(pin);
+    bool after = hostLevel(pin);
+    if (pin.device && before != after) pin.device->drive(after, hostSimTimeUs());
+}
+
+esp_err_t hostGpioAttach(gpio_num_t pin, HostGpioDevice* device) {
+    if (!validPin(pin)) return ESP_ERR_INVALID_ARG;
+
+    std::lock_guard<std::mutex> lock(pins_mutex);
+    pins[pin].device = device;
+    return ESP_OK;
+}
+
+uint64_t hostSimTimeUs() {
+    return sim_time_us.load();
+}
+
+extern "C" void __wrap_esp_rom_delay_us(uint32_t us) {
+    sim_time_us += us;
+}
+
+extern "C" esp_err_t gpio_reset_pin(gpio_num_t gpio_num) {
+    if (!validPin(gpio_num)) return ESP_ERR_INVALID_ARG;
+
+    std::lock_guard<std::mutex> lock(pins_mutex);
+    update(pins[gpio_num], [](HostPin& pin) {
+        pin.mode = GPIO_MODE_DISABLE;
+        pin.level = true;
+    });
+    return ESP_OK;
+}
+
+extern "C" esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode) {
+    if (!validPin(gpio_num)) return ESP_ERR_INVALID_ARG;
+
+    std::lock_guard<std::mutex> lock(pins_mutex);
+    update(pins[gpio_num], [mode](HostPin& pin) { pin.mode = mode; });
+    return ESP_OK;
+}
+
+extern "C" esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    if (!validPin(gpio_num)) return ESP_ERR_INVALID_ARG;
+
+    std::lock_guard<std::mutex> lock(pins_mutex);
+    update(pins[gpio_num], [level](HostPin& pin) { pin.level = level != 0; });
+    return ESP_OK;
+}
+
+extern "C" int gpio_get_level(gpio_num_t gpio_num) {
+    if (!validPin(gpio_num)) return 0;
+
+    std::lock_guard<std::mutex> lock(pins_mutex);
+    HostPin& pin = pins[gpio_num];
+    if (pin.mode == GPIO_MODE_OUTPUT || pin.mode == GPIO_MODE_DISABLE) return 0;  // No input path
+
+    bool line = hostLevel(pin);
+    if (pin.device) line = pin.device->sense(hostSimTimeUs()) && line;
+    return line ? 1 : 0;
+}
@@ -0,0 +1,781 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "esp_http_server.h"
+#include "esp_log.h"
+#include "freertos/task.h"
+
+static const char* TAG = "host_httpd";
+
+constexpr size_t RECV_CHUNK_LEN = 2048;
+constexpr TickType_t IDLE_DELAY_TICKS = 1;  // Sleep between polls while nothing is ready
+
+// After any activity, keep polling (yielding the host CPU in between) for one
+// tick before going back to tick sleeps, so keep-alive clients are not held to
+// one request per tick
+constexpr std::chrono::microseconds BUSY_POLL_TIME{1000};
+
+struct Session {
+    int fd = -1;
+    bool detached = false;  ///< Owned by an async handler until it completes
+    TickType_t last_used = 0;
+    std::string in;  ///< Received bytes not yet consumed by a request
+    void* ctx = nullptr;  ///< httpd_req_t::sess_ctx, kept across requests
+    httpd_free_ctx_fn_t free_ctx = nullptr;
+};
+
+struct Server {
+    httpd_config_t config;
+    int listen_fd = -1;
+    std::vector<Session> sessions;
+    std::vector<pollfd> poll_fds;  ///< Reused by every poll; server task only
+
+    std::mutex handlers_mutex;
+    std::vector<httpd_uri_t> handlers;
+
+    std::mutex work_mutex;  ///< Guards the three lists below
+    std::vector<std::pair<httpd_work_fn_t, void*>> work;
+    std::vector<int> reattach;  ///< Sessions handed back by async handlers
+    std::vector<int> closing;   ///< Sessions to close from the server task
+
+    std::atomic<bool> running{true};
+    std::atomic<bool> stopped{false};
+};
+
+/**
+ * @brief Parsed request and response state, stored in httpd_req_t::aux.
+ */
+struct Request {
+    Server* server = nullptr;
+    int fd = -1;
+    std::string buffered;  ///< Bytes read past the header block; body first
+    size_t body_left = 0;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string query;
+    bool keep_alive = true;
+    bool detached = false;
+
+    const char* status = HTTPD_200;
+    const char* type = HTTPD_TYPE_TEXT;
+    std::vector<std::pair<const char*, const char*>> resp_headers;
+    bool headers_sent = false;
+    bool chunked = false;
+};
+
+static Request* stateOf(httpd_req_t* r) {
+    return static_cast<Request*>(r->aux);
+}
+
+// === Socket helpers ===
+// Sockets are non-blocking and waits go through vTaskDelay, so other tasks on
+// the FreeRTOS POSIX port keep running while the server waits on a peer.
+
+static bool sendAll(int fd, const char* data, size_t len, uint16_t timeout_s) {
+    TickType_t start = xTaskGetTickCount();
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n > 0) {
+            data += n;
+            len -= n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) &&
+            xTaskGetTickCount() - start < pdMS_TO_TICKS(timeout_s * 1000)) {
+            vTaskDelay(IDLE_DELAY_TICKS);
+            continue;
+        }
+        return false;
+    }
+    return true;
+}
+
+static int recvSome(int fd, char* buf, size_t len, uint16_t timeout_s) {
+    TickType_t start = xTaskGetTickCount();
+    while (true) {
+        ssize_t n = recv(fd, buf, len, 0);
+        if (n >= 0) return n == 0 ? HTTPD_SOCK_ERR_FAIL : static_cast<int>(n);
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) return HTTPD_SOCK_ERR_FAIL;
+        if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(timeout_s * 1000)) {
+            return HTTPD_SOCK_ERR_TIMEOUT;
+        }
+        vTaskDelay(IDLE_DELAY_TICKS);
+    }
+}
+
+static esp_err_t copyValue(const char* value, size_t len, char* out, size_t out_size) {
+    if (!out || out_size == 0) return ESP_ERR_INVALID_ARG;
+    size_t n = len < out_size - 1 ? len : out_size - 1;
+    memcpy(out, value, n);
+    out[n] = '\0';
+    return n < len ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+}
+
+// === Session management (server task only) ===
+
+static Session* findSession(Server* server, int fd) {
+    for (Session& session : server->sessions) {
+        if (session.fd == fd) return &session;
+    }
+    return nullptr;
+}
+
+static void freeSessionCtx(Session& session) {
+    if (!session.ctx) return;
+    if (session.free_ctx) {
+        session.free_ctx(session.ctx);
+    } else {
+        free(session.ctx);
+    }
+    session.ctx = nullptr;
+    session.free_ctx = nullptr;
+}
+
+static void closeSession(Server* server, Session& session) {
+    if (session.fd < 0) return;
+    if (server->config.close_fn) server->config.close_fn(server, session.fd);
+    close(session.fd);
+    session.fd = -1;
+    session.detached = false;
+    session.in.clear();
+    freeSessionCtx(session);
+}
+
+static bool runQueued(Server* server) {
+    std::vector<std::pair<httpd_work_fn_t, void*>> work;
+    std::vector<int> reattach;
+    std::vector<int> to_close;
+    {
+        std::lock_guard<std::mutex> lock(server->work_mutex);
+        work.swap(server->work);
+        reattach.swap(server->reattach);
+        to_close.swap(server->closing);
+    }
+
+    for (auto& item : work) item.first(item.second);
+    for (int fd : reattach) {
+        Session* session = findSession(server, fd);
+        if (session) session->detached = false;
+    }
+    for (int fd : to_close) {
+        Session* session = findSession(server, fd);
+        if (session) closeSession(server, *session);
+    }
+    return !work.empty() || !reattach.empty() || !to_close.empty();
+}
+
+static bool acceptClients(Server* server) {
+    bool accepted = false;
+    while (true) {
+        int fd = accept4(server->listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return accepted;
+        accepted = true;
+
+        // Responses go out in a few writes; don't let Nagle hold the last one back
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        Session* slot = nullptr;
+        Session* oldest = nullptr;
+        for (Session& session : server->sessions) {
+            if (session.fd < 0) {
+                slot = &session;
+                break;
+            }
+            if (!session.detached && (!oldest || session.last_used < oldest->last_used)) {
+                oldest = &session;
+            }
+        }
+        if (!slot && server->config.lru_purge_enable && oldest) {
+            ESP_LOGD(TAG, "Purging least recently used session %d", oldest->fd);
+            closeSession(server, *oldest);
+            slot = oldest;
+        }
+        if (!slot) {
+            ESP_LOGW(TAG, "Session limit (%u) reached, refusing connection",
+                     (unsigned)server->config.max_open_sockets);
+            close(fd);
+            continue;
+        }
+        if (server->config.open_fn && server->config.open_fn(server, fd) != ESP_OK) {
+            close(fd);
+            continue;
+        }
+
+        slot->fd = fd;
+        slot->detached = false;
+        slot->last_used = xTaskGetTickCount();
+        slot->in.clear();
+    }
+}
+
+// === Request handling ===
+
+static const char* methodName(int method) {
+    switch (method) {
+        case HTTP_DELETE:
+            return "DELETE";
+        case HTTP_GET:
+            return "GET";
+        case HTTP_HEAD:
+            return "HEAD";
+        case HTTP_POST:
+            return "POST";
+        case HTTP_PUT:
+            return "PUT";
+        case HTTP_OPTIONS:
+            return "OPTIONS";
+        case HTTP_PATCH:
+            return "PATCH";
+        default:
+            return nullptr;
+    }
+}
+
+static int parseMethod(const std::string& name) {
+    for (int method : {HTTP_DELETE, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_OPTIONS,
+                       HTTP_PATCH}) {
+        if (name == methodName(method)) return method;
+    }
+    return -1;
+}
+
+static const std::string* findHeader(const Request& state, const char* field) {
+    for (const auto& header : state.headers) {
+        if (strcasecmp(header.first.c_str(), field) == 0) return &header.second;
+    }
+    return nullptr;
+}
+
+static void trim(std::string& s) {
+    size_t begin = s.find_first_not_of(" \t");
+    size_t end = s.find_last_not_of(" \t");
+    s = begin == std::string::npos ? std::string() : s.substr(begin, end - begin + 1);
+}
+
+/**
+ * @brief Parse the request line and headers into req and state.
+ * @return HTTPD_ERR_CODE_MAX on success, otherwise the error to answer with
+ */
+static httpd_err_code_t parseHead(const std::string& head, httpd_req_t& req, Request& state) {
+    size_t line_end = head.find("\r\n");
+    std::string line = head.substr(0, line_end);
+
+    size_t sp1 = line.find(' ');
+    size_t sp2 = line.find(' ', sp1 == std::string::npos ? sp1 : sp1 + 1);
+    if (sp1 == std::string::npos || sp2 == std::string::npos) return HTTPD_400_BAD_REQUEST;
+
+    std::string target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    std::string version = line.substr(sp2 + 1);
+    if (version != "HTTP/1.1" && version != "HTTP/1.0") return HTTPD_505_VERSION_NOT_SUPPORTED;
+    if (target.size() > HTTPD_MAX_URI_LEN) return HTTPD_414_URI_TOO_LONG;
+
+    req.method = parseMethod(line.substr(0, sp1));
+    if (req.method < 0) return HTTPD_501_METHOD_NOT_IMPLEMENTED;
+    memcpy(const_cast<char*>(req.uri), target.c_str(), target.size() + 1);
+
+    size_t query = target.find('?');
+    if (query != std::string::npos) state.query = target.substr(query + 1);
+
+    size_t pos = line_end == std::string::npos ? head.size() : line_end + 2;
+    while (pos < head.size()) {
+        size_t end = head.find("\r\n", pos);
+        if (end == std::string::npos) end = head.size();
+        size_t colon = head.find(':', pos);
+        if (colon == std::string::npos || colon > end) return HTTPD_400_BAD_REQUEST;
+
+        std::string name = head.substr(pos, colon - pos);
+        std::string value = head.substr(colon + 1, end - colon - 1);
+        trim(name);
+        trim(value);
+        state.headers.emplace_back(std::move(name), std::move(value));
+        pos = end + 2;
+    }
+
+    // Chunked request bodies are not supported, as on the device
+    if (findHeader(state, "Transfer-Encoding")) return HTTPD_411_LENGTH_REQUIRED;
+    if (const std::string* length = findHeader(state, "Content-Length")) {
+        char* end = nullptr;
+        unsigned long long value = strtoull(length->c_str(), &end, 10);
+        if (length->empty() || *end != '\0') return HTTPD_400_BAD_REQUEST;
+        req.content_len = value;
+        state.body_left = value;
+    }
+
+    const std::string* connection = findHeader(state, "Connection");
+    if (version == "HTTP/1.0") {
+        state.keep_alive = connection && strcasecmp(connection->c_str(), "keep-alive") == 0;
+    } else {
+        state.keep_alive = !connection || strcasecmp(connection->c_str(), "close") != 0;
+    }
+    return HTTPD_ERR_CODE_MAX;
+}
+
+/**
+ * @brief Find the handler for a URI, as the real server does.
+ * @param allowed Set when the URI exists for a different method
+ */
+static bool findHandler(Server* server, const httpd_req_t& req, httpd_uri_t& out, bool& allowed) {
+    const char* uri = req.uri;
+    size_t len = strcspn(uri, "?");
+    allowed = false;
+
+    std::lock_guard<std::mutex> lock(server->handlers_mutex);
+    for (const httpd_uri_t& handler : server->handlers) {
+        bool match = server->config.uri_match_fn
+                         ? server->config.uri_match_fn(handler.uri, uri, len)
+                         : strlen(handler.uri) == len && strncmp(handler.uri, uri, len) == 0;
+        if (!match) continue;
+        if (handler.method == req.method) {
+            out = handler;
+            return true;
+        }
+        allowed = true;
+    }
+    return false;
+}
+
+// Discard whatever the handler did not read so the next request starts clean
+static bool drainBody(Request& state) {
+    size_t take = state.body_left < state.buffered.size() ? state.body_left : state.buffered.size();
+    state.buffered.erase(0, take);
+    state.body_left -= take;
+
+    char buf[RECV_CHUNK_LEN];
+    while (state.body_left > 0) {
+        size_t want = state.body_left < sizeof(buf) ? state.body_left : sizeof(buf);
+        int n = recvSome(state.fd, buf, want, state.server->config.recv_wait_timeout);
+        if (n <= 0) return false;
+        state.body_left -= n;
+    }
+    return true;
+}
+
+static void handleRequest(Server* server, Session& session, size_t head_len) {
+    Request state;
+    state.server = server;
+    state.fd = session.fd;
+    std::string head = session.in.substr(0, head_len);
+    state.buffered = session.in.substr(head_len + 4);
+    session.in.clear();
+    session.last_used = xTaskGetTickCount();
+
+    httpd_req_t req = {};
+    req.handle = server;
+    req.aux = &state;
+
+    httpd_err_code_t error = parseHead(head, req, state);
+    if (error != HTTPD_ERR_CODE_MAX) {
+        state.keep_alive = false;
+        httpd_resp_send_err(&req, error, nullptr);
+        closeSession(server, session);
+        return;
+    }
+
+    httpd_uri_t handler;
+    bool allowed = false;
+    if (!findHandler(server, req, handler, allowed)) {
+        httpd_resp_send_err(&req, allowed ? HTTPD_405_METHOD_NOT_ALLOWED : HTTPD_404_NOT_FOUND,
+                            nullptr);
+        if (!state.keep_alive || !drainBody(state)) {
+            closeSession(server, session);
+        } else {
+            session.in.swap(state.buffered);
+        }
+        return;
+    }
+
+    req.user_ctx = handler.user_ctx;
+    req.sess_ctx = session.ctx;
+    req.free_ctx = session.free_ctx;
+    esp_err_t ret = handler.handler(&req);
+
+    // As the real server does: a replaced session context frees the old one
+    if (req.sess_ctx != session.ctx) {
+        if (!req.ignore_sess_ctx_changes) freeSessionCtx(session);
+        session.ctx = req.sess_ctx;
+    }
+    session.free_ctx = req.free_ctx;
+
+    if (state.detached) {
+        session.detached = true;
+    } else if (ret != ESP_OK || !state.keep_alive || !drainBody(state)) {
+        ESP_LOGD(TAG, "Closing session %d after %s %s", session.fd, methodName(req.method),
+                 req.uri);
+        closeSession(server, session);
+    } else {
+        session.in.swap(state.buffered);  // Pipelined requests
+    }
+}
+
+static bool serveSessions(Server* server) {
+    std::vector<pollfd>& fds = server->poll_fds;
+    fds.clear();
+    for (const Session& session : server->sessions) {
+        if (session.fd >= 0 && !session.detached) fds.push_back({session.fd, POLLIN, 0});
+    }
+    if (fds.empty() || poll(fds.data(), fds.size(), 0) <= 0) return false;
+
+    const size_t max_head = CONFIG_HOST_SIM_HTTPD_MAX_HDR_LEN;
+    for (const pollfd& p : fds) {
+        if (!p.revents) continue;
+        Session* session = findSession(server, p.fd);
+        if (!session) continue;
+
+        char buf[RECV_CHUNK_LEN];
+        ssize_t n = recv(session->fd, buf, sizeof(buf), 0);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            closeSession(server, *session);
+            continue;
+        }
+        if (n > 0) session->in.append(buf, n);
+
+        while (session->fd >= 0 && !session->detached) {
+            size_t head_len = session->in.find("\r\n\r\n");
+            if (head_len == std::string::npos) {
+                if (session->in.size() > max_head) {
+                    httpd_req_t req = {};
+                    Request state;
+                    state.server = server;
+                    state.fd = session->fd;
+                    state.keep_alive = false;
+                    req.handle = server;
+                    req.aux = &state;
+                    httpd_resp_send_err(&req, HTTPD_431_REQ_HDR_FIELDS_TOO_LARGE, nullptr);
+                    closeSession(server, *session);
+                }
+                break;
+            }
+            handleRequest(server, *session, head_len);
+        }
+    }
+    return true;
+}
+
+static void serverTask(void* arg) {
+    auto* server = static_cast<Server*>(arg);
+    auto last_busy = std::chrono::steady_clock::now();
+    while (server->running) {
+        bool busy = runQueued(server);
+        busy = acceptClients(server) || busy;
+        busy = serveSessions(server) || busy;
+
+        auto now = std::chrono::steady_clock::now();
+        if (busy) {
+            last_busy = now;
+        } else if (now - last_busy >= BUSY_POLL_TIME) {
+            vTaskDelay(IDLE_DELAY_TICKS);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    runQueued(server);
+    for (Session& session : server->sessions) closeSession(server, session);
+    close(server->listen_fd);
+    server->stopped = true;
+    vTaskDelete(nullptr);
+}
+
+// === Public API ===
+
+extern "C" esp_err_t httpd_start(httpd_handle_t* handle, const httpd_config_t* config) {
+    if (!handle || !config) return ESP_ERR_INVALID_ARG;
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return ESP_FAIL;
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config->server_port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(fd, config->backlog_conn) != 0) {
+        ESP_LOGE(TAG, "Cannot listen on port %u: %s", config->server_port, strerror(errno));
+        close(fd);
+        return ESP_FAIL;
+    }
+
+    auto* server = new Server();
+    server->config = *config;
+    server->listen_fd = fd;
+    server->sessions.resize(config->max_open_sockets);
+    server->poll_fds.reserve(config->max_open_sockets);
+    server->handlers.reserve(config->max_uri_handlers);
+
+    if (xTaskCreate(serverTask, "httpd", config->stack_size, server, config->task_priority,
+                    nullptr) != pdPASS) {
+        close(fd);
+        delete server;
+        return ESP_ERR_HTTPD_TASK;
+    }
+
+    ESP_LOGI(TAG, "Listening on 127.0.0.1:%u", config->server_port);
+    *handle = server;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t httpd_stop(httpd_handle_t handle) {
+    auto* server = static_cast<Server*>(handle);
+    if (!server) return ESP_ERR_INVALID_ARG;
+
+    server->running = false;
+    while (!server->stopped) vTaskDelay(IDLE_DELAY_TICKS);
+
+    if (server->config.global_user_ctx_free_fn) {
+        server->config.global_user_ctx_free_fn(server->config.global_user_ctx);
+    }
+    delete server;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t httpd_register_uri_handler(httpd_handle_t handle,
+                                                const httpd_uri_t* uri_handler) {
+    auto* server = static_cast<Server*>(handle);
+    if (!server || !uri_handler || !uri_handler->uri) return ESP_ERR_INVALID_ARG;
+
+    std::lock_guard<std::mutex> lock(server->handlers_mutex);
+    for (const httpd_uri_t& existing : server->handlers) {
+        if (existing.method == uri_handler->method && strcmp(existing.uri, uri_handler->uri) == 0) {
+            return ESP_ERR_HTTPD_HANDLER_EXISTS;
+        }
+    }
+    if (server->handlers.size() >= server->config.max_uri_handlers) {
+        return ESP_ERR_HTTPD_HANDLERS_FULL;
+    }
+    server->handlers.push_back(*uri_handler);
+    return ESP_OK;
+}
+
+extern "C" int httpd_req_recv(httpd_req_t* r, char* buf, size_t buf_len) {
+    Request* state = stateOf(r);
+    if (!buf) return HTTPD_SOCK_ERR_INVALID;
+    if (state->body_left == 0) return 0;
+
+    size_t want = buf_len < state->body_left ? buf_len : state->body_left;
+    if (!state->buffered.empty()) {
+        size_t n = want < state->buffered.size() ? want : state->buffered.size();
+        memcpy(buf, state->buffered.data(), n);
+        state->buffered.erase(0, n);
+        state->body_left -= n;
+        return static_cast<int>(n);
+    }
+
+    int n = recvSome(state->fd, buf, want, state->server->config.recv_wait_timeout);
+    if (n > 0) state->body_left -= n;
+    return n;
+}
+
+extern "C" size_t httpd_req_get_hdr_value_len(httpd_req_t* r, const char* field) {
+    const std::string* value = findHeader(*stateOf(r), field);
+    return value ? value->size() : 0;
+}
+
+extern "C" esp_err_t httpd_req_get_hdr_value_str(httpd_req_t* r, const char* field, char* val,
+                                                 size_t val_size) {
+    const std::string* value = findHeader(*stateOf(r), field);
+    if (!value) return ESP_ERR_NOT_FOUND;
+    return copyValue(value->data(), value->size(), val, val_size);
+}
+
+extern "C" size_t httpd_req_get_url_query_len(httpd_req_t* r) {
+    return stateOf(r)->query.size();
+}
+
+extern "C" esp_err_t httpd_req_get_url_query_str(httpd_req_t* r, char* buf, size_t buf_len) {
+    const std::string& query = stateOf(r)->query;
+    if (query.empty()) return ESP_ERR_NOT_FOUND;
+    return copyValue(query.data(), query.size(), buf, buf_len);
+}
+
+extern "C" esp_err_t httpd_query_key_value(const char* qry, const char* key, char* val,
+                                           size_t val_size) {
+    if (!qry || !key || !val) return ESP_ERR_INVALID_ARG;
+
+    size_t key_len = strlen(key);
+    const char* pos = qry;
+    while (*pos) {
+        size_t pair_len = strcspn(pos, "&");
+        const char* eq = static_cast<const char*>(memchr(pos, '=', pair_len));
+        size_t name_len = eq ? static_cast<size_t>(eq - pos) : pair_len;
+        if (eq && name_len == key_len && strncmp(pos, key, key_len) == 0) {
+            return copyValue(eq + 1, pair_len - name_len - 1, val, val_size);
+        }
+        pos += pair_len;
+        if (*pos == '&') pos++;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+extern "C" int httpd_req_to_sockfd(httpd_req_t* r) {
+    return r ? stateOf(r)->fd : -1;
+}
+
+extern "C" esp_err_t httpd_resp_set_status(httpd_req_t* r, const char* status) {
+    stateOf(r)->status = status;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t httpd_resp_set_type(httpd_req_t* r, const char* type) {
+    stateOf(r)->type = type;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t httpd_resp_set_hdr(httpd_req_t* r, const char* field, const char* value) {
+    Request* state = stateOf(r);
+    if (state->resp_headers.size() >= state->server->config.max_resp_headers) {
+        return ESP_ERR_HTTPD_RESP_HDR;
+    }
+    state->resp_headers.emplace_back(field, value);  // Caller keeps both alive until sent
+    return ESP_OK;
+}
+
+static std::string responseHead(const Request& state, size_t content_len) {
+    std::string head = "HTTP/1.1 ";
+    head += state.status;
+    head += "\r\nContent-Type: ";
+    head += state.type;
+    if (state.chunked) {
+        head += "\r\nTransfer-Encoding: chunked";
+    } else {
+        head += "\r\nContent-Length: " + std::to_string(content_len);
+    }
+    for (const auto& header : state.resp_headers) {
+        head += "\r\n";
+        head += header.first;
+        head += ": ";
+        head += header.second;
+    }
+    if (!state.keep_alive) head += "\r\nConnection: close";
+    head += "\r\n\r\n";
+    return head;
+}
+
+extern "C" esp_err_t httpd_resp_send(httpd_req_t* r, const char* buf, ssize_t buf_len) {
+    Request* state = stateOf(r);
+    if (state->headers_sent) return ESP_ERR_HTTPD_INVALID_REQ;
+    size_t len = buf_len == HTTPD_RESP_USE_STRLEN ? (buf ? strlen(buf) : 0) : buf_len;
+
+    // One write for head and body keeps small responses in a single segment
+    std::string out = responseHead(*state, len);
+    if (buf) out.append(buf, len);
+    state->headers_sent = true;
+    return sendAll(state->fd, out.data(), out.size(), state->server->config.send_wait_timeout)
+               ? ESP_OK
+               : ESP_ERR_HTTPD_RESP_SEND;
+}
+
+extern "C" esp_err_t httpd_resp_send_chunk(httpd_req_t* r, const char* buf, ssize_t buf_len) {
+    Request* state = stateOf(r);
+    size_t len = buf_len == HTTPD_RESP_USE_STRLEN ? (buf ? strlen(buf) : 0) : buf_len;
+    if (!buf) len = 0;
+
+    std::string out;
+    if (!state->headers_sent) {
+        state->chunked = true;
+        out = responseHead(*state, 0);
+        state->headers_sent = true;
+    } else if (!state->chunked) {
+        return ESP_ERR_HTTPD_INVALID_REQ;
+    }
+
+    char size_line[20];
+    snprintf(size_line, sizeof(size_line), "%zx\r\n", len);
+    out += size_line;
+    if (len > 0) out.append(buf, len);
+    out += "\r\n";
+    return sendAll(state->fd, out.data(), out.size(), state->server->config.send_wait_timeout)
+               ? ESP_OK
+               : ESP_ERR_HTTPD_RESP_SEND;
+}
+
+extern "C" esp_err_t httpd_resp_send_err(httpd_req_t* req, httpd_err_code_t error,
+                                         const char* msg) {
+    static const struct {
+        const char* status;
+        const char* msg;
+    } ERRORS[HTTPD_ERR_CODE_MAX] = {
+        {"500 Internal Server Error", "Server has encountered an unexpected error"},
+        {"501 Method Not Implemented", "Server does not support this method"},
+        {"505 Version Not Supported", "HTTP version not supported by server"},
+        {"400 Bad Request", "Bad request syntax"},
+        {"401 Unauthorized", "No permission -- see authorization schemes"},
+        {"403 Forbidden", "Request forbidden -- authorization will not help"},
+        {"404 Not Found", "Nothing matches the given URI"},
+        {"405 Method Not Allowed", "Specified method is invalid for this resource"},
+        {"408 Request Timeout", "Server closed this connection"},
+        {"411 Length Required", "Chunked encoding not supported"},
+        {"413 Content Too Large", "Content is too large"},
+        {"414 URI Too Long", "URI is too long"},
+        {"431 Request Header Fields Too Large", "Header fields are too long"},
+    };
+    if (error >= HTTPD_ERR_CODE_MAX) return ESP_ERR_INVALID_ARG;
+
+    httpd_resp_set_status(req, ERRORS[error].status);
+    httpd_resp_set_type(req, HTTPD_TYPE_TEXT);
+    return httpd_resp_sendstr(req, msg ? msg : ERRORS[error].msg);
+}
+
+extern "C" esp_err_t httpd_req_async_handler_begin(httpd_req_t* r, httpd_req_t** out) {
+    if (!r || !out) return ESP_ERR_INVALID_ARG;
+
+    Request* state = stateOf(r);
+    auto* copy = new httpd_req_t(*r);
+    copy->aux = new Request(*state);
+    state->detached = true;
+    *out = copy;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t httpd_req_async_handler_complete(httpd_req_t* r) {
+    if (!r) return ESP_ERR_INVALID_ARG;
+
+    Request* state = stateOf(r);
+    {
+        std::lock_guard<std::mutex> lock(state->server->work_mutex);
+        state->server->reattach.push_back(state->fd);
+    }
+    delete state;
+    delete r;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work, void* arg) {
+    auto* server = static_cast<Server*>(handle);
+    if (!server || !work) return ESP_ERR_INVALID_ARG;
+    if (!server->running) return ESP_FAIL;
+
+    std::lock_guard<std::mutex> lock(server->work_mutex);
+    server->work.emplace_back(work, arg);
+    return ESP_OK;
+}
+
+extern "C" esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int sockfd) {
+    auto* server = static_cast<Server*>(handle);
+    if (!server) return ESP_ERR_INVALID_ARG;
+
+    std::lock_guard<std::mutex> lock(server->work_mutex);
+    server->closing.push_back(sockfd);
+    return ESP_OK;
+}
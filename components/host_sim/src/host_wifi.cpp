@@ -0,0 +1,489 @@
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "esp_log.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char* TAG = "host_wifi";
+
+ESP_EVENT_DEFINE_BASE(WIFI_EVENT);
+ESP_EVENT_DEFINE_BASE(IP_EVENT);
+
+constexpr uint8_t SIM_CHANNEL = 6;
+constexpr uint8_t SIM_BSSID[6] = {0x02, 0x00, 0x00, 0x5A, 0x11, 0x01};
+
+// Rough connect timings of a real station. Without a correct channel hint the
+// scan covers every channel, which is most of a cold connect.
+constexpr uint32_t SIM_FULL_SCAN_MS = 1500;
+constexpr uint32_t SIM_CHANNEL_SCAN_MS = 40;
+constexpr uint32_t SIM_ASSOC_MS = 30;  // Authentication, association and 4-way handshake
+constexpr uint32_t SIM_DHCP_MS = 80;
+
+// Driver defaults for a scan that leaves them 0. With the AP up the radio
+// returns to its channel between scanned channels, so clients keep being served.
+constexpr uint8_t SIM_CHANNEL_COUNT = 13;
+constexpr uint32_t SIM_ACTIVE_DWELL_MS = 120;
+constexpr uint32_t SIM_PASSIVE_DWELL_MS = 360;
+constexpr uint32_t SIM_HOME_DWELL_MS = 30;
+
+struct SimAp {
+    const char* ssid;  ///< Empty for a hidden network
+    uint8_t bssid[6];
+    uint8_t channel;
+    int8_t rssi;
+    wifi_auth_mode_t authmode;
+};
+
+// What a scan finds; the first entry is the AP every connect joins
+static const SimAp SIM_APS[] = {
+    {"HostSimNet", {0x02, 0x00, 0x00, 0x5A, 0x11, 0x01}, SIM_CHANNEL, -48, WIFI_AUTH_WPA2_PSK},
+    {"Neighbour", {0x02, 0x00, 0x00, 0x5A, 0x22, 0x02}, 1, -71, WIFI_AUTH_WPA_WPA2_PSK},
+    {"CoffeeShop", {0x02, 0x00, 0x00, 0x5A, 0x33, 0x03}, 11, -83, WIFI_AUTH_OPEN},
+    {"", {0x02, 0x00, 0x00, 0x5A, 0x44, 0x04}, 3, -77, WIFI_AUTH_WPA2_PSK},
+};
+
+struct esp_netif_obj {
+    const char* if_key;
+    esp_netif_ip_info_t ip_info;
+};
+
+static constexpr uint32_t ipv4(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+    // esp_ip4_addr_t is stored in network byte order on a little-endian host
+    return static_cast<uint32_t>(a) | static_cast<uint32_t>(b) << 8 |
+           static_cast<uint32_t>(c) << 16 | static_cast<uint32_t>(d) << 24;
+}
+
+static esp_netif_obj ap_netif = {
+    "WIFI_AP_DEF",
+    {{ipv4(192, 168, 4, 1)}, {ipv4(255, 255, 255, 0)}, {ipv4(192, 168, 4, 1)}}};
+static esp_netif_obj sta_netif = {"WIFI_STA_DEF", {}};
+
+static std::mutex wifi_mutex;
+static bool initialized = false;
+static bool started = false;
+static bool sta_connecting = false;  ///< An attempt is running in connectTask()
+static bool sta_connected = false;
+static uint32_t connect_attempt = 0;  ///< Bumped to cancel the attempt in flight
+static wifi_mode_t current_mode = WIFI_MODE_NULL;
+static wifi_config_t ap_config = {};
+static wifi_config_t sta_config = {};
+static bool scanning = false;
+static uint32_t scan_attempt = 0;  ///< Bumped to cancel the scan in flight
+static wifi_scan_config_t scan_config = {};
+static std::vector<wifi_ap_record_t> scan_results;  ///< Until read or cleared
+
+static bool hasAp(wifi_mode_t mode) {
+    return mode == WIFI_MODE_AP || mode == WIFI_MODE_APSTA;
+}
+
+static bool hasSta(wifi_mode_t mode) {
+    return mode == WIFI_MODE_STA || mode == WIFI_MODE_APSTA;
+}
+
+// Events are posted outside wifi_mutex so handlers may call back into the driver
+static void post(esp_event_base_t base, int32_t id, const void* data = nullptr, size_t size = 0) {
+    esp_err_t err = esp_event_post(base, id, data, size, portMAX_DELAY);
+    if (err != ESP_OK) ESP_LOGW(TAG, "Dropped event %ld: %s", (long)id, esp_err_to_name(err));
+}
+
+extern "C" esp_err_t esp_netif_init(void) {
+    return ESP_OK;
+}
+
+extern "C" esp_netif_t* esp_netif_create_default_wifi_ap(void) {
+    return &ap_netif;
+}
+
+extern "C" esp_netif_t* esp_netif_create_default_wifi_sta(void) {
+    return &sta_netif;
+}
+
+extern "C" esp_netif_t* esp_netif_get_handle_from_ifkey(const char* if_key) {
+    if (if_key && strcmp(if_key, ap_netif.if_key) == 0) return &ap_netif;
+    if (if_key && strcmp(if_key, sta_netif.if_key) == 0) return &sta_netif;
+    return nullptr;
+}
+
+extern "C" esp_err_t esp_netif_get_ip_info(esp_netif_t* esp_netif, esp_netif_ip_info_t* ip_info) {
+    if (!esp_netif || !ip_info) return ESP_ERR_INVALID_ARG;
+
+    std::lock_guard<std::mutex> lock(wifi_mutex);
+    *ip_info = esp_netif->ip_info;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_wifi_init(const wifi_init_config_t* config) {
+    if (!config || config->magic != WIFI_INIT_CONFIG_MAGIC) return ESP_ERR_INVALID_ARG;
+
+    std::lock_guard<std::mutex> lock(wifi_mutex);
+    initialized = true;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_wifi_deinit(void) {
+    std::lock_guard<std::mutex> lock(wifi_mutex);
+    if (started) return ESP_ERR_INVALID_STATE;
+    initialized = false;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_wifi_set_storage(wifi_storage_t storage) {
+    // Nothing is persisted on the host either way
+    std::lock_guard<std::mutex> lock(wifi_mutex);
+    return initialized ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+}
+
+extern "C" esp_err_t esp_wifi_set_mode(wifi_mode_t mode) {
+    if (mode >= WIFI_MODE_MAX) return ESP_ERR_INVALID_ARG;
+
+    std::lock_guard<std::mutex> lock(wifi_mutex);
+    if (!initialized) return ESP_ERR_WIFI_NOT_INIT;
+    current_mode = mode;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_wifi_get_mode(wifi_mode_t* mode) {
+    if (!mode) return ESP_ERR_INVALID_ARG;
+
+    std::lock_guard<std::mutex> lock(wifi_mutex);
+    if (!initialized) return ESP_ERR_WIFI_NOT_INIT;
+    *mode = current_mode;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t* conf) {
+    if (!conf) return ESP_ERR_INVALID_ARG;
+
+    std::lock_guard<std::mutex> lock(wifi_mutex);
+    if (!initialized) return ESP_ERR_WIFI_NOT_INIT;
+    if (interface == WIFI_IF_AP) {
+        if (!hasAp(current_mode)) return ESP_ERR_WIFI_MODE;
+        ap_config = *conf;
+    } else {
+        if (!hasSta(current_mode)) return ESP_ERR_WIFI_MODE;
+        sta_config = *conf;
+    }
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t* conf) {
+    if (!conf) return ESP_ERR_INVALID_ARG;
+
+    std::lock_guard<std::mutex> lock(wifi_mutex);
+    if (!initialized) return ESP_ERR_WIFI_NOT_INIT;
+    *conf = interface == WIFI_IF_AP ? ap_config : sta_config;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_wifi_start(void) {
+    wifi_mode_t mode;
+    {
+        std::lock_guard<std::mutex> lock(wifi_mutex);
+        if (!initialized) return ESP_ERR_WIFI_NOT_INIT;
+        if (started) return ESP_OK;
+        started = true;
+        mode = current_mode;
+    }
+
+    if (hasSta(mode)) post(WIFI_EVENT, WIFI_EVENT_STA_START);
+    if (hasAp(mode)) post(WIFI_EVENT, WIFI_EVENT_AP_START);
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_wifi_stop(void) {
+    wifi_mode_t mode;
+    bool had_link;
+    bool had_scan;
+    {
+        std::lock_guard<std::mutex> lock(wifi_mutex);
+        if (!initialized) return ESP_ERR_WIFI_NOT_INIT;
+        if (!started) return ESP_OK;
+        started = false;
+        connect_attempt++;
+        had_link = sta_connected || sta_connecting;
+        sta_connected = false;
+        sta_connecting = false;
+        sta_netif.ip_info = {};
+        mode = current_mode;
+        scan_attempt++;
+        had_scan = scanning;
+        scanning = false;
+    }
+
+    if (had_scan) {
+        wifi_event_sta_scan_done_t done = {};
+        done.status = 1;
+        post(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, &done, sizeof(done));
+    }
+
+    if (had_link) {
+        wifi_event_sta_disconnected_t event = {};
+        event.reason = WIFI_REASON_ASSOC_LEAVE;
+        post(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &event, sizeof(event));
+    }
+    if (hasSta(mode)) post(WIFI_EVENT, WIFI_EVENT_STA_STOP);
+    if (hasAp(mode)) post(WIFI_EVENT, WIFI_EVENT_AP_STOP);
+    return ESP_OK;
+}
+
+// Waits out one connect stage; false if the attempt was cancelled meanwhile
+static bool runStage(uint32_t attempt, uint32_t ms) {
+    vTaskDelay(pdMS_TO_TICKS(ms));
+    std::lock_guard<std::mutex> lock(wifi_mutex);
+    return attempt == connect_attempt;
+}
+
+// Any non-empty SSID "exists" on SIM_CHANNEL as SIM_BSSID, and hands out a
+// fixed lease. A bssid_set naming another AP is never found.
+static void runConnect(uint32_t attempt) {
+    wifi_event_sta_connected_t connected = {};
+    bool found;
+    uint32_t scan_ms;
+    {
+        std::lock_guard<std::mutex> lock(wifi_mutex);
+        const wifi_sta_config_t& sta = sta_config.sta;
+        size_t ssid_len = strnlen(reinterpret_cast<const char*>(sta.ssid), sizeof(sta.ssid));
+        bool bssid_ok = !sta.bssid_set || memcmp(sta.bssid, SIM_BSSID, sizeof(SIM_BSSID)) == 0;
+        found = ssid_len > 0 && bssid_ok;
+
+        // The hinted channel is scanned first; a miss carries on across the rest
+        scan_ms = found && sta.channel == SIM_CHANNEL ? SIM_CHANNEL_SCAN_MS : SIM_FULL_SCAN_MS;
+
+        memcpy(connected.ssid, sta.ssid, ssid_len);
+        connected.ssid_len = ssid_len;
+        memcpy(connected.bssid, SIM_BSSID, sizeof(SIM_BSSID));
+        connected.channel = SIM_CHANNEL;
+        connected.authmode = sta.threshold.authmode;
+    }
+
+    if (!runStage(attempt, scan_ms)) return;
+    if (!found) {
+        {
+            std::lock_guard<std::mutex> lock(wifi_mutex);
+            if (attempt == connect_attempt) sta_connecting = false;
+        }
+        wifi_event_sta_disconnected_t failed = {};
+        failed.reason = WIFI_REASON_NO_AP_FOUND;
+        post(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &failed, sizeof(failed));
+        return;
+    }
+
+    if (!runStage(attempt, SIM_ASSOC_MS)) return;
+    {
+        std::lock_guard<std::mutex> lock(wifi_mutex);
+        sta_connected = true;
+    }
+    post(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, &connected, sizeof(connected));
+
+    if (!runStage(attempt, SIM_DHCP_MS)) return;
+    ip_event_got_ip_t got_ip = {};
+    {
+        std::lock_guard<std::mutex> lock(wifi_mutex);
+        sta_connecting = false;
+        sta_netif.ip_info = {
+            {ipv4(192, 168, 1, 50)}, {ipv4(255, 255, 255, 0)}, {ipv4(192, 168, 1, 1)}};
+        got_ip.esp_netif = &sta_netif;
+        got_ip.ip_info = sta_netif.ip_info;
+        got_ip.ip_changed = true;
+    }
+    post(IP_EVENT, IP_EVENT_STA_GOT_IP, &got_ip, sizeof(got_ip));
+}
+
+static void connectTask(void* arg) {
+    runConnect(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(arg)));
+    vTaskDelete(nullptr);
+}
+
+// Starts an attempt in the background, as the driver does; a running one is dropped
+extern "C" esp_err_t esp_wifi_connect(void) {
+    uint32_t attempt;
+    {
+        std::lock_guard<std::mutex> lock(wifi_mutex);
+        if (!initialized) return ESP_ERR_WIFI_NOT_INIT;
+        if (!started) return ESP_ERR_WIFI_NOT_STARTED;
+        if (!hasSta(current_mode)) return ESP_ERR_WIFI_MODE;
+
+        attempt = ++connect_attempt;
+        sta_connecting = true;
+        sta_connected = false;
+        sta_netif.ip_info = {};
+    }
+
+    void* arg = reinterpret_cast<void*>(static_cast<uintptr_t>(attempt));
+    if (xTaskCreate(connectTask, "sim_wifi_connect", 4096, arg, 5, nullptr) != pdPASS) {
+        std::lock_guard<std::mutex> lock(wifi_mutex);
+        sta_connecting = false;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_wifi_disconnect(void) {
+    {
+        std::lock_guard<std::mutex> lock(wifi_mutex);
+        if (!initialized) return ESP_ERR_WIFI_NOT_INIT;
+        if (!started) return ESP_ERR_WIFI_NOT_STARTED;
+        connect_attempt++;
+        if (!sta_connected && !sta_connecting) return ESP_OK;
+        sta_connected = false;
+        sta_connecting = false;
+        sta_netif.ip_info = {};
+    }
+
+    wifi_event_sta_disconnected_t event = {};
+    event.reason = WIFI_REASON_ASSOC_LEAVE;
+    post(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &event, sizeof(event));
+    return ESP_OK;
+}
+
+static bool matchesScan(const SimAp& ap, const wifi_scan_config_t& config) {
+    if (config.channel && ap.channel != config.channel) return false;
+    if (ap.ssid[0] == '\0' && !config.show_hidden) return false;
+    if (config.ssid && strcmp(ap.ssid, reinterpret_cast<const char*>(config.ssid)) != 0) {
+        return false;
+    }
+    return !config.bssid || memcmp(ap.bssid, config.bssid, sizeof(ap.bssid)) == 0;
+}
+
+// Dwells on each channel in turn, back home in between while the AP runs, then
+// reports whatever SIM_APS the filters let through
+static void runScan(uint32_t attempt) {
+    wifi_scan_config_t config;
+    uint32_t channel_ms;
+    {
+        std::lock_guard<std::mutex> lock(wifi_mutex);
+        config = scan_config;
+        if (config.scan_type == WIFI_SCAN_TYPE_PASSIVE) {
+            channel_ms = config.scan_time.passive ? config.scan_time.passive
+                                                  : SIM_PASSIVE_DWELL_MS;
+        } else {
+            channel_ms = config.scan_time.active.max ? config.scan_time.active.max
+                                                     : SIM_ACTIVE_DWELL_MS;
+        }
+        if (hasAp(current_mode)) {
+            channel_ms += config.home_chan_dwell_time ? config.home_chan_dwell_time
+                                                      : SIM_HOME_DWELL_MS;
+        }
+    }
+
+    uint8_t channels = config.channel ? 1 : SIM_CHANNEL_COUNT;
+    for (uint8_t i = 0; i < channels; i++) {
+        vTaskDelay(pdMS_TO_TICKS(channel_ms));
+        std::lock_guard<std::mutex> lock(wifi_mutex);
+        if (attempt != scan_attempt) return;
+    }
+
+    wifi_event_sta_scan_done_t done = {};
+    {
+        std::lock_guard<std::mutex> lock(wifi_mutex);
+        if (attempt != scan_attempt) return;
+        scanning = false;
+        scan_results.clear();
+        for (const SimAp& ap : SIM_APS) {
+            if (!matchesScan(ap, config)) continue;
+            wifi_ap_record_t record = {};
+            memcpy(record.bssid, ap.bssid, sizeof(record.bssid));
+            strncpy(reinterpret_cast<char*>(record.ssid), ap.ssid, sizeof(record.ssid) - 1);
+            record.primary = ap.channel;
+            record.rssi = ap.rssi;
+            record.authmode = ap.authmode;
+            scan_results.push_back(record);
+        }
+        done.number = static_cast<uint8_t>(scan_results.size());
+        done.scan_id = static_cast<uint8_t>(attempt);
+    }
+    post(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, &done, sizeof(done));
+}
+
+static void scanTask(void* arg) {
+    runScan(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(arg)));
+    vTaskDelete(nullptr);
+}
+
+// Like the driver, refuses while the station is connecting or another scan runs
+extern "C" esp_err_t esp_wifi_scan_start(const wifi_scan_config_t* config, bool block) {
+    static uint8_t ssid_filter[33];
+    static uint8_t bssid_filter[6];
+    uint32_t attempt;
+    {
+        std::lock_guard<std::mutex> lock(wifi_mutex);
+        if (!initialized) return ESP_ERR_WIFI_NOT_INIT;
+        if (!started) return ESP_ERR_WIFI_NOT_STARTED;
+        if (!hasSta(current_mode)) return ESP_ERR_WIFI_MODE;
+        if (scanning || sta_connecting) return ESP_ERR_WIFI_STATE;
+
+        scan_config = config ? *config : wifi_scan_config_t{};
+        if (scan_config.ssid) {
+            strncpy(reinterpret_cast<char*>(ssid_filter),
+                    reinterpret_cast<const char*>(scan_config.ssid), sizeof(ssid_filter) - 1);
+            scan_config.ssid = ssid_filter;
+        }
+        if (scan_config.bssid) {
+            memcpy(bssid_filter, scan_config.bssid, sizeof(bssid_filter));
+            scan_config.bssid = bssid_filter;
+        }
+        attempt = ++scan_attempt;
+        scanning = true;
+        scan_results.clear();
+    }
+
+    if (block) {
+        runScan(attempt);
+        return ESP_OK;
+    }
+    void* arg = reinterpret_cast<void*>(static_cast<uintptr_t>(attempt));
+    if (xTaskCreate(scanTask, "sim_wifi_scan", 4096, arg, 5, nullptr) != pdPASS) {
+        std::lock_guard<std::mutex> lock(wifi_mutex);
+        scanning = false;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_wifi_scan_stop(void) {
+    {
+        std::lock_guard<std::mutex> lock(wifi_mutex);
+        if (!initialized) return ESP_ERR_WIFI_NOT_INIT;
+        if (!started) return ESP_ERR_WIFI_NOT_STARTED;
+        scan_attempt++;
+        if (!scanning) return ESP_OK;
+        scanning = false;
+    }
+
+    wifi_event_sta_scan_done_t done = {};
+    done.status = 1;
+    post(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, &done, sizeof(done));
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_wifi_scan_get_ap_num(uint16_t* number) {
+    if (!number) return ESP_ERR_INVALID_ARG;
+
+    std::lock_guard<std::mutex> lock(wifi_mutex);
+    if (!initialized) return ESP_ERR_WIFI_NOT_INIT;
+    *number = static_cast<uint16_t>(scan_results.size());
+    return ESP_OK;
+}
+
+// Hands out and forgets one record per call, as the driver does
+extern "C" esp_err_t esp_wifi_scan_get_ap_record(wifi_ap_record_t* ap_record) {
+    if (!ap_record) return ESP_ERR_INVALID_ARG;
+
+    std::lock_guard<std::mutex> lock(wifi_mutex);
+    if (!initialized) return ESP_ERR_WIFI_NOT_INIT;
+    if (scan_results.empty()) return ESP_FAIL;
+    *ap_record = scan_results.front();
+    scan_results.erase(scan_results.begin());
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_wifi_clear_ap_list(void) {
+    std::lock_guard<std::mutex> lock(wifi_mutex);
+    if (!initialized) return ESP_ERR_WIFI_NOT_INIT;
+    scan_results.clear();
+    return ESP_OK;
+}
@@ -0,0 +1,37 @@
+#include <stdio.h>
+
+#include "unity.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void setUp(void) {
+    // Set up before every test
+}
+
+void tearDown(void) {
+    // Clean up after every test
+}
+
+// esp_http_server shim tests
+void test_host_httpd_serves_requests();
+void test_host_httpd_parses_query();
+
+#ifdef __cplusplus
+}
+#endif
+
+TEST_CASE("HTTPD: Serves requests over a socket", "[httpd]") {
+    test_host_httpd_serves_requests();
+}
+
+TEST_CASE("HTTPD: Parses query parameters", "[httpd]") {
+    test_host_httpd_parses_query();
+}
+
+void app_main(void) {
+    UNITY_BEGIN();
+    unity_run_all_tests();
+    UNITY_END();
+}
@@ -0,0 +1,132 @@
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "esp_http_server.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "unity.h"
+
+constexpr uint16_t TEST_PORT = 18080;
+constexpr TickType_t RESPONSE_TIMEOUT = pdMS_TO_TICKS(2000);
+
+static esp_err_t echoHandler(httpd_req_t* req) {
+    char body[32] = {};
+    int len = httpd_req_recv(req, body, sizeof(body) - 1);
+    if (len < 0) return ESP_FAIL;
+
+    char query[32];
+    char name[16] = "";
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        httpd_query_key_value(query, "name", name, sizeof(name));
+    }
+
+    char out[64];
+    snprintf(out, sizeof(out), "%s:%s", name, body);
+    httpd_resp_set_hdr(req, "X-Test", "1");
+    return httpd_resp_sendstr(req, out);
+}
+
+static esp_err_t chunkHandler(httpd_req_t* req) {
+    httpd_resp_set_type(req, HTTPD_TYPE_JSON);
+    httpd_resp_send_chunk(req, "ab", 2);
+    httpd_resp_send_chunk(req, "cd", 2);
+    return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
+// Non-blocking reads with vTaskDelay, so the server task runs while we wait
+static std::string readUntil(int fd, const char* marker) {
+    std::string in;
+    TickType_t start = xTaskGetTickCount();
+    while (in.find(marker) == std::string::npos &&
+           xTaskGetTickCount() - start < RESPONSE_TIMEOUT) {
+        char buf[512];
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n > 0) {
+            in.append(buf, n);
+        } else if (n == 0) {
+            break;
+        } else {
+            vTaskDelay(1);
+        }
+    }
+    return in;
+}
+
+static int connectClient() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(TEST_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL(0, connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)));
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+/// @brief Verifies keep-alive, pipelining, bodies, chunking and error statuses over a socket.
+extern "C" void test_host_httpd_serves_requests() {
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = TEST_PORT;
+    httpd_handle_t server = nullptr;
+    TEST_ASSERT_EQUAL(ESP_OK, httpd_start(&server, &config));
+
+    httpd_uri_t echo = {"/echo", HTTP_POST, echoHandler, nullptr};
+    httpd_uri_t chunk = {"/chunk", HTTP_GET, chunkHandler, nullptr};
+    TEST_ASSERT_EQUAL(ESP_OK, httpd_register_uri_handler(server, &echo));
+    TEST_ASSERT_EQUAL(ESP_OK, httpd_register_uri_handler(server, &chunk));
+    TEST_ASSERT_EQUAL(ESP_ERR_HTTPD_HANDLER_EXISTS, httpd_register_uri_handler(server, &echo));
+
+    int fd = connectClient();
+    const char* pipelined =
+        "POST /echo?name=probe HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello"
+        "GET /chunk HTTP/1.1\r\n\r\n";
+    TEST_ASSERT_EQUAL(strlen(pipelined), send(fd, pipelined, strlen(pipelined), 0));
+
+    std::string in = readUntil(fd, "0\r\n\r\n");
+    TEST_ASSERT_TRUE(in.find("HTTP/1.1 200 OK\r\n") == 0);
+    TEST_ASSERT_TRUE(in.find("X-Test: 1\r\n") != std::string::npos);
+    TEST_ASSERT_TRUE(in.find("\r\n\r\nprobe:hello") != std::string::npos);
+    TEST_ASSERT_TRUE(in.find("Transfer-Encoding: chunked") != std::string::npos);
+    TEST_ASSERT_TRUE(in.find("2\r\nab\r\n2\r\ncd\r\n0\r\n\r\n") != std::string::npos);
+
+    // Same connection: unknown URI, then a known URI with the wrong method
+    const char* missing = "GET /missing HTTP/1.1\r\n\r\nDELETE /echo HTTP/1.1\r\n\r\n";
+    send(fd, missing, strlen(missing), 0);
+    in = readUntil(fd, "405");
+    TEST_ASSERT_TRUE(in.find("HTTP/1.1 404 Not Found") == 0);
+    TEST_ASSERT_TRUE(in.find("HTTP/1.1 405 Method Not Allowed") != std::string::npos);
+
+    const char* last = "POST /echo HTTP/1.1\r\nConnection: close\r\nContent-Length: 2\r\n\r\nok";
+    send(fd, last, strlen(last), 0);
+    in = readUntil(fd, "\r\n\r\n:ok");
+    TEST_ASSERT_TRUE(in.find("Connection: close") != std::string::npos);
+    vTaskDelay(pdMS_TO_TICKS(50));
+    char byte;
+    TEST_ASSERT_EQUAL(0, recv(fd, &byte, 1, 0));  // Closed by the server
+
+    close(fd);
+    TEST_ASSERT_EQUAL(ESP_OK, httpd_stop(server));
+}
+
+/// @brief Verifies query parsing, including missing keys and truncation.
+extern "C" void test_host_httpd_parses_query() {
+    char value[6];
+    TEST_ASSERT_EQUAL(ESP_OK, httpd_query_key_value("a=1&sensor=12&to=9", "sensor", value,
+                                                    sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("12", value);
+    TEST_ASSERT_EQUAL(ESP_OK, httpd_query_key_value("flag=&b=2", "flag", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("", value);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND,
+                      httpd_query_key_value("sensors=1", "sensor", value, sizeof(value)));
+    TEST_ASSERT_EQUAL(ESP_ERR_HTTPD_RESULT_TRUNC,
+                      httpd_query_key_value("from=1700000000", "from", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("17000", value);
+}
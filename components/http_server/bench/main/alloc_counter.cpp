@@ -0,0 +1,88 @@
+#include "alloc_counter.hpp"
+
+#include <malloc.h>
+
+#include <atomic>
+#include <cerrno>
+
+// glibc's own entry points; the definitions below take the public names
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+}
+
+static std::atomic<uint64_t> allocations{0};
+static std::atomic<size_t> in_use{0};
+static std::atomic<size_t> peak{0};
+
+static void* track(void* ptr) {
+    if (!ptr) return ptr;
+
+    size_t size = malloc_usable_size(ptr);
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    size_t now = in_use.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t high = peak.load(std::memory_order_relaxed);
+    while (now > high && !peak.compare_exchange_weak(high, now, std::memory_order_relaxed)) {
+    }
+    return ptr;
+}
+
+static void untrack(void* ptr) {
+    if (ptr) in_use.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+}
+
+extern "C" void* malloc(size_t size) {
+    return track(__libc_malloc(size));
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    return track(__libc_calloc(count, size));
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    // Counted as a fresh allocation; a shrink or grow is work the caller asked for
+    untrack(ptr);
+    void* moved = __libc_realloc(ptr, size);
+    if (!moved && ptr && size) {
+        // The old block is still live
+        in_use.fetch_add(malloc_usable_size(ptr), std::memory_order_relaxed);
+        return nullptr;
+    }
+    return track(moved);
+}
+
+extern "C" void* memalign(size_t alignment, size_t size) {
+    return track(__libc_memalign(alignment, size));
+}
+
+extern "C" void* aligned_alloc(size_t alignment, size_t size) {
+    return track(__libc_memalign(alignment, size));
+}
+
+extern "C" int posix_memalign(void** out, size_t alignment, size_t size) {
+    void* ptr = track(__libc_memalign(alignment, size));
+    if (!ptr) return ENOMEM;
+    *out = ptr;
+    return 0;
+}
+
+extern "C" void free(void* ptr) {
+    untrack(ptr);
+    __libc_free(ptr);
+}
+
+namespace AllocCounter {
+
+Stats read() {
+    return {allocations.load(std::memory_order_relaxed), in_use.load(std::memory_order_relaxed),
+            peak.load(std::memory_order_relaxed)};
+}
+
+void resetPeak() {
+    peak.store(in_use.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+}  // namespace AllocCounter
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Process-wide heap accounting for the host benchmark.
+ *
+ * malloc and friends are interposed over glibc's, so every allocation in the
+ * process is seen, including those made by the esp_http_server shim. Bytes are
+ * counted with malloc_usable_size(), i.e. what the allocator actually reserved.
+ */
+namespace AllocCounter {
+
+struct Stats {
+    uint64_t allocations;  ///< Successful allocations since start-up
+    size_t in_use;         ///< Bytes currently allocated
+    size_t peak;           ///< Highest in_use since the last resetPeak()
+};
+
+Stats read();
+
+/**
+ * @brief Restart high-water tracking from the current in-use figure.
+ */
+void resetPeak();
+
+}  // namespace AllocCounter
@@ -0,0 +1,294 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "alloc_counter.hpp"
+#include "config_manager.hpp"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "http_server.hpp"
+#include "load_generator.hpp"
+#include "nvs_flash.h"
+#include "sensor_manager.hpp"
+#include "wifi_manager.hpp"
+
+static const char* TAG = "http_bench";
+
+constexpr double ALLOC_SLACK_PER_REQUEST = 0.5;
+constexpr double HEAP_SLACK_BYTES = 1024;  // Overlapping requests make the peak jitter
+
+/**
+ * @brief What the benchmark sends to one HttpServer route.
+ */
+struct Workload {
+    const char* uri;  ///< As registered
+    httpd_method_t method;
+    const char* target;  ///< Request target, query included; nullptr to skip the route
+    const char* body;
+    uint16_t status = 0;  ///< Expected answer; 0 accepts any 2xx or 3xx
+};
+
+// One entry per route in HttpServer::ROUTES. A route without an entry fails the
+// run, so new endpoints are benchmarked from the start.
+static const Workload WORKLOADS[] = {
+    {"/", HTTP_GET, "/", nullptr},
+    {"/favicon.ico", HTTP_GET, "/favicon.ico", nullptr},
+    {"/api/device/info", HTTP_GET, "/api/device/info", nullptr},
+    {"/api/device/info", HTTP_PATCH, "/api/device/info", "{\"device_name\":\"bench-device\"}"},
+    {"/api/network/ap/set", HTTP_POST, "/api/network/ap/set",
+     "{\"ap_ssid\":\"BenchAP\",\"ap_password\":\"bench-pass\",\"ap_enabled\":true}"},
+    {"/api/network/sta/connect", HTTP_POST, "/api/network/sta/connect",
+     "{\"ssid\":\"BenchNet\",\"password\":\"bench-pass\"}"},
+    {"/api/network/sta/disconnect", HTTP_POST, "/api/network/sta/disconnect", nullptr},
+    {"/api/network/status", HTTP_GET, "/api/network/status", nullptr},
+    // WiFiManager is not started here, so every scan request is turned away
+    {"/api/network/scan", HTTP_POST, "/api/network/scan", nullptr, 503},
+    {"/api/network/scan", HTTP_GET, "/api/network/scan?offset=0&limit=10", nullptr},
+    {"/api/sensors/history", HTTP_GET, "/api/sensors/history?sensor=0&from=0&to=60", nullptr},
+    // Long-lived streams cost per event, not per request
+    {"/api/sensors/stream", HTTP_GET, nullptr, nullptr},
+    {"/ws", HTTP_GET, nullptr, nullptr},
+    {"/metrics", HTTP_GET, "/metrics", nullptr},
+};
+
+/**
+ * @brief Aggregate figures compared against the baseline file.
+ */
+struct BenchMetric {
+    const char* key;
+    double value;
+    enum { LowerIsBetter, HigherIsBetter, Count, Bytes } kind;
+};
+
+static const char* methodName(httpd_method_t method) {
+    switch (method) {
+        case HTTP_GET:
+            return "GET";
+        case HTTP_POST:
+            return "POST";
+        case HTTP_PUT:
+            return "PUT";
+        case HTTP_PATCH:
+            return "PATCH";
+        case HTTP_DELETE:
+            return "DELETE";
+        default:
+            return "?";
+    }
+}
+
+static const Workload* findWorkload(const HttpServer::Route& route) {
+    for (const Workload& workload : WORKLOADS) {
+        if (workload.method == route.method && strcmp(workload.uri, route.uri) == 0) {
+            return &workload;
+        }
+    }
+    return nullptr;
+}
+
+static std::string buildRequest(const Workload& workload) {
+    std::string request = std::string(methodName(workload.method)) + " " + workload.target +
+                          " HTTP/1.1\r\nHost: 127.0.0.1\r\n";
+    if (workload.body) {
+        request += "Content-Type: application/json\r\nContent-Length: " +
+                   std::to_string(strlen(workload.body)) + "\r\n\r\n" + workload.body;
+    } else {
+        request += "\r\n";
+    }
+    return request;
+}
+
+// Nearest-rank percentile of sorted samples
+static uint32_t percentile(const std::vector<uint32_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+    return sorted[rank ? rank - 1 : 0];
+}
+
+static bool readBaseline(const char* key, double& value) {
+    FILE* file = fopen(HTTP_BENCH_BASELINE_PATH, "r");
+    if (!file) return false;
+
+    char line[96];
+    char name[48];
+    bool found = false;
+    while (!found && fgets(line, sizeof(line), file)) {
+        if (line[0] == '#') continue;
+        found = sscanf(line, "%47s %lf", name, &value) == 2 && strcmp(name, key) == 0;
+    }
+    fclose(file);
+    return found;
+}
+
+static bool writeBaseline(const BenchMetric* metrics, size_t count) {
+    FILE* file = fopen(HTTP_BENCH_BASELINE_PATH, "w");
+    if (!file) return false;
+
+    fprintf(file,
+            "# HttpServer host benchmark baseline (%d connections, %d requests per route).\n"
+            "# Regenerate with HTTP_BENCH_WRITE_BASELINE=1 after an intended change.\n",
+            CONFIG_HTTP_BENCH_CONNECTIONS, CONFIG_HTTP_BENCH_REQUESTS_PER_ROUTE);
+    for (size_t i = 0; i < count; i++) {
+        fprintf(file, "%s %.1f\n", metrics[i].key, metrics[i].value);
+    }
+    return fclose(file) == 0;
+}
+
+// Prints one line per metric; returns false if any regressed past the tolerance
+static bool compareBaseline(const BenchMetric* metrics, size_t count) {
+    const double tolerance = CONFIG_HTTP_BENCH_TOLERANCE_PCT / 100.0;
+    bool ok = true;
+
+    printf("\n%-20s %12s %12s\n", "metric", "baseline", "measured");
+    for (size_t i = 0; i < count; i++) {
+        const BenchMetric& metric = metrics[i];
+        double baseline = 0;
+        if (!readBaseline(metric.key, baseline)) {
+            printf("%-20s %12s %12.1f  no baseline\n", metric.key, "-", metric.value);
+            ok = false;
+            continue;
+        }
+
+        bool regressed = false;
+        switch (metric.kind) {
+            case BenchMetric::LowerIsBetter:
+                regressed = metric.value > baseline * (1.0 + tolerance);
+                break;
+            case BenchMetric::HigherIsBetter:
+                regressed = metric.value < baseline * (1.0 - tolerance);
+                break;
+            case BenchMetric::Count:
+                regressed = metric.value > baseline + ALLOC_SLACK_PER_REQUEST;
+                break;
+            case BenchMetric::Bytes:
+                regressed = metric.value > baseline * (1.0 + tolerance) + HEAP_SLACK_BYTES;
+                break;
+        }
+        printf("%-20s %12.1f %12.1f  %s\n", metric.key, baseline, metric.value,
+               regressed ? "REGRESSED" : "ok");
+        ok = ok && !regressed;
+    }
+    return ok;
+}
+
+static bool runBenchmark() {
+    std::vector<std::string> requests;
+    std::vector<std::string> names;
+    std::vector<uint16_t> expected;
+    for (size_t i = 0; i < HttpServer::ROUTE_COUNT; i++) {
+        const HttpServer::Route& route = HttpServer::ROUTES[i];
+        std::string name = std::string(methodName(route.method)) + " " + route.uri;
+
+        const Workload* workload = findWorkload(route);
+        if (!workload) {
+            ESP_LOGE(TAG, "No workload for %s; add one to WORKLOADS", name.c_str());
+            return false;
+        }
+        if (!workload->target || route.websocket) {
+            printf("%-36s skipped (stream)\n", name.c_str());
+            continue;
+        }
+        requests.push_back(buildRequest(*workload));
+        names.push_back(name);
+        expected.push_back(workload->status);
+    }
+
+    const size_t measured = requests.size() * CONFIG_HTTP_BENCH_REQUESTS_PER_ROUTE;
+    LoadGenerator load(CONFIG_HOST_SIM_HTTPD_PORT, CONFIG_HTTP_BENCH_CONNECTIONS);
+    LoadGenerator::Result result;
+    if (!load.run(requests, measured, result)) {
+        ESP_LOGE(TAG, "Load run failed: %s", load.error());
+        return false;
+    }
+
+    // Per-route latency, then the whole run
+    std::vector<std::vector<uint32_t>> by_route(requests.size());
+    std::vector<uint32_t> all;
+    all.reserve(result.samples.size());
+    bool statuses_ok = true;
+    for (const LoadGenerator::Sample& sample : result.samples) {
+        uint16_t expect = expected[sample.request];
+        if (expect ? sample.status != expect : sample.status < 200 || sample.status >= 400) {
+            if (statuses_ok) {
+                ESP_LOGE(TAG, "%s answered %u", names[sample.request].c_str(), sample.status);
+            }
+            statuses_ok = false;
+        }
+        by_route[sample.request].push_back(sample.latency_us);
+        all.push_back(sample.latency_us);
+    }
+
+    printf("\n%-36s %8s %8s %8s %8s\n", "route", "n", "p50 us", "p95 us", "p99 us");
+    for (size_t i = 0; i < requests.size(); i++) {
+        std::vector<uint32_t>& samples = by_route[i];
+        std::sort(samples.begin(), samples.end());
+        printf("%-36s %8u %8u %8u %8u\n", names[i].c_str(), (unsigned)samples.size(),
+               (unsigned)percentile(samples, 50), (unsigned)percentile(samples, 95),
+               (unsigned)percentile(samples, 99));
+    }
+    std::sort(all.begin(), all.end());
+
+    double seconds = result.elapsed_us / 1e6;
+    uint64_t allocations = result.end.allocations - result.start.allocations;
+    size_t heap_peak = result.end.peak - result.start.in_use;
+    const BenchMetric metrics[] = {
+        {"p50_us", static_cast<double>(percentile(all, 50)), BenchMetric::LowerIsBetter},
+        {"p95_us", static_cast<double>(percentile(all, 95)), BenchMetric::LowerIsBetter},
+        {"p99_us", static_cast<double>(percentile(all, 99)), BenchMetric::LowerIsBetter},
+        {"requests_per_s", all.size() / seconds, BenchMetric::HigherIsBetter},
+        {"allocs_per_request", static_cast<double>(allocations) / all.size(), BenchMetric::Count},
+        {"heap_peak_bytes", static_cast<double>(heap_peak), BenchMetric::Bytes},
+    };
+    const size_t metric_count = sizeof(metrics) / sizeof(metrics[0]);
+
+    printf("%-36s %8u %8u %8u %8u\n", "all", (unsigned)all.size(), (unsigned)percentile(all, 50),
+           (unsigned)percentile(all, 95), (unsigned)percentile(all, 99));
+    printf("\n%.0f requests/s over %d connections, %.2f allocations/request, "
+           "heap high-water %u bytes above idle\n",
+           metrics[3].value, CONFIG_HTTP_BENCH_CONNECTIONS, metrics[4].value, (unsigned)heap_peak);
+
+    if (!statuses_ok) return false;
+
+    if (getenv("HTTP_BENCH_WRITE_BASELINE")) {
+        if (!writeBaseline(metrics, metric_count)) {
+            ESP_LOGE(TAG, "Could not write %s", HTTP_BENCH_BASELINE_PATH);
+            return false;
+        }
+        ESP_LOGI(TAG, "Baseline written to %s", HTTP_BENCH_BASELINE_PATH);
+        return true;
+    }
+    return compareBaseline(metrics, metric_count);
+}
+
+// Boots the same services as host_app, drives every route from
+// CONFIG_HTTP_BENCH_CONNECTIONS local connections and exits non-zero when a
+// figure regresses past CONFIG_HTTP_BENCH_TOLERANCE_PCT.
+extern "C" void app_main() {
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(ret);
+
+    DeviceConfig config = ConfigManager::getInstance().getConfig();
+
+    // Subscribed to config changes but not started: the STA routes would
+    // otherwise kick off a simulated connect per request and time the radio.
+    // The scan routes are timed on their answers for a radio that is off.
+    static WiFiManager wifi(config.network);
+
+    DS18B20SensorManager::init(GPIO_NUM_4);
+
+    static HttpServer http_server(&wifi);
+    http_server.start();
+
+    bool ok = runBenchmark();
+    http_server.stop();
+    exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
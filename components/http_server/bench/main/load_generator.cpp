@@ -0,0 +1,273 @@
+#include "load_generator.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+constexpr int IO_TIMEOUT_MS = 5000;
+constexpr size_t RECV_BUFFER_SIZE = 4096;
+
+static uint64_t nowUs() {
+    auto since_epoch = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::microseconds>(since_epoch).count();
+}
+
+// === ResponseReader ===
+
+void ResponseReader::reset() {
+    state_ = State::Head;
+    head_len_ = 0;
+    remaining_ = 0;
+    last_chunk_ = false;
+    status_ = 0;
+    closes_ = false;
+}
+
+bool ResponseReader::parseHead() {
+    head_[head_len_] = '\0';
+    if (sscanf(head_, "HTTP/1.%*d %d", &status_) != 1) return false;
+
+    bool chunked = false;
+    size_t content_len = 0;
+    for (char* line = strstr(head_, "\r\n"); line; line = strstr(line, "\r\n")) {
+        line += 2;
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            content_len = strtoul(line + 15, nullptr, 10);
+        } else if (strncasecmp(line, "Transfer-Encoding: chunked", 26) == 0) {
+            chunked = true;
+        } else if (strncasecmp(line, "Connection: close", 17) == 0) {
+            closes_ = true;
+        }
+    }
+
+    remaining_ = content_len;
+    if (chunked) {
+        state_ = State::ChunkSize;
+    } else {
+        state_ = content_len ? State::Body : State::Done;
+    }
+    return true;
+}
+
+int ResponseReader::feed(const char* data, size_t len) {
+    size_t used = 0;
+    while (used < len && state_ != State::Done) {
+        switch (state_) {
+            case State::Head:
+            case State::ChunkSize:
+                // Both end at a CRLF; the head at an empty line
+                if (head_len_ >= HEAD_MAX_LEN - 1) return -1;
+                head_[head_len_++] = data[used++];
+                if (head_len_ < 2 || memcmp(head_ + head_len_ - 2, "\r\n", 2) != 0) break;
+
+                if (state_ == State::Head) {
+                    if (head_len_ < 4 || memcmp(head_ + head_len_ - 4, "\r\n\r\n", 4) != 0) break;
+                    if (!parseHead()) return -1;
+                } else {
+                    head_[head_len_] = '\0';
+                    char* end = nullptr;
+                    remaining_ = strtoul(head_, &end, 16);
+                    if (end == head_) return -1;
+                    last_chunk_ = remaining_ == 0;
+                    remaining_ += 2;  // Trailing CRLF
+                    state_ = State::ChunkData;
+                }
+                head_len_ = 0;
+                break;
+
+            case State::Body:
+            case State::ChunkData: {
+                size_t n = len - used < remaining_ ? len - used : remaining_;
+                used += n;
+                remaining_ -= n;
+                if (remaining_ > 0) break;
+
+                if (state_ == State::Body || last_chunk_) {
+                    state_ = State::Done;
+                } else {
+                    state_ = State::ChunkSize;
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+    return static_cast<int>(used);
+}
+
+// === LoadGenerator ===
+
+bool LoadGenerator::connect(Connection& conn) {
+    conn.fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (conn.fd < 0) {
+        error_ = "socket() failed";
+        return false;
+    }
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port_);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(conn.fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        error_ = "Could not connect to the server";
+        close(conn.fd);
+        conn.fd = -1;
+        return false;
+    }
+
+    int one = 1;
+    setsockopt(conn.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fcntl(conn.fd, F_SETFL, fcntl(conn.fd, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+// Connections stay open from one call to the next
+bool LoadGenerator::exchange(const std::vector<std::string>& requests, size_t count,
+                             Result* result) {
+    char buf[RECV_BUFFER_SIZE];
+    size_t next = 0;
+    size_t completed = 0;
+
+    auto issue = [&](Connection& conn) {
+        if (conn.fd < 0 && !connect(conn)) return false;
+        conn.request = next++ % requests.size();
+        conn.sent = 0;
+        conn.busy = true;
+        conn.reader.reset();
+        conn.start_us = nowUs();
+        return true;
+    };
+
+    for (Connection& conn : conns_) {
+        if (next < count && !issue(conn)) return false;
+    }
+
+    bool ok = true;
+    while (ok && completed < count) {
+        for (size_t i = 0; i < conns_.size(); i++) {
+            const Connection& conn = conns_[i];
+            bool sending = conn.busy && conn.sent < requests[conn.request].size();
+            fds_[i].fd = conn.busy ? conn.fd : -1;
+            fds_[i].events = POLLIN | (sending ? POLLOUT : 0);
+        }
+
+        int ready = poll(fds_.data(), fds_.size(), IO_TIMEOUT_MS);
+        if (ready <= 0) {
+            error_ = ready == 0 ? "Timed out waiting for a response" : "poll() failed";
+            ok = false;
+            break;
+        }
+
+        for (size_t i = 0; ok && i < conns_.size(); i++) {
+            Connection& conn = conns_[i];
+            if (!conn.busy || fds_[i].revents == 0) continue;
+
+            const std::string& request = requests[conn.request];
+            if ((fds_[i].revents & POLLOUT) && conn.sent < request.size()) {
+                ssize_t n = send(conn.fd, request.data() + conn.sent, request.size() - conn.sent,
+                                 MSG_NOSIGNAL);
+                if (n > 0) conn.sent += n;
+            }
+            if (!(fds_[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+            ssize_t n = recv(conn.fd, buf, sizeof(buf), 0);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) continue;
+            if (n <= 0) {
+                error_ = "Server closed the connection mid-response";
+                ok = false;
+                break;
+            }
+
+            int used = conn.reader.feed(buf, n);
+            if (used < 0) {
+                error_ = "Malformed response";
+                ok = false;
+                break;
+            }
+            if (!conn.reader.done()) continue;
+            if (used < n) {  // Only one request is ever in flight
+                error_ = "Unexpected bytes after a response";
+                ok = false;
+                break;
+            }
+
+            if (result) {
+                result->samples.push_back({static_cast<uint16_t>(conn.request),
+                                           static_cast<uint16_t>(conn.reader.status()),
+                                           static_cast<uint32_t>(nowUs() - conn.start_us)});
+            }
+            completed++;
+            conn.busy = false;
+
+            if (conn.reader.closes()) {
+                close(conn.fd);
+                conn.fd = -1;
+            }
+            if (next < count && !issue(conn)) ok = false;
+        }
+    }
+
+    return ok;
+}
+
+bool LoadGenerator::run(const std::vector<std::string>& requests, size_t measured,
+                        Result& result) {
+    error_ = nullptr;
+    if (requests.empty() || connections_ == 0) {
+        error_ = "Nothing to send";
+        return false;
+    }
+    result.samples.clear();
+    result.samples.reserve(measured);
+    conns_.assign(connections_, Connection());
+    fds_.assign(connections_, pollfd());
+
+    std::atomic<bool> finished{false};
+    bool ok = false;
+    auto client = [&] {
+        // Warm-up fills response caches and settles the config the POST routes write
+        ok = exchange(requests, requests.size() * connections_, nullptr);
+        if (ok) {
+            AllocCounter::resetPeak();
+            result.start = AllocCounter::read();
+            uint64_t start_us = nowUs();
+            ok = exchange(requests, measured, &result);
+            result.elapsed_us = nowUs() - start_us;
+            result.end = AllocCounter::read();
+        }
+        finished = true;
+    };
+
+    // The FreeRTOS POSIX port schedules with signals; keep them off this thread
+    sigset_t all, previous;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &previous);
+    std::thread thread(client);
+    pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+
+    while (!finished) vTaskDelay(pdMS_TO_TICKS(10));
+    thread.join();
+
+    for (Connection& conn : conns_) {
+        if (conn.fd >= 0) close(conn.fd);
+    }
+    return ok;
+}
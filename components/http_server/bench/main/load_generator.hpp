@@ -0,0 +1,100 @@
+#pragma once
+
+#include <poll.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "alloc_counter.hpp"
+
+/**
+ * @brief Incremental HTTP/1.1 response parser that counts body bytes without
+ *        storing them, so a response of any size costs no memory.
+ */
+class ResponseReader {
+   public:
+    void reset();
+
+    /**
+     * @brief Consume bytes up to the end of the current response.
+     * @return Bytes consumed, or -1 if the response is malformed
+     */
+    int feed(const char* data, size_t len);
+
+    bool done() const { return state_ == State::Done; }
+    int status() const { return status_; }
+    bool closes() const { return closes_; }  ///< Server sent Connection: close
+
+   private:
+    enum class State { Head, Body, ChunkSize, ChunkData, Done };
+
+    static constexpr size_t HEAD_MAX_LEN = 1024;
+
+    State state_ = State::Head;
+    char head_[HEAD_MAX_LEN];
+    size_t head_len_ = 0;
+    size_t remaining_ = 0;  ///< Body or chunk bytes still due, chunk CRLF included
+    bool last_chunk_ = false;
+    int status_ = 0;
+    bool closes_ = false;
+
+    bool parseHead();
+};
+
+/**
+ * @brief Closed-loop HTTP load: each connection keeps one request in flight and
+ *        sends the next as soon as the previous response is complete.
+ *
+ * The client runs on a plain thread with every signal blocked, outside the
+ * FreeRTOS scheduler, so the server tasks keep the simulated CPU to themselves.
+ * All buffers are set up before the measured phase; the client itself does not
+ * allocate while it runs.
+ */
+class LoadGenerator {
+   public:
+    struct Sample {
+        uint16_t request;  ///< Index into the request list
+        uint16_t status;
+        uint32_t latency_us;
+    };
+
+    struct Result {
+        std::vector<Sample> samples;
+        uint64_t elapsed_us;        ///< Wall time of the measured phase
+        AllocCounter::Stats start;  ///< Heap counters as the measured phase began
+        AllocCounter::Stats end;
+    };
+
+    LoadGenerator(uint16_t port, size_t connections) : port_(port), connections_(connections) {}
+
+    /**
+     * @brief Send every request once per connection as a warm-up, then
+     *        `measured` requests cycling through the list.
+     * @param requests Complete request messages, head and body
+     * @return false if a connection fails or a response is malformed; see error()
+     */
+    bool run(const std::vector<std::string>& requests, size_t measured, Result& result);
+
+    const char* error() const { return error_; }
+
+   private:
+    struct Connection {
+        int fd = -1;
+        size_t request = 0;
+        size_t sent = 0;
+        uint64_t start_us = 0;
+        bool busy = false;
+        ResponseReader reader;
+    };
+
+    uint16_t port_;
+    size_t connections_;
+    const char* error_ = nullptr;
+    std::vector<Connection> conns_;
+    std::vector<pollfd> fds_;
+
+    bool connect(Connection& conn);
+    bool exchange(const std::vector<std::string>& requests, size_t count, Result* result);
+};
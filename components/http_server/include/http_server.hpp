@@ -2,35 +2,105 @@
 
 #include "config_manager.hpp"
 #include "esp_http_server.h"
+#include "esp_timer.h"
+#include "metrics.hpp"
+#include "request_arena.hpp"
+#include "response_cache.hpp"
+#include "sensor_event_stream.hpp"
+#include "websocket_channel.hpp"
+#include "wifi_manager.hpp"
 
 class HttpServer {
    public:
-    explicit HttpServer(const DeviceInfo& info);
+    /**
+     * @param wifi Serves the scan endpoints; without one they answer 503
+     */
+    explicit HttpServer(WiFiManager* wifi = nullptr) : wifi_manager(wifi) {}
 
     void start();
     void stop();
 
+    /**
+     * @brief One URI registration; the whole table is built at compile time.
+     */
+    struct Route {
+        const char* uri;
+        httpd_method_t method;
+        esp_err_t (*handler)(httpd_req_t* req);
+        bool websocket = false;
+    };
+
+    // Public so tools such as the load benchmark can cover every endpoint
+    static const Route ROUTES[];
+    static const size_t ROUTE_COUNT;
+    static constexpr size_t MAX_ROUTES = 16;
+
    private:
+    /**
+     * @brief What a registered route's user_ctx points at.
+     */
+    struct RouteContext {
+        HttpServer* server;
+        MetricHistogram* latency;  ///< Handler time, exported as http_request_duration_seconds
+    };
+
     httpd_handle_t server_handle = nullptr;
-    const DeviceInfo& device_info;
+    RouteContext route_contexts[MAX_ROUTES] = {};
+    WiFiManager* wifi_manager;
+
+    // One scratch arena per open socket, bound to the session on first use
+    RequestArenaPool arena_pool;
+
+    // Rendered bodies of config-backed GET endpoints
+    ResponseCache info_cache;
+    ResponseCache network_status_cache;
+
+    SensorEventStream sensor_stream;
+#if CONFIG_HTTP_SERVER_WEBSOCKET
+    WebSocketChannel ws_channel;
+#endif
 
     void registerEndpoints();
 
+    /**
+     * @brief The session's arena for a handler's buffers; nullptr if none is left.
+     */
+    RequestArena* requestArena(httpd_req_t* req);
+
+    /**
+     * @brief Rewind the session's arena once the response is complete.
+     */
+    static void endRequest(httpd_req_t* req);
+
     // Handlers
-    static esp_err_t infoHandler(httpd_req_t* req);
-    static esp_err_t patchDeviceInfoHandler(httpd_req_t* req);
-    static esp_err_t postApConfigHandler(httpd_req_t* req);
-    static esp_err_t staConnectHandler(httpd_req_t* req);
-    static esp_err_t staDisconnectHandler(httpd_req_t* req);
-    static esp_err_t networkStatusHandler(httpd_req_t* req);
-    static esp_err_t rootHandler(httpd_req_t* req);
-
-    // Wrappers
-    static esp_err_t infoHandlerWrapper(httpd_req_t* req);
-    static esp_err_t patchDeviceInfoHandlerWrapper(httpd_req_t* req);
-    static esp_err_t postApConfigHandlerWrapper(httpd_req_t* req);
-    static esp_err_t staConnectHandlerWrapper(httpd_req_t* req);
-    static esp_err_t staDisconnectHandlerWrapper(httpd_req_t* req);
-    static esp_err_t networkStatusHandlerWrapper(httpd_req_t* req);
-    static esp_err_t rootHandlerWrapper(httpd_req_t* req);
+    esp_err_t rootHandler(httpd_req_t* req);
+    esp_err_t faviconHandler(httpd_req_t* req);
+    esp_err_t infoHandler(httpd_req_t* req);
+    esp_err_t patchDeviceInfoHandler(httpd_req_t* req);
+    esp_err_t postApConfigHandler(httpd_req_t* req);
+    esp_err_t staConnectHandler(httpd_req_t* req);
+    esp_err_t staDisconnectHandler(httpd_req_t* req);
+    esp_err_t networkStatusHandler(httpd_req_t* req);
+    esp_err_t startScanHandler(httpd_req_t* req);
+    esp_err_t scanResultsHandler(httpd_req_t* req);
+    esp_err_t historyHandler(httpd_req_t* req);
+    esp_err_t sensorStreamHandler(httpd_req_t* req);
+    esp_err_t websocketHandler(httpd_req_t* req);
+    esp_err_t metricsHandler(httpd_req_t* req);
+
+    using Handler = esp_err_t (HttpServer::*)(httpd_req_t* req);
+
+    /**
+     * @brief Trampoline from the C callback to a member handler, timing it and
+     *        releasing its arena memory; the route's RouteContext travels in user_ctx.
+     */
+    template <Handler H>
+    static esp_err_t dispatch(httpd_req_t* req) {
+        auto* ctx = static_cast<RouteContext*>(req->user_ctx);
+        int64_t start_us = esp_timer_get_time();
+        esp_err_t err = (ctx->server->*H)(req);
+        ctx->latency->observe(static_cast<uint32_t>(esp_timer_get_time() - start_us));
+        endRequest(req);
+        return err;
+    }
 };
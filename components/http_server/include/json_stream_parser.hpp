@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#define JSON_PARSER_MAX_KEY_LEN 32
+#define JSON_PARSER_MAX_VALUE_LEN 96
+#define JSON_PARSER_MAX_DEPTH 16
+
+/**
+ * @brief Kind of a top-level member value reported by JsonStreamParser.
+ */
+enum class JsonValueType : uint8_t {
+    String,
+    Number,
+    Bool,
+    Null,
+    Nested,  ///< Object or array; skipped, text is empty
+};
+
+/**
+ * @brief A complete top-level member value.
+ */
+struct JsonValue {
+    JsonValueType type;
+    const char* text;  ///< Unescaped string contents, or the literal as written
+    size_t len;        ///< Length of text
+    bool truncated;    ///< Value did not fit in JSON_PARSER_MAX_VALUE_LEN; text is partial
+};
+
+/**
+ * @brief Receives members of the top-level object as soon as each value ends.
+ */
+class JsonFieldListener {
+   public:
+    virtual ~JsonFieldListener() = default;
+
+    /**
+     * @brief Called once per member, in document order.
+     * @return false to abort parsing
+     */
+    virtual bool onField(const char* key, const JsonValue& value) = 0;
+};
+
+/**
+ * @brief Incremental, allocation-free parser for a single JSON object.
+ *
+ * Input may be fed in arbitrary pieces (e.g. straight from httpd_req_recv);
+ * state carries across calls, so tokens split between TCP segments are
+ * handled. Memory use is fixed by the key/value buffer sizes regardless of
+ * body length. Nested objects and arrays are validated for balance and
+ * skipped.
+ */
+class JsonStreamParser {
+   public:
+    explicit JsonStreamParser(JsonFieldListener& listener);
+
+    /**
+     * @brief Consume the next piece of input.
+     * @return false once the input is invalid or the listener aborted
+     */
+    bool feed(const char* data, size_t len);
+
+    /**
+     * @brief Signal end of input.
+     * @return true if exactly one complete object was parsed
+     */
+    bool finish();
+
+    bool failed() const;
+
+    /**
+     * @brief Short description of the first error, or nullptr.
+     */
+    const char* error() const;
+
+   private:
+    enum class State : uint8_t {
+        Start,
+        KeyOrEnd,
+        Key,
+        Colon,
+        Value,
+        String,
+        Literal,
+        Skip,
+        CommaOrEnd,
+        Done,
+        Error,
+    };
+
+    enum class StringStep : uint8_t { Continue, Closed, Invalid };
+
+    JsonFieldListener& listener_;
+    State state_ = State::Start;
+    const char* error_ = nullptr;
+    bool after_comma_ = false;
+
+    char key_[JSON_PARSER_MAX_KEY_LEN + 1];
+    size_t key_len_ = 0;
+    bool key_truncated_ = false;
+
+    char value_[JSON_PARSER_MAX_VALUE_LEN + 1];
+    size_t value_len_ = 0;
+    bool value_truncated_ = false;
+
+    // String escape decoding, shared by keys and values
+    bool escape_ = false;
+    uint8_t unicode_left_ = 0;
+    uint16_t unicode_value_ = 0;
+
+    // Skipping nested containers
+    uint8_t skip_depth_ = 0;
+    bool skip_in_string_ = false;
+    bool skip_escape_ = false;
+
+    bool step(char c);
+    StringStep stringChar(char c, char* buf, size_t cap, size_t& len, bool& truncated);
+    bool emit(JsonValueType type);
+    bool emitLiteral();
+    bool fail(const char* error);
+
+    static void append(char c, char* buf, size_t cap, size_t& len, bool& truncated);
+    static bool isWhitespace(char c);
+};
+
+/**
+ * @brief How a bound field accepts its value.
+ */
+enum class JsonFieldKind : uint8_t {
+    String,          ///< JSON string copied into a char array
+    NullableString,  ///< As String, and null clears the field
+    Bool,            ///< JSON boolean; other types are ignored
+};
+
+/**
+ * @brief Maps one JSON key onto a struct field.
+ */
+struct JsonFieldBinding {
+    const char* key;
+    JsonFieldKind kind;
+    void* target;     ///< char[capacity] or bool
+    size_t capacity;  ///< Size of the char array including the terminator
+};
+
+/**
+ * @brief Listener that writes known keys straight into bound fields.
+ *
+ * Unknown keys are ignored. A known key with a value of the wrong type or one
+ * that does not fit aborts parsing and is reported by invalidKey().
+ */
+class JsonFieldBinder : public JsonFieldListener {
+   public:
+    JsonFieldBinder(const JsonFieldBinding* bindings, size_t count);
+
+    bool onField(const char* key, const JsonValue& value) override;
+
+    /**
+     * @brief Whether the binding at index received a value.
+     */
+    bool wasSet(size_t index) const;
+
+    /**
+     * @brief Key whose value was rejected, or nullptr.
+     */
+    const char* invalidKey() const;
+
+   private:
+    const JsonFieldBinding* bindings_;
+    size_t count_;
+    uint32_t set_mask_ = 0;
+    const char* invalid_key_ = nullptr;
+};
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @brief Allocation-free JSON serializer writing into a caller-provided buffer.
+ *
+ * Commas and nesting are tracked internally. If the output does not fit, the
+ * writer latches an overflow flag, stops writing and ok() returns false; the
+ * buffer always stays NUL-terminated.
+ */
+class JsonWriter {
+   public:
+    JsonWriter(char* buf, size_t cap) : buf_(buf), cap_(cap) {
+        reset();
+    }
+
+    /**
+     * @brief Discard all output and start over with the same buffer.
+     */
+    void reset() {
+        len_ = 0;
+        depth_ = 0;
+        need_comma_ = 0;
+        after_key_ = false;
+        overflow_ = cap_ == 0;
+        if (cap_ > 0) buf_[0] = '\0';
+    }
+
+    // === Structure ===
+
+    JsonWriter& beginObject() {
+        return open('{');
+    }
+
+    JsonWriter& endObject() {
+        return close('}');
+    }
+
+    JsonWriter& beginArray() {
+        return open('[');
+    }
+
+    JsonWriter& endArray() {
+        return close(']');
+    }
+
+    JsonWriter& key(const char* name) {
+        separator();
+        writeString(name);
+        put(':');
+        after_key_ = true;
+        return *this;
+    }
+
+    // === Values ===
+
+    JsonWriter& value(const char* str) {
+        if (!str) return null();
+        separator();
+        writeString(str);
+        return *this;
+    }
+
+    JsonWriter& value(bool b) {
+        separator();
+        return raw(b ? "true" : "false");
+    }
+
+    template <typename T, std::enable_if_t<std::is_integral<T>::value, int> = 0>
+    JsonWriter& value(T n) {
+        separator();
+        if (std::is_signed<T>::value) return format("%lld", static_cast<long long>(n));
+        return format("%llu", static_cast<unsigned long long>(n));
+    }
+
+    JsonWriter& value(double d) {
+        separator();
+        if (!std::isfinite(d)) return raw("null");  // Same as cJSON
+        return format("%.7g", d);
+    }
+
+    JsonWriter& null() {
+        separator();
+        return raw("null");
+    }
+
+    /**
+     * @brief Shorthand for key(name).value(v).
+     */
+    template <typename T>
+    JsonWriter& field(const char* name, T v) {
+        return key(name).value(v);
+    }
+
+    // === Result ===
+
+    bool ok() const {
+        return !overflow_ && depth_ == 0;
+    }
+
+    bool overflowed() const {
+        return overflow_;
+    }
+
+    const char* c_str() const {
+        return buf_;
+    }
+
+    size_t length() const {
+        return len_;
+    }
+
+    size_t capacity() const {
+        return cap_;
+    }
+
+   private:
+    static constexpr uint8_t MAX_DEPTH = 32;
+
+    char* buf_;
+    size_t cap_;
+    size_t len_;
+    uint8_t depth_;
+    uint32_t need_comma_;  ///< Bit n set once container at depth n has an element
+    bool after_key_;
+    bool overflow_;
+
+    void separator() {
+        if (after_key_) {
+            after_key_ = false;
+            return;
+        }
+        if (depth_ == 0) return;
+        uint32_t bit = 1u << (depth_ - 1);
+        if (need_comma_ & bit) put(',');
+        need_comma_ |= bit;
+    }
+
+    JsonWriter& open(char c) {
+        separator();
+        put(c);
+        if (depth_ >= MAX_DEPTH) {
+            overflow_ = true;
+            return *this;
+        }
+        depth_++;
+        need_comma_ &= ~(1u << (depth_ - 1));
+        return *this;
+    }
+
+    JsonWriter& close(char c) {
+        if (depth_ > 0) depth_--;
+        put(c);
+        return *this;
+    }
+
+    void put(char c) {
+        if (overflow_) return;
+        if (len_ + 1 >= cap_) {
+            overflow_ = true;
+            return;
+        }
+        buf_[len_++] = c;
+        buf_[len_] = '\0';
+    }
+
+    JsonWriter& raw(const char* s) {
+        while (*s) put(*s++);
+        return *this;
+    }
+
+    template <typename... Args>
+    JsonWriter& format(const char* fmt, Args... args) {
+        if (overflow_) return *this;
+        int n = snprintf(buf_ + len_, cap_ - len_, fmt, args...);
+        if (n < 0 || static_cast<size_t>(n) >= cap_ - len_) {
+            overflow_ = true;
+            buf_[len_] = '\0';
+            return *this;
+        }
+        len_ += n;
+        return *this;
+    }
+
+    void writeString(const char* s) {
+        static const char HEX[] = "0123456789abcdef";
+
+        put('"');
+        for (; *s && !overflow_; s++) {
+            unsigned char c = static_cast<unsigned char>(*s);
+            switch (c) {
+                case '"':
+                    raw("\\\"");
+                    break;
+                case '\\':
+                    raw("\\\\");
+                    break;
+                case '\n':
+                    raw("\\n");
+                    break;
+                case '\r':
+                    raw("\\r");
+                    break;
+                case '\t':
+                    raw("\\t");
+                    break;
+                default:
+                    if (c < 0x20) {
+                        raw("\\u00");
+                        put(HEX[c >> 4]);
+                        put(HEX[c & 0x0F]);
+                    } else {
+                        put(static_cast<char>(c));
+                    }
+                    break;
+            }
+        }
+        put('"');
+    }
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class RequestArenaPool;
+
+/**
+ * @brief Bump allocator for the scratch memory of one request.
+ *
+ * alloc() only advances an offset into a fixed block and reset() rewinds it,
+ * so whatever a handler took is given back in O(1) once the response is sent
+ * and the heap never sees the request's allocations. Not thread-safe: httpd
+ * runs every handler on its single server task.
+ */
+class RequestArena {
+   public:
+    /**
+     * @return size bytes aligned to align, or nullptr when they do not fit
+     */
+    void* alloc(size_t size, size_t align = alignof(max_align_t));
+
+    /**
+     * @brief Uninitialized room for count objects of T.
+     */
+    template <typename T>
+    T* alloc(size_t count) {
+        if (count > capacity_ / sizeof(T)) return nullptr;
+        return static_cast<T*>(alloc(count * sizeof(T), alignof(T)));
+    }
+
+    void reset() {
+        used_ = 0;
+    }
+
+    size_t used() const {
+        return used_;
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    /**
+     * @brief Most this arena has had in use at once.
+     */
+    size_t highWater() const {
+        return high_water_;
+    }
+
+   private:
+    friend class RequestArenaPool;
+
+    uint8_t* base_ = nullptr;
+    size_t capacity_ = 0;
+    size_t used_ = 0;
+    size_t high_water_ = 0;
+    RequestArena* next_free_ = nullptr;
+    RequestArenaPool* pool_ = nullptr;
+};
+
+/**
+ * @brief Fixed set of equally sized arenas carved from one heap block.
+ *
+ * The block is allocated once by init(), so however long the server runs, its
+ * requests never allocate or fragment the heap. acquire() and release() pop
+ * and push a free list. Not thread-safe, like RequestArena.
+ */
+class RequestArenaPool {
+   public:
+    RequestArenaPool() = default;
+    ~RequestArenaPool();
+    RequestArenaPool(const RequestArenaPool&) = delete;
+    RequestArenaPool& operator=(const RequestArenaPool&) = delete;
+
+    bool init(size_t count, size_t arena_size);
+    void deinit();
+
+    /**
+     * @return A reset arena, or nullptr when all are taken
+     */
+    RequestArena* acquire();
+    void release(RequestArena* arena);
+
+    /**
+     * @brief httpd_free_ctx_fn_t for an arena stored as a session context.
+     */
+    static void releaseContext(void* arena);
+
+    size_t count() const {
+        return count_;
+    }
+
+    size_t arenaSize() const {
+        return arena_size_;
+    }
+
+    size_t inUse() const {
+        return in_use_;
+    }
+
+    /**
+     * @brief Most arenas taken at once since init().
+     */
+    size_t peakInUse() const {
+        return peak_in_use_;
+    }
+
+   private:
+    RequestArena* arenas_ = nullptr;
+    uint8_t* storage_ = nullptr;
+    RequestArena* free_ = nullptr;
+    size_t count_ = 0;
+    size_t arena_size_ = 0;
+    size_t in_use_ = 0;
+    size_t peak_in_use_ = 0;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+/**
+ * @brief Last serialized body of a read-mostly endpoint plus its strong ETag.
+ *
+ * The body is rendered in place into buffer() and stays valid for exactly one
+ * ConfigManager generation. The ETag is a hash of the body, so it stays correct
+ * across reboots even though the generation restarts. Not thread-safe: httpd
+ * runs every handler on its single server task.
+ */
+class ResponseCache {
+   public:
+    static constexpr size_t CAPACITY = 512;
+
+    /**
+     * @brief Whether the cached body was rendered from this generation.
+     */
+    bool fresh(uint32_t generation) const {
+        return valid_ && generation_ == generation;
+    }
+
+    /**
+     * @brief Buffer to render a new body into; the cache is invalid until commit().
+     */
+    char* buffer() {
+        valid_ = false;
+        return body_;
+    }
+
+    /**
+     * @brief Mark the first len bytes of buffer() as the body for generation.
+     */
+    void commit(uint32_t generation, size_t len) {
+        if (len >= CAPACITY) return;
+        body_[len] = '\0';
+        len_ = len;
+        generation_ = generation;
+
+        // FNV-1a over the body
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < len; i++) {
+            hash = (hash ^ static_cast<uint8_t>(body_[i])) * 16777619u;
+        }
+        snprintf(etag_, sizeof(etag_), "\"%08lx\"", static_cast<unsigned long>(hash));
+        valid_ = true;
+    }
+
+    /**
+     * @brief Whether an If-None-Match header value names the cached body.
+     *
+     * Accepts a single tag, a list of tags (weak or strong, per RFC 9110's weak
+     * comparison for If-None-Match) or "*".
+     */
+    bool matches(const char* if_none_match) const {
+        if (!valid_) return false;
+        return strstr(if_none_match, etag_) != nullptr || strcmp(if_none_match, "*") == 0;
+    }
+
+    const char* body() const {
+        return body_;
+    }
+
+    size_t length() const {
+        return len_;
+    }
+
+    const char* etag() const {
+        return etag_;
+    }
+
+   private:
+    char body_[CAPACITY];
+    size_t len_ = 0;
+    char etag_[11] = {};  ///< "xxxxxxxx" including the quotes
+    uint32_t generation_ = 0;
+    bool valid_ = false;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "esp_http_server.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include "sensor_notifier.hpp"
+
+/**
+ * @brief Server-Sent Events fan-out of live sensor samples.
+ *
+ * accept() detaches the request with httpd_req_async_handler_begin() and hands
+ * it to a single stream task, so the httpd task is free again immediately and
+ * each client costs one socket instead of one connection per poll. The stream
+ * task subscribes every client to the sensor notifier. Its writes to a client's
+ * socket never block: whatever the socket does not take stays in that client's
+ * buffer, and further samples wait in its notifier queue. A client that cannot
+ * keep up therefore loses only its own oldest samples, without holding back
+ * the other streams or the sensor task.
+ */
+class SensorEventStream {
+   public:
+    /**
+     * @brief Create the stream task. Call before the server starts taking requests.
+     */
+    esp_err_t start();
+
+    /**
+     * @brief Close every stream and end the task. Call before httpd_stop().
+     */
+    void stop();
+
+    /**
+     * @brief Take over a GET request as a subscriber; runs on the httpd task.
+     */
+    esp_err_t accept(httpd_req_t* req);
+
+   private:
+    static constexpr size_t SEND_BUFFER_SIZE = 512;
+
+    struct Subscriber {
+        httpd_req_t* req;
+        int fd;
+        QueueHandle_t events;
+        TickType_t last_send;    ///< Last time the socket took any bytes
+        uint8_t replay;          ///< Next sensor whose current sample is still owed
+        size_t out_len;          ///< Bytes in out
+        size_t out_sent;         ///< Bytes of out already written to the socket
+        char out[SEND_BUFFER_SIZE];
+    };
+
+    std::atomic<TaskHandle_t> task_{nullptr};
+    QueueHandle_t pending_ = nullptr;  ///< Detached requests waiting for the task
+    Subscriber subscribers_[CONFIG_HTTP_SERVER_SSE_MAX_SUBSCRIBERS] = {};
+    std::atomic<size_t> reserved_{0};  ///< Slots claimed by accept(), including pending
+    std::atomic<bool> running_{false};
+
+    static void streamTask(void* arg);
+    void run();
+    void adopt(httpd_req_t* req);
+    void close(Subscriber& subscriber);
+    void release(httpd_req_t* req);
+    bool fill(Subscriber& subscriber, TickType_t now);
+    bool appendEvent(Subscriber& subscriber, const SensorEvent& event);
+    bool append(Subscriber& subscriber, const char* data, size_t len);
+    bool flush(Subscriber& subscriber, TickType_t now);
+};
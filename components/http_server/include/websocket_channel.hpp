@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "esp_http_server.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+#if CONFIG_HTTP_SERVER_WEBSOCKET
+
+#define WS_MAX_CLIENTS 2
+
+/**
+ * @brief /ws endpoint: binary sample frames out, config commands in.
+ *
+ * Frames follow ws_protocol.hpp. A small task waits on the sensor notifier and
+ * queues a broadcast onto the httpd task with httpd_queue_work(), so every
+ * socket write and the client list stay on the httpd task. Samples that pile
+ * up between broadcasts are batched into one frame.
+ *
+ * Everything sent to a client goes through its own buffer and non-blocking
+ * socket writes, so a client that stops reading never stalls the httpd task.
+ * While its buffer is full it misses samples. If its socket takes nothing for
+ * a few seconds, the client is dropped.
+ */
+class WebSocketChannel {
+   public:
+    WebSocketChannel();
+
+    /**
+     * @brief Start the broadcast task. Call after httpd_start().
+     */
+    esp_err_t start(httpd_handle_t server);
+
+    /**
+     * @brief Stop broadcasting and release the notifier slot. Call before httpd_stop().
+     */
+    void stop();
+
+    /**
+     * @brief URI handler for both the handshake and incoming frames.
+     */
+    esp_err_t handle(httpd_req_t* req);
+
+   private:
+    static constexpr size_t SEND_BUFFER_SIZE = 512;
+
+    struct Client {
+        int fd;                ///< -1 when the slot is free
+        TickType_t last_send;  ///< Last time the socket took any bytes
+        size_t out_len;        ///< Bytes in out
+        size_t out_sent;       ///< Bytes of out already written to the socket
+        uint8_t out[SEND_BUFFER_SIZE];
+    };
+
+    httpd_handle_t server_ = nullptr;
+    Client clients_[WS_MAX_CLIENTS];              ///< httpd task only
+    std::atomic<QueueHandle_t> events_{nullptr};  ///< Notifier subscription
+    std::atomic<TaskHandle_t> task_{nullptr};
+    std::atomic<bool> running_{false};
+    std::atomic<bool> broadcast_queued_{false};
+    std::atomic<bool> backlogged_{false};  ///< A client still has unsent bytes
+
+    static void wakeTask(void* arg);
+    static void broadcastWork(void* arg);
+    static void releaseWork(void* arg);
+    void run();
+    void broadcast();
+    Client* addClient(int fd);
+    Client* findClient(int fd);
+    void dropClient(Client& client);
+    bool appendFrame(Client& client, const uint8_t* payload, size_t len);
+    bool flush(Client& client, TickType_t now);
+    esp_err_t handleCommand(Client& client, const uint8_t* data, size_t len);
+    esp_err_t sendFrame(Client& client, const uint8_t* payload, size_t len);
+    esp_err_t sendCurrentSamples(Client& client);
+};
+
+#endif  // CONFIG_HTTP_SERVER_WEBSOCKET
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Wire format of the /ws endpoint, shared by the server and any C++ client or
+// test. Every message is a binary WebSocket frame whose first byte is its
+// WsFrameType; multi-byte fields are little-endian. Nothing here depends on
+// ESP-IDF, so the same encoders and decoders build on the host.
+
+#define WS_FRAME_HEADER_LEN 2
+#define WS_SAMPLE_RECORD_LEN 6
+#define WS_MAX_SAMPLES_PER_FRAME 16
+#define WS_MAX_COMMAND_LEN 128
+
+/**
+ * @brief First byte of every frame.
+ */
+enum class WsFrameType : uint8_t {
+    Samples = 0x01,        ///< Server → client: [type][count] + count × sample record
+    SetDeviceName = 0x10,  ///< Client → server: [type][len][name]
+    SetApConfig = 0x11,    ///< Client → server: [type][flags][ssid_len][ssid][pw_len][password]
+    Ack = 0x80,            ///< Server → client: [type][command type][WsStatus]
+};
+
+/**
+ * @brief Result carried by an Ack frame.
+ */
+enum class WsStatus : uint8_t {
+    Ok = 0,
+    Invalid = 1,      ///< Malformed frame or a value that does not fit
+    Unsupported = 2,  ///< Unknown frame type
+};
+
+// SetApConfig flags
+#define WS_AP_HAS_SSID 0x01
+#define WS_AP_HAS_PASSWORD 0x02
+#define WS_AP_HAS_ENABLED 0x04
+#define WS_AP_ENABLED 0x08
+
+// Sample record flags
+#define WS_SAMPLE_OK 0x01
+
+/**
+ * @brief One sample record: [sensor][flags][centi-°C int16][sequence uint16].
+ */
+struct WsSample {
+    uint8_t sensor;
+    bool ok;
+    float temperature;  ///< °C; 0.01 °C resolution on the wire
+    uint16_t sequence;  ///< Low 16 bits of the sensor's sample sequence; gaps mean drops
+};
+
+/**
+ * @brief Length-prefixed string inside a received frame; not NUL-terminated.
+ */
+struct WsText {
+    const char* data;
+    uint8_t len;
+};
+
+/**
+ * @brief A decoded client command. Text fields point into the frame buffer.
+ */
+struct WsCommand {
+    WsFrameType type;
+    WsText name;       ///< SetDeviceName
+    uint8_t ap_flags;  ///< SetApConfig, WS_AP_* bits
+    WsText ssid;       ///< SetApConfig, valid with WS_AP_HAS_SSID
+    WsText password;   ///< SetApConfig, valid with WS_AP_HAS_PASSWORD
+};
+
+inline void wsPutU16(uint8_t* out, uint16_t v) {
+    out[0] = static_cast<uint8_t>(v);
+    out[1] = static_cast<uint8_t>(v >> 8);
+}
+
+inline uint16_t wsGetU16(const uint8_t* in) {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+/**
+ * @brief Encode up to WS_MAX_SAMPLES_PER_FRAME samples into one Samples frame.
+ * @return Frame length, or 0 if it does not fit in cap
+ */
+inline size_t wsEncodeSamples(const WsSample* samples, size_t count, uint8_t* out, size_t cap) {
+    size_t len = WS_FRAME_HEADER_LEN + count * WS_SAMPLE_RECORD_LEN;
+    if (count > WS_MAX_SAMPLES_PER_FRAME || len > cap) return 0;
+
+    out[0] = static_cast<uint8_t>(WsFrameType::Samples);
+    out[1] = static_cast<uint8_t>(count);
+    uint8_t* rec = out + WS_FRAME_HEADER_LEN;
+    for (size_t i = 0; i < count; i++, rec += WS_SAMPLE_RECORD_LEN) {
+        float centi = std::round(samples[i].temperature * 100.0f);
+        if (!(centi >= INT16_MIN)) centi = INT16_MIN;  // Also catches NaN
+        if (centi > INT16_MAX) centi = INT16_MAX;
+
+        rec[0] = samples[i].sensor;
+        rec[1] = samples[i].ok ? WS_SAMPLE_OK : 0;
+        wsPutU16(rec + 2, static_cast<uint16_t>(static_cast<int16_t>(centi)));
+        wsPutU16(rec + 4, samples[i].sequence);
+    }
+    return len;
+}
+
+/**
+ * @brief Decode a Samples frame.
+ * @param count Set to the number of records decoded
+ * @return false if the frame is not a well-formed Samples frame or max is too small
+ */
+inline bool wsDecodeSamples(const uint8_t* data, size_t len, WsSample* out, size_t max,
+                            size_t& count) {
+    if (len < WS_FRAME_HEADER_LEN || data[0] != static_cast<uint8_t>(WsFrameType::Samples)) {
+        return false;
+    }
+    count = data[1];
+    if (count > max || len != WS_FRAME_HEADER_LEN + count * WS_SAMPLE_RECORD_LEN) return false;
+
+    const uint8_t* rec = data + WS_FRAME_HEADER_LEN;
+    for (size_t i = 0; i < count; i++, rec += WS_SAMPLE_RECORD_LEN) {
+        out[i].sensor = rec[0];
+        out[i].ok = rec[1] & WS_SAMPLE_OK;
+        out[i].temperature = static_cast<int16_t>(wsGetU16(rec + 2)) / 100.0f;
+        out[i].sequence = wsGetU16(rec + 4);
+    }
+    return true;
+}
+
+/**
+ * @brief Encode the Ack for a command.
+ * @return Frame length (3), or 0 if cap is too small
+ */
+inline size_t wsEncodeAck(uint8_t command, WsStatus status, uint8_t* out, size_t cap) {
+    if (cap < 3) return 0;
+    out[0] = static_cast<uint8_t>(WsFrameType::Ack);
+    out[1] = command;
+    out[2] = static_cast<uint8_t>(status);
+    return 3;
+}
+
+inline bool wsDecodeAck(const uint8_t* data, size_t len, uint8_t& command, WsStatus& status) {
+    if (len != 3 || data[0] != static_cast<uint8_t>(WsFrameType::Ack)) return false;
+    command = data[1];
+    status = static_cast<WsStatus>(data[2]);
+    return true;
+}
+
+/**
+ * @brief Encode a SetDeviceName command.
+ * @return Frame length, or 0 if name is longer than 255 bytes or cap is too small
+ */
+inline size_t wsEncodeSetDeviceName(const char* name, uint8_t* out, size_t cap) {
+    size_t name_len = strlen(name);
+    if (name_len > UINT8_MAX || 2 + name_len > cap) return 0;
+
+    out[0] = static_cast<uint8_t>(WsFrameType::SetDeviceName);
+    out[1] = static_cast<uint8_t>(name_len);
+    memcpy(out + 2, name, name_len);
+    return 2 + name_len;
+}
+
+/**
+ * @brief Encode a SetApConfig command; nullptr ssid/password leave them unchanged.
+ * @param enabled -1 leaves ap_enabled unchanged, otherwise 0 or 1
+ * @return Frame length, or 0 if a string is longer than 255 bytes or cap is too small
+ */
+inline size_t wsEncodeSetApConfig(const char* ssid, const char* password, int enabled,
+                                  uint8_t* out, size_t cap) {
+    size_t ssid_len = ssid ? strlen(ssid) : 0;
+    size_t pw_len = password ? strlen(password) : 0;
+    size_t len = 4 + ssid_len + pw_len;
+    if (ssid_len > UINT8_MAX || pw_len > UINT8_MAX || len > cap) return 0;
+
+    uint8_t flags = 0;
+    if (ssid) flags |= WS_AP_HAS_SSID;
+    if (password) flags |= WS_AP_HAS_PASSWORD;
+    if (enabled >= 0) flags |= WS_AP_HAS_ENABLED | (enabled ? WS_AP_ENABLED : 0);
+
+    uint8_t* p = out;
+    *p++ = static_cast<uint8_t>(WsFrameType::SetApConfig);
+    *p++ = flags;
+    *p++ = static_cast<uint8_t>(ssid_len);
+    memcpy(p, ssid ? ssid : "", ssid_len);
+    p += ssid_len;
+    *p++ = static_cast<uint8_t>(pw_len);
+    memcpy(p, password ? password : "", pw_len);
+    return len;
+}
+
+/**
+ * @brief Decode a client command frame.
+ * @return false if the frame is truncated, has trailing bytes or is not a command
+ */
+inline bool wsDecodeCommand(const uint8_t* data, size_t len, WsCommand& cmd) {
+    if (len < 2) return false;
+
+    cmd = {};
+    cmd.type = static_cast<WsFrameType>(data[0]);
+    const uint8_t* end = data + len;
+
+    auto take = [&end](const uint8_t*& p, WsText& text) {
+        if (p >= end || static_cast<size_t>(end - p - 1) < *p) return false;
+        text.len = *p++;
+        text.data = reinterpret_cast<const char*>(p);
+        p += text.len;
+        return true;
+    };
+
+    const uint8_t* p = data + 1;
+    switch (cmd.type) {
+        case WsFrameType::SetDeviceName:
+            return take(p, cmd.name) && p == end;
+        case WsFrameType::SetApConfig:
+            cmd.ap_flags = *p++;
+            return take(p, cmd.ssid) && take(p, cmd.password) && p == end;
+        default:
+            return false;
+    }
+}
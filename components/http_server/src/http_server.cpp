@@ -1,350 +1,723 @@
 #include "http_server.hpp"
 
+#include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-#include "cJSON.h"
 #include "esp_log.h"
+#include "json_stream_parser.hpp"
+#include "json_writer.hpp"
+#include "response_cache.hpp"
 #include "sensor_manager.hpp"
 
 static const char* TAG = "http_server";
 
-HttpServer::HttpServer(const DeviceInfo& info) : device_info(info) {}
+constexpr size_t JSON_RESPONSE_SIZE = 512;
+constexpr size_t HISTORY_CHUNK_SIZE = 512;
+constexpr size_t HISTORY_BATCH_POINTS = 32;
+constexpr size_t QUERY_MAX_LEN = 96;
+constexpr size_t REQUEST_BODY_MAX_LEN = 512;
+constexpr size_t RECV_CHUNK_SIZE = 64;
+constexpr int RECV_TIMEOUT_RETRIES = 3;
+constexpr size_t IF_NONE_MATCH_MAX_LEN = 64;
+constexpr uint32_t SCAN_PAGE_DEFAULT = 10;
+constexpr size_t SCAN_PAGE_MAX = 16;
+constexpr size_t SCAN_ENTRY_JSON_SIZE = 320;  // An SSID of 32 escaped control bytes fits
+// A scrape runs to ~17 KB; a segment-sized chunk keeps it to a dozen sends
+constexpr size_t METRICS_CHUNK_SIZE = 1436;
+static_assert(METRICS_CHUNK_SIZE <= CONFIG_HTTP_SERVER_ARENA_SIZE, "Metrics chunk exceeds arena");
+// What the scan and history handlers take from the arena. Each buffer ends on
+// a boundary the next one accepts, so alloc() adds no padding between them.
+constexpr size_t SCAN_ARENA_BYTES =
+    SCAN_PAGE_MAX * sizeof(WiFiScanEntry) + JSON_RESPONSE_SIZE + SCAN_ENTRY_JSON_SIZE;
+constexpr size_t HISTORY_ARENA_BYTES =
+    HISTORY_CHUNK_SIZE + HISTORY_BATCH_POINTS * sizeof(HistoryPoint);
+static_assert(SCAN_ARENA_BYTES <= CONFIG_HTTP_SERVER_ARENA_SIZE, "Scan page exceeds arena");
+static_assert(HISTORY_ARENA_BYTES <= CONFIG_HTTP_SERVER_ARENA_SIZE, "History batch exceeds arena");
+constexpr size_t ROUTE_LABEL_LEN = 48;
+
+// Handler time per route. Metrics are never unpublished, so these outlive any
+// HttpServer and are published by the first start().
+static MetricHistogram route_latency[HttpServer::MAX_ROUTES];
+static char route_labels[HttpServer::MAX_ROUTES][ROUTE_LABEL_LEN];
+
+static MetricGauge arena_size_bytes("http_arena_size_bytes", "Scratch memory per request");
+static MetricGauge arena_high_water("http_arena_high_water_bytes",
+                                    "Most scratch memory a request has used");
+static MetricGauge arenas_peak("http_arenas_in_use_peak",
+                               "Most sessions holding an arena at once");
+static MetricCounter arena_exhausted("http_arena_exhausted_total",
+                                     "Handler buffers that did not fit in the arena");
+
+/**
+ * @brief Accumulates formatted output in a fixed buffer and ships it with
+ *        httpd_resp_send_chunk whenever the next piece would not fit.
+ */
+class ChunkedResponse {
+   public:
+    ChunkedResponse(httpd_req_t* req, char* buf, size_t cap) : req_(req), buf_(buf), cap_(cap) {}
+
+    bool printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        for (int attempt = 0; attempt < 2; attempt++) {
+            va_list args;
+            va_start(args, fmt);
+            int n = vsnprintf(buf_ + len_, cap_ - len_, fmt, args);
+            va_end(args);
+
+            if (n >= 0 && static_cast<size_t>(n) < cap_ - len_) {
+                len_ += n;
+                return true;
+            }
+            if (!flush()) return false;
+        }
+        return false;  // Single piece larger than the whole buffer
+    }
 
-void HttpServer::registerEndpoints() {
-    // Root
-    httpd_uri_t root_uri = {
-        .uri = "/", .method = HTTP_GET, .handler = rootHandlerWrapper, .user_ctx = (void*)this};
-    esp_err_t err = httpd_register_uri_handler(server_handle, &root_uri);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to register GET /: %s", esp_err_to_name(err));
-    } else {
-        ESP_LOGI(TAG, "Registered GET /");
-    }
-
-    // Favicon (empty)
-    httpd_uri_t favicon_uri = {.uri = "/favicon.ico",
-                               .method = HTTP_GET,
-                               .handler =
-                                   [](httpd_req_t* req) {
-                                       httpd_resp_set_type(req, "image/x-icon");
-                                       return httpd_resp_send(req, NULL, 0);
-                                   },
-                               .user_ctx = nullptr};
-    err = httpd_register_uri_handler(server_handle, &favicon_uri);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to register GET /favicon.ico: %s", esp_err_to_name(err));
-    } else {
-        ESP_LOGI(TAG, "Registered GET /favicon.ico");
+    bool flush() {
+        if (len_ == 0) return err_ == ESP_OK;
+        if (err_ == ESP_OK) err_ = httpd_resp_send_chunk(req_, buf_, len_);
+        len_ = 0;
+        return err_ == ESP_OK;
     }
 
-    // ───────────── DEVICE INFO ─────────────
+    esp_err_t finish() {
+        flush();
+        if (err_ == ESP_OK) err_ = httpd_resp_send_chunk(req_, nullptr, 0);
+        return err_;
+    }
 
-    // GET /api/device/info
-    httpd_uri_t get_device_info_uri = {.uri = "/api/device/info",
-                                       .method = HTTP_GET,
-                                       .handler = infoHandlerWrapper,
-                                       .user_ctx = (void*)this};
-    err = httpd_register_uri_handler(server_handle, &get_device_info_uri);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to register GET /api/device/info: %s", esp_err_to_name(err));
-    } else {
-        ESP_LOGI(TAG, "Registered GET /api/device/info");
+   private:
+    httpd_req_t* req_;
+    char* buf_;
+    size_t cap_;
+    size_t len_ = 0;
+    esp_err_t err_ = ESP_OK;
+};
+
+template <typename T>
+static T* arenaAlloc(RequestArena* arena, size_t count) {
+    T* ptr = arena ? arena->alloc<T>(count) : nullptr;
+    if (!ptr) arena_exhausted.add();
+    return ptr;
+}
+
+static esp_err_t sendArenaExhausted(httpd_req_t* req) {
+    ESP_LOGE(TAG, "Request arena exhausted serving %s", req->uri);
+    return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of request memory");
+}
+
+static esp_err_t sendJson(httpd_req_t* req, const JsonWriter& json) {
+    if (!json.ok()) {
+        ESP_LOGE(TAG, "Response for %s does not fit in %u bytes", req->uri,
+                 (unsigned)json.capacity());
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Response too large");
     }
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, json.c_str(), json.length());
+}
 
-    // PATCH /api/device/info
-    httpd_uri_t patch_device_info_uri = {.uri = "/api/device/info",
-                                         .method = HTTP_PATCH,
-                                         .handler = patchDeviceInfoHandlerWrapper,
-                                         .user_ctx = (void*)this};
-    err = httpd_register_uri_handler(server_handle, &patch_device_info_uri);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to register PATCH /api/device/info: %s", esp_err_to_name(err));
-    } else {
-        ESP_LOGI(TAG, "Registered PATCH /api/device/info");
+static esp_err_t sendStatus(httpd_req_t* req, const char* status) {
+    char buf[JSON_RESPONSE_SIZE];
+    JsonWriter json(buf, sizeof(buf));
+    json.beginObject().field("status", status).endObject();
+    return sendJson(req, json);
+}
+
+// Replies from a cache entry: 304 when If-None-Match already names the cached
+// body, otherwise the body itself. Either way the ETag goes out so clients can
+// revalidate next time.
+static esp_err_t sendCached(httpd_req_t* req, const ResponseCache& cache) {
+    httpd_resp_set_hdr(req, "ETag", cache.etag());
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+
+    char if_none_match[IF_NONE_MATCH_MAX_LEN];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match,
+                                    sizeof(if_none_match)) == ESP_OK &&
+        cache.matches(if_none_match)) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, nullptr, 0);
     }
 
-    // ───────────── NETWORK CONFIG ─────────────
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, cache.body(), cache.length());
+}
 
-    // POST /api/network/ap/set
-    httpd_uri_t post_ap_config_uri = {.uri = "/api/network/ap/set",
-                                      .method = HTTP_POST,
-                                      .handler = postApConfigHandlerWrapper,
-                                      .user_ctx = (void*)this};
-    err = httpd_register_uri_handler(server_handle, &post_ap_config_uri);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to register POST /api/network/ap/set: %s", esp_err_to_name(err));
-    } else {
-        ESP_LOGI(TAG, "Registered POST /api/network/ap/set");
+// Streams the request body through a JsonStreamParser in fixed-size pieces, so
+// memory use does not depend on Content-Length. Returns ESP_ERR_INVALID_SIZE for
+// an empty or oversized body, ESP_ERR_INVALID_ARG for malformed JSON or a rejected
+// field, and ESP_FAIL when the socket fails.
+static esp_err_t receiveJson(httpd_req_t* req, JsonFieldListener& listener) {
+    if (req->content_len == 0 || req->content_len > REQUEST_BODY_MAX_LEN) {
+        return ESP_ERR_INVALID_SIZE;
     }
 
-    // POST /api/network/sta/connect
-    httpd_uri_t post_sta_connect_uri = {.uri = "/api/network/sta/connect",
-                                        .method = HTTP_POST,
-                                        .handler = staConnectHandlerWrapper,
-                                        .user_ctx = (void*)this};
-    err = httpd_register_uri_handler(server_handle, &post_sta_connect_uri);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to register POST /api/network/sta/connect: %s", esp_err_to_name(err));
-    } else {
-        ESP_LOGI(TAG, "Registered POST /api/network/sta/connect");
-    }
-
-    // POST /api/network/sta/disconnect
-    httpd_uri_t post_sta_disconnect_uri = {.uri = "/api/network/sta/disconnect",
-                                           .method = HTTP_POST,
-                                           .handler = staDisconnectHandlerWrapper,
-                                           .user_ctx = (void*)this};
-    err = httpd_register_uri_handler(server_handle, &post_sta_disconnect_uri);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to register POST /api/network/sta/disconnect: %s",
-                 esp_err_to_name(err));
-    } else {
-        ESP_LOGI(TAG, "Registered POST /api/network/sta/disconnect");
+    JsonStreamParser parser(listener);
+    char buf[RECV_CHUNK_SIZE];
+    size_t remaining = req->content_len;
+    int timeouts = 0;
+
+    while (remaining > 0) {
+        int len = httpd_req_recv(req, buf, remaining < sizeof(buf) ? remaining : sizeof(buf));
+        if (len == HTTPD_SOCK_ERR_TIMEOUT && ++timeouts <= RECV_TIMEOUT_RETRIES) continue;
+        if (len <= 0) return ESP_FAIL;
+
+        remaining -= len;
+        if (!parser.feed(buf, len)) break;
     }
 
-    // GET /api/network/status
-    httpd_uri_t get_network_status_uri = {.uri = "/api/network/status",
-                                          .method = HTTP_GET,
-                                          .handler = networkStatusHandlerWrapper,
-                                          .user_ctx = (void*)this};
-    err = httpd_register_uri_handler(server_handle, &get_network_status_uri);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to register GET /api/network/status: %s", esp_err_to_name(err));
-    } else {
-        ESP_LOGI(TAG, "Registered GET /api/network/status");
+    if (!parser.finish()) {
+        ESP_LOGW(TAG, "Rejected body for %s: %s", req->uri, parser.error());
+        return ESP_ERR_INVALID_ARG;
     }
+    return ESP_OK;
 }
 
-esp_err_t HttpServer::rootHandler(httpd_req_t* req) {
-    float temp = DS18B20SensorManager::getLastTemperature();
-    bool ok = DS18B20SensorManager::getSensorStatus();
+static esp_err_t sendBodyError(httpd_req_t* req, esp_err_t err, const JsonFieldBinder& binder) {
+    if (err == ESP_FAIL) return ESP_FAIL;  // Socket is gone; let httpd close it
+    if (err == ESP_ERR_INVALID_SIZE) {
+        if (req->content_len == 0) {
+            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "No data");
+        }
+        return httpd_resp_send_err(req, HTTPD_413_CONTENT_TOO_LARGE, "Body too large");
+    }
+    if (binder.invalidKey()) {
+        char msg[48];
+        snprintf(msg, sizeof(msg), "Invalid %s", binder.invalidKey());
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, msg);
+    }
+    return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+}
 
-    cJSON* root = cJSON_CreateObject();
-    cJSON_AddNumberToObject(root, "temperature", temp);
-    cJSON_AddBoolToObject(root, "sensor_ok", ok);
+static const char* historyTierName(HistoryTier tier) {
+    switch (tier) {
+        case HistoryTier::Raw:
+            return "raw";
+        case HistoryTier::Minute:
+            return "minute";
+        default:
+            return "hour";
+    }
+}
 
-    char* resp = cJSON_PrintUnformatted(root);
-    cJSON_Delete(root);
+static const char* methodName(httpd_method_t method) {
+    switch (method) {
+        case HTTP_GET:
+            return "GET";
+        case HTTP_POST:
+            return "POST";
+        case HTTP_PUT:
+            return "PUT";
+        case HTTP_PATCH:
+            return "PATCH";
+        case HTTP_DELETE:
+            return "DELETE";
+        default:
+            return "OTHER";
+    }
+}
 
-    httpd_resp_set_type(req, "application/json");
-    esp_err_t ret = httpd_resp_send(req, resp, strlen(resp));
-    free(resp);
+static bool sendMetricsChunk(void* ctx, const char* data, size_t len) {
+    return httpd_resp_send_chunk(static_cast<httpd_req_t*>(ctx), data, len) == ESP_OK;
+}
 
-    return ret;
+static const char* scanStateName(WiFiScanState state) {
+    switch (state) {
+        case WiFiScanState::Scanning:
+            return "scanning";
+        case WiFiScanState::Done:
+            return "done";
+        case WiFiScanState::Failed:
+            return "failed";
+        default:
+            return "idle";
+    }
 }
 
-// GET /api/device/info
-esp_err_t HttpServer::infoHandler(httpd_req_t* req) {
-    DeviceInfo device_info = ConfigManager::getInstance().getDeviceInfo();
+static const char* authModeName(uint8_t authmode) {
+    switch (authmode) {
+        case WIFI_AUTH_OPEN:
+            return "open";
+        case WIFI_AUTH_WEP:
+            return "wep";
+        case WIFI_AUTH_WPA_PSK:
+            return "wpa";
+        case WIFI_AUTH_WPA2_PSK:
+        case WIFI_AUTH_WPA_WPA2_PSK:
+            return "wpa2";
+        case WIFI_AUTH_WPA2_ENTERPRISE:
+            return "enterprise";
+        case WIFI_AUTH_WPA3_PSK:
+        case WIFI_AUTH_WPA2_WPA3_PSK:
+            return "wpa3";
+        default:
+            return "other";
+    }
+}
 
-    cJSON* root = cJSON_CreateObject();
-    cJSON_AddStringToObject(root, "device_name", device_info.device_name);
-    cJSON_AddStringToObject(root, "firmware_version", device_info.firmware_version);
+static bool parseQueryU32(const char* query, const char* key, uint32_t& value) {
+    char param[12];
+    if (httpd_query_key_value(query, key, param, sizeof(param)) != ESP_OK) return true;
 
-    char* resp = cJSON_PrintUnformatted(root);
-    cJSON_Delete(root);
+    if (param[0] < '0' || param[0] > '9') return false;
 
-    httpd_resp_set_type(req, "application/json");
-    esp_err_t ret = httpd_resp_send(req, resp, strlen(resp));
-    free(resp);
+    char* end = nullptr;
+    unsigned long long parsed = strtoull(param, &end, 10);
+    if (*end != '\0' || parsed > UINT32_MAX) return false;
 
-    return ret;
+    value = static_cast<uint32_t>(parsed);
+    return true;
 }
 
-// PATCH /api/device/info
-esp_err_t HttpServer::patchDeviceInfoHandler(httpd_req_t* req) {
-    char buf[128];
-    int len = httpd_req_recv(req, buf, sizeof(buf) - 1);
-    if (len <= 0) return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "No data");
+// Adding an endpoint is one line here; the handler is a member of HttpServer.
+constexpr HttpServer::Route HttpServer::ROUTES[] = {
+    {"/", HTTP_GET, dispatch<&HttpServer::rootHandler>},
+    {"/favicon.ico", HTTP_GET, dispatch<&HttpServer::faviconHandler>},
 
-    buf[len] = '\0';
-    cJSON* json = cJSON_Parse(buf);
-    if (!json) return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+    // ───────────── DEVICE INFO ─────────────
+    {"/api/device/info", HTTP_GET, dispatch<&HttpServer::infoHandler>},
+    {"/api/device/info", HTTP_PATCH, dispatch<&HttpServer::patchDeviceInfoHandler>},
 
-    const cJSON* name = cJSON_GetObjectItem(json, "device_name");
-    if (!cJSON_IsString(name) || strlen(name->valuestring) >= DEVICE_NAME_MAX_LEN) {
-        cJSON_Delete(json);
-        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid device_name");
+    // ───────────── NETWORK CONFIG ─────────────
+    {"/api/network/ap/set", HTTP_POST, dispatch<&HttpServer::postApConfigHandler>},
+    {"/api/network/sta/connect", HTTP_POST, dispatch<&HttpServer::staConnectHandler>},
+    {"/api/network/sta/disconnect", HTTP_POST,
+     dispatch<&HttpServer::staDisconnectHandler>},
+    {"/api/network/status", HTTP_GET, dispatch<&HttpServer::networkStatusHandler>},
+    {"/api/network/scan", HTTP_POST, dispatch<&HttpServer::startScanHandler>},
+    {"/api/network/scan", HTTP_GET, dispatch<&HttpServer::scanResultsHandler>},
+
+    // ───────────── SENSORS ─────────────
+    {"/api/sensors/history", HTTP_GET, dispatch<&HttpServer::historyHandler>},
+    {"/api/sensors/stream", HTTP_GET, dispatch<&HttpServer::sensorStreamHandler>},
+#if CONFIG_HTTP_SERVER_WEBSOCKET
+    {"/ws", HTTP_GET, dispatch<&HttpServer::websocketHandler>, true},
+#endif
+
+    // ───────────── DIAGNOSTICS ─────────────
+    {"/metrics", HTTP_GET, dispatch<&HttpServer::metricsHandler>},
+};
+
+constexpr size_t HttpServer::ROUTE_COUNT = sizeof(ROUTES) / sizeof(ROUTES[0]);
+static_assert(HttpServer::ROUTE_COUNT <= HttpServer::MAX_ROUTES, "Raise HttpServer::MAX_ROUTES");
+
+void HttpServer::registerEndpoints() {
+    static bool latency_published = false;
+    if (!latency_published) {
+        // In reverse, as the newest metric is exported first
+        for (size_t i = ROUTE_COUNT; i-- > 0;) {
+            snprintf(route_labels[i], sizeof(route_labels[i]), "route=\"%s %s\"",
+                     methodName(ROUTES[i].method), ROUTES[i].uri);
+            route_latency[i].publish("http_request_duration_seconds",
+                                     "Time spent in the route's handler", route_labels[i]);
+        }
+        latency_published = true;
     }
 
-    DeviceInfo device_info = ConfigManager::getInstance().getDeviceInfo();
-    strncpy(device_info.device_name, name->valuestring, DEVICE_NAME_MAX_LEN - 1);
-    device_info.device_name[DEVICE_NAME_MAX_LEN - 1] = '\0';
-    ConfigManager::getInstance().updateDeviceInfo(device_info);
+    size_t registered = 0;
+    for (size_t i = 0; i < ROUTE_COUNT; i++) {
+        const Route& route = ROUTES[i];
+        route_contexts[i] = {this, &route_latency[i]};
+        httpd_uri_t uri = {.uri = route.uri,
+                           .method = route.method,
+                           .handler = route.handler,
+                           .user_ctx = &route_contexts[i]};
+#if CONFIG_HTTPD_WS_SUPPORT
+        uri.is_websocket = route.websocket;
+#endif
+        esp_err_t err = httpd_register_uri_handler(server_handle, &uri);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to register %s: %s", route.uri, esp_err_to_name(err));
+            continue;
+        }
+        registered++;
+    }
+    ESP_LOGI(TAG, "Registered %u/%u routes", (unsigned)registered, (unsigned)ROUTE_COUNT);
+}
 
-    cJSON* resp = cJSON_CreateObject();
-    cJSON_AddStringToObject(resp, "status", "device name updated");
+esp_err_t HttpServer::rootHandler(httpd_req_t* req) {
+    SensorSnapshot sample = DS18B20SensorManager::getSnapshot();
 
-    char* resp_str = cJSON_PrintUnformatted(resp);
-    cJSON_Delete(resp);
+    char buf[JSON_RESPONSE_SIZE];
+    JsonWriter json(buf, sizeof(buf));
+    json.beginObject()
+        .field("temperature", sample.temperature)
+        .field("sensor_ok", sample.ok)
+        .endObject();
 
-    httpd_resp_set_type(req, "application/json");
-    esp_err_t ret = httpd_resp_send(req, resp_str, strlen(resp_str));
-    free(resp_str);
-    cJSON_Delete(json);
+    return sendJson(req, json);
+}
 
-    return ret;
+// GET /favicon.ico (empty)
+esp_err_t HttpServer::faviconHandler(httpd_req_t* req) {
+    httpd_resp_set_type(req, "image/x-icon");
+    return httpd_resp_send(req, NULL, 0);
 }
 
-// POST /api/network/ap/set
-esp_err_t HttpServer::postApConfigHandler(httpd_req_t* req) {
-    char buf[256];
-    int len = httpd_req_recv(req, buf, sizeof(buf) - 1);
-    if (len <= 0) return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "No data");
+// GET /api/device/info
+esp_err_t HttpServer::infoHandler(httpd_req_t* req) {
+    // A config update racing the render below only costs one extra render
+    uint32_t generation = ConfigManager::getInstance().getGeneration();
+    if (!info_cache.fresh(generation)) {
+        ConfigSnapshot config = ConfigManager::getInstance().getSnapshot();
+
+        JsonWriter json(info_cache.buffer(), ResponseCache::CAPACITY);
+        json.beginObject()
+            .field("device_name", config->info.device_name)
+            .field("firmware_version", config->info.firmware_version)
+            .endObject();
+        if (!json.ok()) return sendJson(req, json);
+
+        info_cache.commit(generation, json.length());
+    }
 
-    buf[len] = '\0';
-    cJSON* json = cJSON_Parse(buf);
-    if (!json) return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+    return sendCached(req, info_cache);
+}
 
-    NetworkConfig network_config = ConfigManager::getInstance().getNetworkConfig();
+// PATCH /api/device/info
+esp_err_t HttpServer::patchDeviceInfoHandler(httpd_req_t* req) {
+    DeviceInfo device_info = ConfigManager::getInstance().getDeviceInfo();
 
-    const cJSON* ssid = cJSON_GetObjectItem(json, "ap_ssid");
-    if (ssid) {
-        if (!cJSON_IsString(ssid) || strlen(ssid->valuestring) >= SSID_MAX_LEN) {
-            cJSON_Delete(json);
-            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid ap_ssid");
-        }
-        strncpy(network_config.ap_ssid, ssid->valuestring, SSID_MAX_LEN - 1);
-        network_config.ap_ssid[SSID_MAX_LEN - 1] = '\0';
-    }
-
-    const cJSON* password = cJSON_GetObjectItem(json, "ap_password");
-    if (cJSON_HasObjectItem(json, "ap_password")) {
-        if (cJSON_IsString(password)) {
-            if (strlen(password->valuestring) == 0) {
-                network_config.ap_password[0] = '\0';
-            } else {
-                strncpy(network_config.ap_password, password->valuestring, PASSWORD_MAX_LEN - 1);
-                network_config.ap_password[PASSWORD_MAX_LEN - 1] = '\0';
-            }
-        } else if (cJSON_IsNull(password)) {
-            network_config.ap_password[0] = '\0';
-        } else {
-            cJSON_Delete(json);
-            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid ap_password");
-        }
-    }
+    const JsonFieldBinding fields[] = {
+        {"device_name", JsonFieldKind::String, device_info.device_name,
+         sizeof(device_info.device_name)},
+    };
+    JsonFieldBinder binder(fields, sizeof(fields) / sizeof(fields[0]));
 
-    const cJSON* enabled = cJSON_GetObjectItem(json, "ap_enabled");
-    if (enabled && cJSON_IsBool(enabled)) {
-        network_config.ap_enabled = cJSON_IsTrue(enabled);
+    esp_err_t err = receiveJson(req, binder);
+    if (err != ESP_OK) return sendBodyError(req, err, binder);
+    if (!binder.wasSet(0)) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid device_name");
     }
 
-    ConfigManager::getInstance().updateNetworkConfig(network_config);
+    ConfigManager::getInstance().updateDeviceInfo(device_info);
+    return sendStatus(req, "device name updated");
+}
 
-    cJSON* resp = cJSON_CreateObject();
-    cJSON_AddStringToObject(resp, "status", "AP config updated");
+// POST /api/network/ap/set
+esp_err_t HttpServer::postApConfigHandler(httpd_req_t* req) {
+    NetworkConfig network_config = ConfigManager::getInstance().getNetworkConfig();
 
-    char* resp_str = cJSON_PrintUnformatted(resp);
-    cJSON_Delete(resp);
+    const JsonFieldBinding fields[] = {
+        {"ap_ssid", JsonFieldKind::String, network_config.ap_ssid, sizeof(network_config.ap_ssid)},
+        {"ap_password", JsonFieldKind::NullableString, network_config.ap_password,
+         sizeof(network_config.ap_password)},
+        {"ap_enabled", JsonFieldKind::Bool, &network_config.ap_enabled, 0},
+    };
+    JsonFieldBinder binder(fields, sizeof(fields) / sizeof(fields[0]));
 
-    httpd_resp_set_type(req, "application/json");
-    esp_err_t ret = httpd_resp_send(req, resp_str, strlen(resp_str));
-    free(resp_str);
-    cJSON_Delete(json);
+    esp_err_t err = receiveJson(req, binder);
+    if (err != ESP_OK) return sendBodyError(req, err, binder);
 
-    return ret;
+    ConfigManager::getInstance().updateNetworkConfig(network_config);
+    return sendStatus(req, "AP config updated");
 }
 
-// POST /api/network/sta/connect
+// POST /api/network/sta/connect {"ssid": "...", "password": "..."}
+// WiFiManager picks the change up from the config bus and connects in the background
 esp_err_t HttpServer::staConnectHandler(httpd_req_t* req) {
-    cJSON* root = cJSON_CreateObject();
-    cJSON_AddStringToObject(root, "status", "STA connect triggered (mock)");
-
-    char* resp = cJSON_PrintUnformatted(root);
-    cJSON_Delete(root);
+    NetworkConfig network_config = ConfigManager::getInstance().getNetworkConfig();
+    char ssid[SSID_MAX_LEN] = {};
+    char password[PASSWORD_MAX_LEN] = {};
+
+    const JsonFieldBinding fields[] = {
+        {"ssid", JsonFieldKind::String, ssid, sizeof(ssid)},
+        {"password", JsonFieldKind::NullableString, password, sizeof(password)},
+    };
+    JsonFieldBinder binder(fields, sizeof(fields) / sizeof(fields[0]));
+
+    esp_err_t err = receiveJson(req, binder);
+    if (err != ESP_OK) return sendBodyError(req, err, binder);
+    if (!binder.wasSet(0) || ssid[0] == '\0') {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid ssid");
+    }
 
-    httpd_resp_set_type(req, "application/json");
-    esp_err_t ret = httpd_resp_send(req, resp, strlen(resp));
-    free(resp);
+    // The cached AP belongs to the old network
+    if (strcmp(ssid, network_config.ssid) != 0) {
+        network_config.bssid[0] = '\0';
+        network_config.channel = 0;
+    }
+    memcpy(network_config.ssid, ssid, sizeof(ssid));
+    memcpy(network_config.password, password, sizeof(password));
+    network_config.sta_enabled = true;
 
-    return ret;
+    ConfigManager::getInstance().updateNetworkConfig(network_config);
+    return sendStatus(req, "STA connecting");
 }
 
 // POST /api/network/sta/disconnect
 esp_err_t HttpServer::staDisconnectHandler(httpd_req_t* req) {
-    cJSON* root = cJSON_CreateObject();
-    cJSON_AddStringToObject(root, "status", "STA disconnect triggered (mock)");
-
-    char* resp = cJSON_PrintUnformatted(root);
-    cJSON_Delete(root);
-
-    httpd_resp_set_type(req, "application/json");
-    esp_err_t ret = httpd_resp_send(req, resp, strlen(resp));
-    free(resp);
+    NetworkConfig network_config = ConfigManager::getInstance().getNetworkConfig();
+    network_config.sta_enabled = false;
 
-    return ret;
+    ConfigManager::getInstance().updateNetworkConfig(network_config);
+    return sendStatus(req, "STA disconnected");
 }
 
 // GET /api/network/status
 esp_err_t HttpServer::networkStatusHandler(httpd_req_t* req) {
-    NetworkConfig network_config = ConfigManager::getInstance().getNetworkConfig();
+    uint32_t generation = ConfigManager::getInstance().getGeneration();
+    if (!network_status_cache.fresh(generation)) {
+        ConfigSnapshot config = ConfigManager::getInstance().getSnapshot();
+        const NetworkConfig& network_config = config->network;
+
+        JsonWriter json(network_status_cache.buffer(), ResponseCache::CAPACITY);
+        json.beginObject()
+            .field("ap_ssid", network_config.ap_ssid)
+            .field("ap_enabled", network_config.ap_enabled)
+            .field("ap_password", network_config.ap_password)
+            .field("sta_enabled", network_config.sta_enabled)
+            .field("ssid", network_config.ssid)
+            .field("bssid", network_config.bssid)
+            .field("channel", network_config.channel)
+            .field("ip_address", network_config.ip_address)
+            .field("mac_address", network_config.mac_address)
+            .endObject();
+        if (!json.ok()) return sendJson(req, json);
+
+        network_status_cache.commit(generation, json.length());
+    }
+
+    return sendCached(req, network_status_cache);
+}
+
+// POST /api/network/scan
+// Returns at once; the scan runs on the Wi-Fi driver's task and
+// GET /api/network/scan pages through what it found
+esp_err_t HttpServer::startScanHandler(httpd_req_t* req) {
+    WiFiScanRequest result = WiFiScanRequest::Unavailable;
+    WiFiScanStatus status = {};
+    if (wifi_manager) {
+        result = wifi_manager->requestScan();
+        status = wifi_manager->getScanStatus();
+    }
+
+    char buf[JSON_RESPONSE_SIZE];
+    JsonWriter json(buf, sizeof(buf));
+    char retry_after[12];
+    switch (result) {
+        case WiFiScanRequest::Started:
+        case WiFiScanRequest::Running:
+            httpd_resp_set_status(req, "202 Accepted");
+            json.beginObject().field("status", "scanning").endObject();
+            break;
+        case WiFiScanRequest::Cached:
+            json.beginObject()
+                .field("status", "cached")
+                .field("total", status.total)
+                .field("age_ms", status.age_ms)
+                .endObject();
+            break;
+        case WiFiScanRequest::RateLimited:
+            snprintf(retry_after, sizeof(retry_after), "%lu",
+                     (unsigned long)(status.retry_ms + 999) / 1000);
+            httpd_resp_set_status(req, "429 Too Many Requests");
+            httpd_resp_set_hdr(req, "Retry-After", retry_after);
+            json.beginObject()
+                .field("status", "rate limited")
+                .field("retry_ms", status.retry_ms)
+                .endObject();
+            break;
+        default:
+            httpd_resp_set_status(req, "503 Service Unavailable");
+            json.beginObject().field("status", "unavailable").endObject();
+            break;
+    }
+    return sendJson(req, json);
+}
 
-    cJSON* root = cJSON_CreateObject();
-    cJSON_AddStringToObject(root, "ap_ssid", network_config.ap_ssid);
-    cJSON_AddBoolToObject(root, "ap_enabled", network_config.ap_enabled);
-    cJSON_AddStringToObject(root, "ap_password", network_config.ap_password);
-    cJSON_AddBoolToObject(root, "sta_enabled", network_config.sta_enabled);
-    cJSON_AddStringToObject(root, "ssid", network_config.ssid);
-    cJSON_AddStringToObject(root, "bssid", network_config.bssid);
-    cJSON_AddStringToObject(root, "ip_address", network_config.ip_address);
-    cJSON_AddStringToObject(root, "mac_address", network_config.mac_address);
+// GET /api/network/scan?offset=0&limit=10
+// Served from the scan table until CONFIG_WIFI_MANAGER_SCAN_TTL_MS runs out
+esp_err_t HttpServer::scanResultsHandler(httpd_req_t* req) {
+    uint32_t offset = 0;
+    uint32_t limit = SCAN_PAGE_DEFAULT;
+
+    char query_str[QUERY_MAX_LEN];
+    if (httpd_req_get_url_query_str(req, query_str, sizeof(query_str)) == ESP_OK) {
+        if (!parseQueryU32(query_str, "offset", offset) ||
+            !parseQueryU32(query_str, "limit", limit)) {
+            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid query parameter");
+        }
+    }
 
-    char* resp = cJSON_PrintUnformatted(root);
-    cJSON_Delete(root);
+    RequestArena* arena = requestArena(req);
+    auto* entries = arenaAlloc<WiFiScanEntry>(arena, SCAN_PAGE_MAX);
+    char* buf = arenaAlloc<char>(arena, JSON_RESPONSE_SIZE);
+    char* entry_buf = arenaAlloc<char>(arena, SCAN_ENTRY_JSON_SIZE);
+    if (!entries || !buf || !entry_buf) return sendArenaExhausted(req);
+
+    WiFiScanStatus status = {};
+    size_t count = 0;
+    if (wifi_manager) {
+        count = wifi_manager->getScanResults(offset, entries,
+                                             limit < SCAN_PAGE_MAX ? limit : SCAN_PAGE_MAX, status);
+    }
 
+    ChunkedResponse out(req, buf, JSON_RESPONSE_SIZE);
     httpd_resp_set_type(req, "application/json");
-    esp_err_t ret = httpd_resp_send(req, resp, strlen(resp));
-    free(resp);
+    out.printf("{\"status\":\"%s\",\"age_ms\":%lu,\"total\":%u,\"offset\":%lu,\"aps\":[",
+               scanStateName(status.state), (unsigned long)status.age_ms,
+               (unsigned)status.total, (unsigned long)offset);
+
+    // Entries go through JsonWriter one at a time for the SSID escaping
+    char bssid[MAC_ADDR_LEN];
+    for (size_t i = 0; i < count; i++) {
+        const WiFiScanEntry& entry = entries[i];
+        snprintf(bssid, sizeof(bssid), "%02x:%02x:%02x:%02x:%02x:%02x", entry.bssid[0],
+                 entry.bssid[1], entry.bssid[2], entry.bssid[3], entry.bssid[4], entry.bssid[5]);
+        JsonWriter json(entry_buf, SCAN_ENTRY_JSON_SIZE);
+        json.beginObject()
+            .field("ssid", entry.ssid)
+            .field("bssid", bssid)
+            .field("channel", entry.channel)
+            .field("rssi", entry.rssi)
+            .field("auth", authModeName(entry.authmode))
+            .endObject();
+        if (!out.printf("%s%s", i ? "," : "", json.c_str())) return ESP_FAIL;
+    }
 
-    return ret;
+    out.printf("]}");
+    return out.finish();
 }
 
-// Wrappers
-esp_err_t HttpServer::rootHandlerWrapper(httpd_req_t* req) {
-    return rootHandler(req);
-}
+// GET /api/sensors/history?sensor=0&from=0&to=3600&step=60
+esp_err_t HttpServer::historyHandler(httpd_req_t* req) {
+    uint32_t sensor = 0;
+    HistoryQuery query = {0, UINT32_MAX, 0};
+
+    char query_str[QUERY_MAX_LEN];
+    if (httpd_req_get_url_query_str(req, query_str, sizeof(query_str)) == ESP_OK) {
+        if (!parseQueryU32(query_str, "sensor", sensor) ||
+            !parseQueryU32(query_str, "from", query.from_s) ||
+            !parseQueryU32(query_str, "to", query.to_s) ||
+            !parseQueryU32(query_str, "step", query.step_s)) {
+            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid query parameter");
+        }
+    }
+    if (query.from_s > query.to_s) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "from must not exceed to");
+    }
+
+    const SensorHistory* history = DS18B20SensorManager::getHistory(sensor);
+    if (!history) return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No history for sensor");
+
+    // Output size is unbounded; memory is not. Points are pulled in fixed
+    // batches and formatted into one fixed buffer that is flushed as chunks.
+    RequestArena* arena = requestArena(req);
+    char* buf = arenaAlloc<char>(arena, HISTORY_CHUNK_SIZE);
+    auto* points = arenaAlloc<HistoryPoint>(arena, HISTORY_BATCH_POINTS);
+    if (!buf || !points) return sendArenaExhausted(req);
+    ChunkedResponse out(req, buf, HISTORY_CHUNK_SIZE);
+
+    httpd_resp_set_type(req, "application/json");
+    out.printf("{\"sensor\":%lu,\"step\":%lu,\"tier\":\"%s\",\"points\":[",
+               (unsigned long)sensor, (unsigned long)query.step_s,
+               historyTierName(SensorHistory::tierForStep(query.step_s)));
+
+    HistoryCursor cursor;
+    bool first = true;
+    while (!cursor.done) {
+        size_t n = history->query(query, cursor, points, HISTORY_BATCH_POINTS);
+        for (size_t i = 0; i < n; i++) {
+            const HistoryPoint& p = points[i];
+            if (!out.printf("%s{\"t\":%lu,\"min\":%.2f,\"max\":%.2f,\"avg\":%.2f}",
+                            first ? "" : ",", (unsigned long)p.time_s, p.min / 100.0,
+                            p.max / 100.0, p.avg / 100.0)) {
+                return ESP_FAIL;  // Client went away
+            }
+            first = false;
+        }
+    }
 
-esp_err_t HttpServer::infoHandlerWrapper(httpd_req_t* req) {
-    return static_cast<HttpServer*>(req->user_ctx)->infoHandler(req);
+    out.printf("]}");
+    return out.finish();
 }
 
-esp_err_t HttpServer::patchDeviceInfoHandlerWrapper(httpd_req_t* req) {
-    return static_cast<HttpServer*>(req->user_ctx)->patchDeviceInfoHandler(req);
+// GET /api/sensors/stream (text/event-stream)
+esp_err_t HttpServer::sensorStreamHandler(httpd_req_t* req) {
+    return sensor_stream.accept(req);
 }
 
-esp_err_t HttpServer::postApConfigHandlerWrapper(httpd_req_t* req) {
-    return static_cast<HttpServer*>(req->user_ctx)->postApConfigHandler(req);
+// GET /ws (WebSocket, frames per ws_protocol.hpp)
+esp_err_t HttpServer::websocketHandler(httpd_req_t* req) {
+#if CONFIG_HTTP_SERVER_WEBSOCKET
+    return ws_channel.handle(req);
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
 }
 
-esp_err_t HttpServer::staConnectHandlerWrapper(httpd_req_t* req) {
-    return static_cast<HttpServer*>(req->user_ctx)->staConnectHandler(req);
+// GET /metrics (Prometheus text format, streamed in chunks)
+esp_err_t HttpServer::metricsHandler(httpd_req_t* req) {
+    char* buf = arenaAlloc<char>(requestArena(req), METRICS_CHUNK_SIZE);
+    if (!buf) return sendArenaExhausted(req);
+    MetricsWriter out(buf, METRICS_CHUNK_SIZE, sendMetricsChunk, req);
+
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+    writeMetrics(out);
+    if (!out.flush()) return ESP_FAIL;  // Client went away
+    return httpd_resp_send_chunk(req, nullptr, 0);
 }
 
-esp_err_t HttpServer::staDisconnectHandlerWrapper(httpd_req_t* req) {
-    return static_cast<HttpServer*>(req->user_ctx)->staDisconnectHandler(req);
+// The session keeps its arena until the socket closes, when httpd hands it
+// back through free_ctx
+RequestArena* HttpServer::requestArena(httpd_req_t* req) {
+    if (!req->sess_ctx) {
+        RequestArena* arena = arena_pool.acquire();
+        if (!arena) return nullptr;
+        req->sess_ctx = arena;
+        req->free_ctx = RequestArenaPool::releaseContext;
+        arenas_peak.raise(arena_pool.peakInUse());
+    }
+    return static_cast<RequestArena*>(req->sess_ctx);
 }
 
-esp_err_t HttpServer::networkStatusHandlerWrapper(httpd_req_t* req) {
-    return static_cast<HttpServer*>(req->user_ctx)->networkStatusHandler(req);
+void HttpServer::endRequest(httpd_req_t* req) {
+    auto* arena = static_cast<RequestArena*>(req->sess_ctx);
+    if (!arena) return;
+    arena_high_water.raise(arena->used());
+    arena->reset();
 }
 
 void HttpServer::start() {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.max_uri_handlers = ROUTE_COUNT;
+
+    // Sized so that every socket httpd may open can hold an arena
+    if (!arena_pool.init(config.max_open_sockets, CONFIG_HTTP_SERVER_ARENA_SIZE)) {
+        ESP_LOGE(TAG, "No memory for %u request arenas", (unsigned)config.max_open_sockets);
+        return;
+    }
+    arena_size_bytes.set(arena_pool.arenaSize());
+
+    // The stream task must exist before the first request can reach accept()
+    if (sensor_stream.start() != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start sensor event stream");
+    }
 
     if (httpd_start(&server_handle, &config) == ESP_OK) {
         ESP_LOGI(TAG, "HTTP server started");
+#if CONFIG_HTTP_SERVER_WEBSOCKET
+        if (ws_channel.start(server_handle) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to start WebSocket channel");
+        }
+#endif
         registerEndpoints();
     } else {
         ESP_LOGE(TAG, "Failed to start HTTP server");
+        arena_pool.deinit();
     }
 }
 
 void HttpServer::stop() {
     if (server_handle) {
-        httpd_stop(server_handle);
+        sensor_stream.stop();
+#if CONFIG_HTTP_SERVER_WEBSOCKET
+        ws_channel.stop();
+#endif
+        httpd_stop(server_handle);  // Closes the sessions, returning their arenas
         server_handle = nullptr;
+        arena_pool.deinit();
         ESP_LOGI(TAG, "HTTP server stopped");
     }
 }
@@ -0,0 +1,320 @@
+#include "json_stream_parser.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+JsonStreamParser::JsonStreamParser(JsonFieldListener& listener) : listener_(listener) {
+    key_[0] = '\0';
+    value_[0] = '\0';
+}
+
+bool JsonStreamParser::feed(const char* data, size_t len) {
+    for (size_t i = 0; i < len && state_ != State::Error; i++) {
+        step(data[i]);
+    }
+    return state_ != State::Error;
+}
+
+bool JsonStreamParser::finish() {
+    if (state_ == State::Error) return false;
+    if (state_ != State::Done) return fail("Unexpected end of input");
+    return true;
+}
+
+bool JsonStreamParser::failed() const {
+    return state_ == State::Error;
+}
+
+const char* JsonStreamParser::error() const {
+    return error_;
+}
+
+bool JsonStreamParser::fail(const char* error) {
+    if (state_ != State::Error) error_ = error;
+    state_ = State::Error;
+    return false;
+}
+
+bool JsonStreamParser::isWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+void JsonStreamParser::append(char c, char* buf, size_t cap, size_t& len, bool& truncated) {
+    if (len < cap) {
+        buf[len++] = c;
+        buf[len] = '\0';
+    } else {
+        truncated = true;
+    }
+}
+
+JsonStreamParser::StringStep JsonStreamParser::stringChar(char c, char* buf, size_t cap,
+                                                          size_t& len, bool& truncated) {
+    if (unicode_left_ > 0) {
+        int digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else {
+            return StringStep::Invalid;
+        }
+        unicode_value_ = static_cast<uint16_t>((unicode_value_ << 4) | digit);
+        if (--unicode_left_ > 0) return StringStep::Continue;
+
+        // Encode the BMP code point as UTF-8; surrogate pairs are not supported
+        uint16_t cp = unicode_value_;
+        if (cp >= 0xD800 && cp <= 0xDFFF) return StringStep::Invalid;
+        if (cp < 0x80) {
+            append(static_cast<char>(cp), buf, cap, len, truncated);
+        } else if (cp < 0x800) {
+            append(static_cast<char>(0xC0 | (cp >> 6)), buf, cap, len, truncated);
+            append(static_cast<char>(0x80 | (cp & 0x3F)), buf, cap, len, truncated);
+        } else {
+            append(static_cast<char>(0xE0 | (cp >> 12)), buf, cap, len, truncated);
+            append(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)), buf, cap, len, truncated);
+            append(static_cast<char>(0x80 | (cp & 0x3F)), buf, cap, len, truncated);
+        }
+        return StringStep::Continue;
+    }
+
+    if (escape_) {
+        escape_ = false;
+        switch (c) {
+            case '"':
+            case '\\':
+            case '/':
+                append(c, buf, cap, len, truncated);
+                break;
+            case 'b':
+                append('\b', buf, cap, len, truncated);
+                break;
+            case 'f':
+                append('\f', buf, cap, len, truncated);
+                break;
+            case 'n':
+                append('\n', buf, cap, len, truncated);
+                break;
+            case 'r':
+                append('\r', buf, cap, len, truncated);
+                break;
+            case 't':
+                append('\t', buf, cap, len, truncated);
+                break;
+            case 'u':
+                unicode_left_ = 4;
+                unicode_value_ = 0;
+                break;
+            default:
+                return StringStep::Invalid;
+        }
+        return StringStep::Continue;
+    }
+
+    if (c == '\\') {
+        escape_ = true;
+        return StringStep::Continue;
+    }
+    if (c == '"') return StringStep::Closed;
+    if (static_cast<unsigned char>(c) < 0x20) return StringStep::Invalid;
+
+    append(c, buf, cap, len, truncated);
+    return StringStep::Continue;
+}
+
+bool JsonStreamParser::emit(JsonValueType type) {
+    // Over-long keys cannot match any binding; drop the member
+    if (key_truncated_) return true;
+
+    JsonValue value = {type, value_, value_len_, value_truncated_};
+    if (!listener_.onField(key_, value)) return fail("Rejected field");
+    return true;
+}
+
+bool JsonStreamParser::emitLiteral() {
+    if (value_truncated_) return fail("Invalid literal");
+
+    if (strcmp(value_, "true") == 0 || strcmp(value_, "false") == 0) {
+        return emit(JsonValueType::Bool);
+    }
+    if (strcmp(value_, "null") == 0) return emit(JsonValueType::Null);
+
+    // strtod accepts more than JSON does (hex, inf, leading '+'), so gate the first char
+    char first = value_[0];
+    if (first != '-' && (first < '0' || first > '9')) return fail("Invalid literal");
+    char* end = nullptr;
+    strtod(value_, &end);
+    if (end != value_ + value_len_) return fail("Invalid number");
+    return emit(JsonValueType::Number);
+}
+
+bool JsonStreamParser::step(char c) {
+    switch (state_) {
+        case State::Start:
+            if (isWhitespace(c)) return true;
+            if (c != '{') return fail("Expected object");
+            state_ = State::KeyOrEnd;
+            return true;
+
+        case State::KeyOrEnd:
+            if (isWhitespace(c)) return true;
+            if (c == '}' && !after_comma_) {
+                state_ = State::Done;
+                return true;
+            }
+            if (c != '"') return fail("Expected key");
+            key_len_ = 0;
+            key_[0] = '\0';
+            key_truncated_ = false;
+            state_ = State::Key;
+            return true;
+
+        case State::Key:
+            switch (stringChar(c, key_, JSON_PARSER_MAX_KEY_LEN, key_len_, key_truncated_)) {
+                case StringStep::Closed:
+                    state_ = State::Colon;
+                    return true;
+                case StringStep::Invalid:
+                    return fail("Invalid string");
+                default:
+                    return true;
+            }
+
+        case State::Colon:
+            if (isWhitespace(c)) return true;
+            if (c != ':') return fail("Expected ':'");
+            value_len_ = 0;
+            value_[0] = '\0';
+            value_truncated_ = false;
+            state_ = State::Value;
+            return true;
+
+        case State::Value:
+            if (isWhitespace(c)) return true;
+            if (c == '"') {
+                state_ = State::String;
+            } else if (c == '{' || c == '[') {
+                skip_depth_ = 1;
+                skip_in_string_ = false;
+                skip_escape_ = false;
+                state_ = State::Skip;
+            } else if (c == '-' || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z')) {
+                append(c, value_, JSON_PARSER_MAX_VALUE_LEN, value_len_, value_truncated_);
+                state_ = State::Literal;
+            } else {
+                return fail("Expected value");
+            }
+            return true;
+
+        case State::String:
+            switch (stringChar(c, value_, JSON_PARSER_MAX_VALUE_LEN, value_len_,
+                               value_truncated_)) {
+                case StringStep::Closed:
+                    state_ = State::CommaOrEnd;
+                    return emit(JsonValueType::String);
+                case StringStep::Invalid:
+                    return fail("Invalid string");
+                default:
+                    return true;
+            }
+
+        case State::Literal:
+            if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                c == '.' || c == '+' || c == '-') {
+                append(c, value_, JSON_PARSER_MAX_VALUE_LEN, value_len_, value_truncated_);
+                return true;
+            }
+            state_ = State::CommaOrEnd;
+            if (!emitLiteral()) return false;
+            return step(c);  // The delimiter belongs to the next state
+
+        case State::Skip:
+            if (skip_in_string_) {
+                if (skip_escape_) {
+                    skip_escape_ = false;
+                } else if (c == '\\') {
+                    skip_escape_ = true;
+                } else if (c == '"') {
+                    skip_in_string_ = false;
+                }
+                return true;
+            }
+            if (c == '"') {
+                skip_in_string_ = true;
+            } else if (c == '{' || c == '[') {
+                if (++skip_depth_ > JSON_PARSER_MAX_DEPTH) return fail("Nesting too deep");
+            } else if (c == '}' || c == ']') {
+                if (--skip_depth_ == 0) {
+                    state_ = State::CommaOrEnd;
+                    return emit(JsonValueType::Nested);
+                }
+            }
+            return true;
+
+        case State::CommaOrEnd:
+            if (isWhitespace(c)) return true;
+            if (c == ',') {
+                after_comma_ = true;
+                state_ = State::KeyOrEnd;
+                return true;
+            }
+            if (c == '}') {
+                state_ = State::Done;
+                return true;
+            }
+            return fail("Expected ',' or '}'");
+
+        case State::Done:
+            if (isWhitespace(c)) return true;
+            return fail("Trailing data");
+
+        case State::Error:
+        default:
+            return false;
+    }
+}
+
+JsonFieldBinder::JsonFieldBinder(const JsonFieldBinding* bindings, size_t count)
+    : bindings_(bindings), count_(count) {}
+
+bool JsonFieldBinder::onField(const char* key, const JsonValue& value) {
+    for (size_t i = 0; i < count_; i++) {
+        const JsonFieldBinding& binding = bindings_[i];
+        if (strcmp(binding.key, key) != 0) continue;
+
+        switch (binding.kind) {
+            case JsonFieldKind::NullableString:
+                if (value.type == JsonValueType::Null) {
+                    static_cast<char*>(binding.target)[0] = '\0';
+                    break;
+                }
+                [[fallthrough]];
+            case JsonFieldKind::String:
+                if (value.type != JsonValueType::String || value.truncated ||
+                    value.len >= binding.capacity || memchr(value.text, '\0', value.len)) {
+                    invalid_key_ = binding.key;
+                    return false;
+                }
+                memcpy(binding.target, value.text, value.len + 1);
+                break;
+            case JsonFieldKind::Bool:
+                if (value.type != JsonValueType::Bool) return true;
+                *static_cast<bool*>(binding.target) = value.text[0] == 't';
+                break;
+        }
+
+        if (i < 32) set_mask_ |= 1u << i;
+        return true;
+    }
+    return true;
+}
+
+bool JsonFieldBinder::wasSet(size_t index) const {
+    return index < 32 && (set_mask_ & (1u << index));
+}
+
+const char* JsonFieldBinder::invalidKey() const {
+    return invalid_key_;
+}
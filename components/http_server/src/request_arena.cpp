@@ -0,0 +1,78 @@
+#include "request_arena.hpp"
+
+#include <cstdlib>
+#include <new>
+
+void* RequestArena::alloc(size_t size, size_t align) {
+    uintptr_t start = reinterpret_cast<uintptr_t>(base_) + used_;
+    size_t padding = (align - start % align) % align;
+    if (padding > capacity_ - used_ || size > capacity_ - used_ - padding) return nullptr;
+
+    void* ptr = base_ + used_ + padding;
+    used_ += padding + size;
+    if (used_ > high_water_) high_water_ = used_;
+    return ptr;
+}
+
+RequestArenaPool::~RequestArenaPool() {
+    deinit();
+}
+
+bool RequestArenaPool::init(size_t count, size_t arena_size) {
+    deinit();
+
+    // Arenas start max_align_t aligned, so the first alloc() never pads
+    arena_size = (arena_size + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+    arenas_ = new (std::nothrow) RequestArena[count];
+    storage_ = static_cast<uint8_t*>(malloc(count * arena_size));
+    if (!arenas_ || !storage_) {
+        deinit();
+        return false;
+    }
+
+    count_ = count;
+    arena_size_ = arena_size;
+    for (size_t i = count; i-- > 0;) {
+        RequestArena& arena = arenas_[i];
+        arena.base_ = storage_ + i * arena_size;
+        arena.capacity_ = arena_size;
+        arena.pool_ = this;
+        arena.next_free_ = free_;
+        free_ = &arena;
+    }
+    return true;
+}
+
+void RequestArenaPool::deinit() {
+    delete[] arenas_;
+    free(storage_);
+    arenas_ = nullptr;
+    storage_ = nullptr;
+    free_ = nullptr;
+    count_ = 0;
+    arena_size_ = 0;
+    in_use_ = 0;
+    peak_in_use_ = 0;
+}
+
+RequestArena* RequestArenaPool::acquire() {
+    RequestArena* arena = free_;
+    if (!arena) return nullptr;
+
+    free_ = arena->next_free_;
+    arena->next_free_ = nullptr;
+    if (++in_use_ > peak_in_use_) peak_in_use_ = in_use_;
+    return arena;
+}
+
+void RequestArenaPool::release(RequestArena* arena) {
+    arena->reset();
+    arena->next_free_ = free_;
+    free_ = arena;
+    in_use_--;
+}
+
+void RequestArenaPool::releaseContext(void* arena) {
+    auto* owned = static_cast<RequestArena*>(arena);
+    owned->pool_->release(owned);
+}
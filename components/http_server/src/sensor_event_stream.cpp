@@ -0,0 +1,244 @@
+#include "sensor_event_stream.hpp"
+
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include "esp_log.h"
+#include "json_writer.hpp"
+#include "sensor_manager.hpp"
+
+static const char* TAG = "sensor_stream";
+
+constexpr uint32_t STREAM_TASK_STACK = 4096;
+constexpr UBaseType_t STREAM_TASK_PRIORITY = 4;  // Below the httpd task
+constexpr uint32_t STOP_TIMEOUT_MS = 1000;
+constexpr size_t EVENT_DATA_SIZE = 96;
+constexpr size_t EVENT_FRAME_SIZE = 160;
+constexpr uint32_t BACKLOG_RETRY_MS = 50;  // Poll interval while a socket refuses data
+
+static_assert(CONFIG_HTTP_SERVER_SSE_MAX_SUBSCRIBERS <= CONFIG_SENSOR_NOTIFIER_MAX_SUBSCRIBERS,
+              "Every stream needs a notifier subscription");
+
+esp_err_t SensorEventStream::start() {
+    if (task_) return ESP_ERR_INVALID_STATE;
+
+    // Sized to the subscriber cap, so a slot reserved by accept() always fits
+    if (!pending_) {
+        pending_ = xQueueCreate(CONFIG_HTTP_SERVER_SSE_MAX_SUBSCRIBERS, sizeof(httpd_req_t*));
+    }
+    if (!pending_) return ESP_ERR_NO_MEM;
+
+    running_ = true;
+    TaskHandle_t task = nullptr;
+    if (xTaskCreate(streamTask, "sse_stream_task", STREAM_TASK_STACK, this, STREAM_TASK_PRIORITY,
+                    &task) != pdPASS) {
+        running_ = false;
+        return ESP_ERR_NO_MEM;
+    }
+    task_ = task;
+    return ESP_OK;
+}
+
+void SensorEventStream::stop() {
+    if (!task_) return;
+
+    running_ = false;
+    xTaskNotifyGive(task_);
+
+    // The task clears task_ once every stream is closed
+    for (uint32_t waited = 0; task_ && waited < STOP_TIMEOUT_MS; waited += 10) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+esp_err_t SensorEventStream::accept(httpd_req_t* req) {
+    size_t reserved = reserved_.fetch_add(1, std::memory_order_acq_rel);
+    if (!running_ || reserved >= CONFIG_HTTP_SERVER_SSE_MAX_SUBSCRIBERS) {
+        reserved_.fetch_sub(1, std::memory_order_acq_rel);
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "10");
+        return httpd_resp_sendstr(req, "Too many event streams");
+    }
+
+    httpd_req_t* async = nullptr;
+    if (httpd_req_async_handler_begin(req, &async) != ESP_OK) {
+        reserved_.fetch_sub(1, std::memory_order_acq_rel);
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Stream unavailable");
+    }
+
+    xQueueSend(pending_, &async, 0);
+    xTaskNotifyGive(task_);
+    return ESP_OK;
+}
+
+void SensorEventStream::streamTask(void* arg) {
+    static_cast<SensorEventStream*>(arg)->run();
+}
+
+void SensorEventStream::run() {
+    const TickType_t keepalive = pdMS_TO_TICKS(CONFIG_HTTP_SERVER_SSE_KEEPALIVE_MS);
+    httpd_req_t* req = nullptr;
+    bool backlogged = false;
+
+    while (running_) {
+        // Woken by the notifier for every sample, by accept(), or for keep-alives
+        ulTaskNotifyTake(pdTRUE, backlogged ? pdMS_TO_TICKS(BACKLOG_RETRY_MS) : keepalive);
+
+        while (xQueueReceive(pending_, &req, 0) == pdTRUE) adopt(req);
+
+        TickType_t now = xTaskGetTickCount();
+        backlogged = false;
+        for (Subscriber& subscriber : subscribers_) {
+            if (!subscriber.req) continue;
+
+            // Finish what the socket refused last time before taking new events
+            bool ok = flush(subscriber, now);
+            while (ok && subscriber.out_len == 0 && fill(subscriber, now)) {
+                ok = flush(subscriber, now);
+            }
+
+            if (ok && subscriber.out_len > 0 && now - subscriber.last_send >= keepalive) {
+                ESP_LOGW(TAG, "Stream stalled for %u ms, dropping it",
+                         (unsigned)CONFIG_HTTP_SERVER_SSE_KEEPALIVE_MS);
+                ok = false;
+            }
+
+            if (!ok) {
+                close(subscriber);
+            } else if (subscriber.out_len > 0) {
+                backlogged = true;
+            }
+        }
+    }
+
+    for (Subscriber& subscriber : subscribers_) {
+        if (subscriber.req) close(subscriber);
+    }
+    while (xQueueReceive(pending_, &req, 0) == pdTRUE) release(req);
+
+    task_ = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void SensorEventStream::adopt(httpd_req_t* req) {
+    Subscriber* slot = nullptr;
+    for (Subscriber& subscriber : subscribers_) {
+        if (!subscriber.req) {
+            slot = &subscriber;
+            break;
+        }
+    }
+
+    QueueHandle_t events = nullptr;
+    if (slot) events = DS18B20SensorManager::getNotifier().subscribe(xTaskGetCurrentTaskHandle());
+    if (!events) {
+        ESP_LOGW(TAG, "No notifier subscription left for a new stream");
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_sendstr(req, "Too many event streams");
+        release(req);
+        return;
+    }
+
+    *slot = {req, httpd_req_to_sockfd(req), events, xTaskGetTickCount(), 0, 0, 0, {}};
+
+    // The stream is written to the socket directly, so the head is ours to send.
+    // The body runs until the connection closes. After the reconnect hint, fill()
+    // replays the current samples so the client has values at once.
+    static const char HEAD[] =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/event-stream\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Connection: close\r\n"
+        "\r\n"
+        "retry: 5000\n\n";
+    append(*slot, HEAD, sizeof(HEAD) - 1);
+    ESP_LOGI(TAG, "Stream opened (%u active)", (unsigned)reserved_.load());
+}
+
+void SensorEventStream::close(Subscriber& subscriber) {
+    DS18B20SensorManager::getNotifier().unsubscribe(subscriber.events);
+    release(subscriber.req);
+    subscriber = {};
+    ESP_LOGI(TAG, "Stream closed (%u active)", (unsigned)reserved_.load());
+}
+
+void SensorEventStream::release(httpd_req_t* req) {
+    httpd_handle_t server = req->handle;
+    int fd = httpd_req_to_sockfd(req);
+    httpd_req_async_handler_complete(req);
+    httpd_sess_trigger_close(server, fd);
+    reserved_.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+bool SensorEventStream::fill(Subscriber& subscriber, TickType_t now) {
+    // Take events only while a whole frame fits; the rest wait in the notifier
+    // queue, which drops this client's oldest ones if it stays behind
+    while (subscriber.out_len + EVENT_FRAME_SIZE <= SEND_BUFFER_SIZE) {
+        SensorEvent event;
+        if (subscriber.replay < DS18B20SensorManager::getSensorCount()) {
+            event = {subscriber.replay, DS18B20SensorManager::getSnapshot(subscriber.replay)};
+            subscriber.replay++;
+        } else if (xQueueReceive(subscriber.events, &event, 0) != pdTRUE) {
+            break;
+        }
+        appendEvent(subscriber, event);
+    }
+
+    // A comment line keeps idle proxies open and surfaces dead clients
+    if (subscriber.out_len == 0 &&
+        now - subscriber.last_send >= pdMS_TO_TICKS(CONFIG_HTTP_SERVER_SSE_KEEPALIVE_MS)) {
+        static const char KEEPALIVE[] = ": keepalive\n\n";
+        append(subscriber, KEEPALIVE, sizeof(KEEPALIVE) - 1);
+    }
+    return subscriber.out_len > 0;
+}
+
+bool SensorEventStream::appendEvent(Subscriber& subscriber, const SensorEvent& event) {
+    char data[EVENT_DATA_SIZE];
+    JsonWriter json(data, sizeof(data));
+    json.beginObject()
+        .field("sensor", event.sensor)
+        .field("temperature", event.snapshot.temperature)
+        .field("ok", event.snapshot.ok)
+        .field("timestamp_us", event.snapshot.timestamp_us)
+        .endObject();
+
+    // The id lets a client spot samples dropped while it was behind
+    char frame[EVENT_FRAME_SIZE];
+    int len = snprintf(frame, sizeof(frame), "id: %u.%lu\nevent: temperature\ndata: %s\n\n",
+                       event.sensor, static_cast<unsigned long>(event.snapshot.sequence), data);
+    if (!json.ok() || len < 0 || static_cast<size_t>(len) >= sizeof(frame)) {
+        ESP_LOGE(TAG, "Event for sensor %u does not fit", event.sensor);
+        return false;
+    }
+
+    return append(subscriber, frame, len);
+}
+
+bool SensorEventStream::append(Subscriber& subscriber, const char* data, size_t len) {
+    if (len > SEND_BUFFER_SIZE - subscriber.out_len) return false;
+    memcpy(subscriber.out + subscriber.out_len, data, len);
+    subscriber.out_len += len;
+    return true;
+}
+
+bool SensorEventStream::flush(Subscriber& subscriber, TickType_t now) {
+    while (subscriber.out_sent < subscriber.out_len) {
+        // Straight to the socket: httpd_socket_send() would log a warning for every
+        // EAGAIN, which a slow client produces on each retry
+        ssize_t sent = send(subscriber.fd, subscriber.out + subscriber.out_sent,
+                            subscriber.out_len - subscriber.out_sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+
+        subscriber.out_sent += sent;
+        subscriber.last_send = now;
+    }
+    subscriber.out_len = 0;
+    subscriber.out_sent = 0;
+    return true;
+}
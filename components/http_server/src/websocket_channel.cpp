@@ -0,0 +1,327 @@
+#include "websocket_channel.hpp"
+
+#if CONFIG_HTTP_SERVER_WEBSOCKET
+
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "config_manager.hpp"
+#include "esp_log.h"
+#include "sensor_manager.hpp"
+#include "ws_protocol.hpp"
+
+static const char* TAG = "websocket";
+
+constexpr uint32_t WAKE_TASK_STACK = 2048;
+constexpr UBaseType_t WAKE_TASK_PRIORITY = 4;  // Below the httpd task
+constexpr uint32_t STOP_TIMEOUT_MS = 1000;
+constexpr uint32_t BACKLOG_RETRY_MS = 50;   // Flush interval while a client has unsent bytes
+constexpr uint32_t CLIENT_STALL_MS = 5000;  // httpd's default send_wait_timeout
+constexpr size_t SAMPLES_FRAME_MAX_LEN =
+    WS_FRAME_HEADER_LEN + WS_MAX_SAMPLES_PER_FRAME * WS_SAMPLE_RECORD_LEN;
+
+static_assert(CONFIG_HTTP_SERVER_SSE_MAX_SUBSCRIBERS + 1 <= CONFIG_SENSOR_NOTIFIER_MAX_SUBSCRIBERS,
+              "The WebSocket broadcaster needs its own notifier subscription");
+static_assert(SENSOR_MAX_COUNT <= WS_MAX_SAMPLES_PER_FRAME,
+              "Current samples are sent to a new client in a single frame");
+
+static WsSample toWsSample(uint8_t sensor, const SensorSnapshot& snapshot) {
+    return {sensor, snapshot.ok, snapshot.temperature, static_cast<uint16_t>(snapshot.sequence)};
+}
+
+// Copies a length-prefixed string into a fixed char array; embedded NULs and
+// values that leave no room for the terminator are rejected.
+static bool copyText(const WsText& text, char* dst, size_t cap) {
+    if (text.len >= cap || memchr(text.data, '\0', text.len)) return false;
+    memcpy(dst, text.data, text.len);
+    dst[text.len] = '\0';
+    return true;
+}
+
+static WsStatus applyCommand(const WsCommand& cmd) {
+    ConfigManager& config = ConfigManager::getInstance();
+
+    switch (cmd.type) {
+        case WsFrameType::SetDeviceName: {
+            DeviceInfo info = config.getDeviceInfo();
+            if (!copyText(cmd.name, info.device_name, sizeof(info.device_name))) {
+                return WsStatus::Invalid;
+            }
+            config.updateDeviceInfo(info);
+            return WsStatus::Ok;
+        }
+        case WsFrameType::SetApConfig: {
+            NetworkConfig network = config.getNetworkConfig();
+            if ((cmd.ap_flags & WS_AP_HAS_SSID) &&
+                !copyText(cmd.ssid, network.ap_ssid, sizeof(network.ap_ssid))) {
+                return WsStatus::Invalid;
+            }
+            if ((cmd.ap_flags & WS_AP_HAS_PASSWORD) &&
+                !copyText(cmd.password, network.ap_password, sizeof(network.ap_password))) {
+                return WsStatus::Invalid;
+            }
+            if (cmd.ap_flags & WS_AP_HAS_ENABLED) {
+                network.ap_enabled = cmd.ap_flags & WS_AP_ENABLED;
+            }
+            config.updateNetworkConfig(network);
+            return WsStatus::Ok;
+        }
+        default:
+            return WsStatus::Unsupported;
+    }
+}
+
+WebSocketChannel::WebSocketChannel() {
+    for (Client& client : clients_) client = {-1, 0, 0, 0, {}};
+}
+
+esp_err_t WebSocketChannel::start(httpd_handle_t server) {
+    if (task_) return ESP_ERR_INVALID_STATE;
+
+    server_ = server;
+    running_ = true;
+    TaskHandle_t task = nullptr;
+    if (xTaskCreate(wakeTask, "ws_wake_task", WAKE_TASK_STACK, this, WAKE_TASK_PRIORITY, &task) !=
+        pdPASS) {
+        running_ = false;
+        return ESP_ERR_NO_MEM;
+    }
+    task_ = task;
+
+    events_ = DS18B20SensorManager::getNotifier().subscribe(task);
+    if (!events_.load()) ESP_LOGW(TAG, "No notifier subscription; /ws will not push samples");
+    return ESP_OK;
+}
+
+void WebSocketChannel::stop() {
+    if (!task_) return;
+
+    running_ = false;
+    xTaskNotifyGive(task_);
+
+    // Queued behind any pending broadcast, so the subscription is never freed under it
+    if (events_.load() && httpd_queue_work(server_, releaseWork, this) == ESP_OK) {
+        for (uint32_t waited = 0; events_.load() && waited < STOP_TIMEOUT_MS; waited += 10) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+    }
+}
+
+void WebSocketChannel::wakeTask(void* arg) {
+    static_cast<WebSocketChannel*>(arg)->run();
+}
+
+void WebSocketChannel::run() {
+    while (running_) {
+        // A backlogged client is retried even when no new samples arrive
+        ulTaskNotifyTake(pdTRUE, backlogged_ ? pdMS_TO_TICKS(BACKLOG_RETRY_MS) : portMAX_DELAY);
+        if (!running_) break;
+
+        // One queued broadcast drains everything that arrived before it runs
+        if (broadcast_queued_.exchange(true)) continue;
+        if (httpd_queue_work(server_, broadcastWork, this) != ESP_OK) broadcast_queued_ = false;
+    }
+
+    task_ = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void WebSocketChannel::broadcastWork(void* arg) {
+    static_cast<WebSocketChannel*>(arg)->broadcast();
+}
+
+void WebSocketChannel::releaseWork(void* arg) {
+    auto* self = static_cast<WebSocketChannel*>(arg);
+    DS18B20SensorManager::getNotifier().unsubscribe(self->events_.exchange(nullptr));
+}
+
+void WebSocketChannel::broadcast() {
+    broadcast_queued_ = false;
+    QueueHandle_t events = events_.load();
+    if (!events) return;
+
+    WsSample samples[WS_MAX_SAMPLES_PER_FRAME];
+    uint8_t payload[SAMPLES_FRAME_MAX_LEN];
+
+    while (true) {
+        size_t count = 0;
+        SensorEvent event;
+        while (count < WS_MAX_SAMPLES_PER_FRAME && xQueueReceive(events, &event, 0) == pdTRUE) {
+            samples[count++] = toWsSample(event.sensor, event.snapshot);
+        }
+        if (count == 0) break;
+
+        size_t len = wsEncodeSamples(samples, count, payload, sizeof(payload));
+        for (Client& client : clients_) {
+            if (client.fd < 0) continue;
+
+            // Sockets closed by the peer or by httpd simply stop being WebSocket clients
+            if (httpd_ws_get_fd_info(server_, client.fd) != HTTPD_WS_CLIENT_WEBSOCKET) {
+                client = {-1, 0, 0, 0, {}};
+                continue;
+            }
+
+            // A client that is this far behind misses the frame
+            appendFrame(client, payload, len);
+        }
+    }
+
+    TickType_t now = xTaskGetTickCount();
+    bool backlogged = false;
+    for (Client& client : clients_) {
+        if (client.fd < 0) continue;
+
+        if (!flush(client, now)) {
+            ESP_LOGW(TAG, "Dropping client on fd %d", client.fd);
+            dropClient(client);
+        } else if (client.out_len > 0 && now - client.last_send >= pdMS_TO_TICKS(CLIENT_STALL_MS)) {
+            ESP_LOGW(TAG, "Client on fd %d stalled, dropping it", client.fd);
+            dropClient(client);
+        } else if (client.out_len > 0) {
+            backlogged = true;
+        }
+    }
+
+    // Wake the task so its next wait uses the retry interval
+    TaskHandle_t task = task_;
+    if (backlogged && !backlogged_.exchange(true) && task) xTaskNotifyGive(task);
+    if (!backlogged) backlogged_ = false;
+}
+
+WebSocketChannel::Client* WebSocketChannel::addClient(int fd) {
+    Client* free_slot = nullptr;
+    for (Client& client : clients_) {
+        if (client.fd == fd) return &client;
+        if (client.fd >= 0 &&
+            httpd_ws_get_fd_info(server_, client.fd) != HTTPD_WS_CLIENT_WEBSOCKET) {
+            client = {-1, 0, 0, 0, {}};
+        }
+        if (client.fd < 0 && !free_slot) free_slot = &client;
+    }
+
+    if (!free_slot) return nullptr;
+    *free_slot = {fd, xTaskGetTickCount(), 0, 0, {}};
+    return free_slot;
+}
+
+WebSocketChannel::Client* WebSocketChannel::findClient(int fd) {
+    for (Client& client : clients_) {
+        if (client.fd == fd) return &client;
+    }
+    return nullptr;
+}
+
+void WebSocketChannel::dropClient(Client& client) {
+    httpd_sess_trigger_close(server_, client.fd);
+    client = {-1, 0, 0, 0, {}};
+}
+
+bool WebSocketChannel::appendFrame(Client& client, const uint8_t* payload, size_t len) {
+    // Server frames are unmasked: FIN and opcode, then a 7-bit or 16-bit length
+    uint8_t header[4] = {static_cast<uint8_t>(0x80 | HTTPD_WS_TYPE_BINARY)};
+    size_t header_len = 2;
+    if (len < 126) {
+        header[1] = static_cast<uint8_t>(len);
+    } else {
+        header[1] = 126;
+        header[2] = static_cast<uint8_t>(len >> 8);
+        header[3] = static_cast<uint8_t>(len);
+        header_len = 4;
+    }
+
+    if (header_len + len > SEND_BUFFER_SIZE - client.out_len) return false;
+    memcpy(client.out + client.out_len, header, header_len);
+    memcpy(client.out + client.out_len + header_len, payload, len);
+    client.out_len += header_len + len;
+    return true;
+}
+
+bool WebSocketChannel::flush(Client& client, TickType_t now) {
+    while (client.out_sent < client.out_len) {
+        // Straight to the socket, as httpd_ws_send_frame_async() blocks on a full one
+        ssize_t sent = send(client.fd, client.out + client.out_sent,
+                            client.out_len - client.out_sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+
+        client.out_sent += sent;
+        client.last_send = now;
+    }
+    client.out_len = 0;
+    client.out_sent = 0;
+    return true;
+}
+
+esp_err_t WebSocketChannel::handle(httpd_req_t* req) {
+    if (req->method == HTTP_GET) {
+        // httpd has already completed the handshake
+        Client* client = addClient(httpd_req_to_sockfd(req));
+        if (!client) {
+            ESP_LOGW(TAG, "Client limit (%d) reached", WS_MAX_CLIENTS);
+            return ESP_FAIL;  // Closes the socket
+        }
+        return sendCurrentSamples(*client);
+    }
+
+    // Replies share the client's buffer so they never interleave with a broadcast
+    Client* client = findClient(httpd_req_to_sockfd(req));
+    if (!client) return ESP_FAIL;
+
+    httpd_ws_frame_t frame = {};
+    esp_err_t err = httpd_ws_recv_frame(req, &frame, 0);  // Length only
+    if (err != ESP_OK) return err;
+
+    // Only binary commands are defined; a frame we cannot buffer ends the session
+    if (frame.len > WS_MAX_COMMAND_LEN) return ESP_FAIL;
+
+    uint8_t data[WS_MAX_COMMAND_LEN];
+    frame.payload = data;
+    err = httpd_ws_recv_frame(req, &frame, frame.len);
+    if (err != ESP_OK) return err;
+    if (frame.type != HTTPD_WS_TYPE_BINARY) return ESP_OK;
+
+    return handleCommand(*client, data, frame.len);
+}
+
+esp_err_t WebSocketChannel::handleCommand(Client& client, const uint8_t* data, size_t len) {
+    uint8_t type = len > 0 ? data[0] : 0;
+
+    WsCommand cmd;
+    WsStatus status;
+    if (type != static_cast<uint8_t>(WsFrameType::SetDeviceName) &&
+        type != static_cast<uint8_t>(WsFrameType::SetApConfig)) {
+        status = WsStatus::Unsupported;
+    } else if (!wsDecodeCommand(data, len, cmd)) {
+        status = WsStatus::Invalid;
+    } else {
+        status = applyCommand(cmd);
+    }
+
+    uint8_t ack[3];
+    return sendFrame(client, ack, wsEncodeAck(type, status, ack, sizeof(ack)));
+}
+
+esp_err_t WebSocketChannel::sendFrame(Client& client, const uint8_t* payload, size_t len) {
+    if (!appendFrame(client, payload, len) || !flush(client, xTaskGetTickCount())) {
+        // Returning an error makes httpd close the session itself
+        client = {-1, 0, 0, 0, {}};
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t WebSocketChannel::sendCurrentSamples(Client& client) {
+    WsSample samples[WS_MAX_SAMPLES_PER_FRAME];
+    size_t count = DS18B20SensorManager::getSensorCount();
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = toWsSample(static_cast<uint8_t>(i), DS18B20SensorManager::getSnapshot(i));
+    }
+
+    uint8_t payload[SAMPLES_FRAME_MAX_LEN];
+    return sendFrame(client, payload, wsEncodeSamples(samples, count, payload, sizeof(payload)));
+}
+
+#endif  // CONFIG_HTTP_SERVER_WEBSOCKET
@@ -0,0 +1,85 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "cJSON.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "json_writer.hpp"
+#include "unity.h"
+
+static constexpr int BENCH_ITERATIONS = 1000;
+
+static int alloc_count = 0;
+
+static void* countingMalloc(size_t size) {
+    alloc_count++;
+    return malloc(size);
+}
+
+/// @brief Same payload as GET /api/network/status with a filled-in config.
+static size_t renderCJson() {
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "ap_ssid", "ESP32_default_AP");
+    cJSON_AddBoolToObject(root, "ap_enabled", true);
+    cJSON_AddStringToObject(root, "ap_password", "password123");
+    cJSON_AddBoolToObject(root, "sta_enabled", true);
+    cJSON_AddStringToObject(root, "ssid", "HomeNetwork");
+    cJSON_AddStringToObject(root, "bssid", "AA:BB:CC:DD:EE:FF");
+    cJSON_AddNumberToObject(root, "channel", 6);
+    cJSON_AddStringToObject(root, "ip_address", "192.168.1.100");
+    cJSON_AddStringToObject(root, "mac_address", "FF:EE:DD:CC:BB:AA");
+
+    char* resp = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    size_t len = strlen(resp);
+    cJSON_free(resp);
+    return len;
+}
+
+static size_t renderJsonWriter() {
+    char buf[512];
+    JsonWriter json(buf, sizeof(buf));
+    json.beginObject()
+        .field("ap_ssid", "ESP32_default_AP")
+        .field("ap_enabled", true)
+        .field("ap_password", "password123")
+        .field("sta_enabled", true)
+        .field("ssid", "HomeNetwork")
+        .field("bssid", "AA:BB:CC:DD:EE:FF")
+        .field("channel", static_cast<uint8_t>(6))
+        .field("ip_address", "192.168.1.100")
+        .field("mac_address", "FF:EE:DD:CC:BB:AA")
+        .endObject();
+    return json.length();
+}
+
+/// @brief Prints time per response for cJSON and JsonWriter, and cJSON's allocations.
+extern "C" void bench_json_writer_vs_cjson() {
+    cJSON_Hooks hooks = {countingMalloc, free};
+    cJSON_InitHooks(&hooks);
+
+    // Warm up so one-time newlib allocations (e.g. dtoa buffers) are not counted
+    TEST_ASSERT_EQUAL(renderCJson(), renderJsonWriter());
+
+    alloc_count = 0;
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) renderCJson();
+    int64_t cjson_us = esp_timer_get_time() - start;
+    int cjson_allocs = alloc_count;
+
+    size_t free_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    start = esp_timer_get_time();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) renderJsonWriter();
+    int64_t writer_us = esp_timer_get_time() - start;
+    size_t free_after = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+
+    cJSON_InitHooks(nullptr);
+
+    printf("cJSON:      %.2f us/request, %.1f allocations/request\n",
+           (double)cjson_us / BENCH_ITERATIONS, (double)cjson_allocs / BENCH_ITERATIONS);
+    printf("JsonWriter: %.2f us/request\n", (double)writer_us / BENCH_ITERATIONS);
+
+    // JsonWriter renders into the caller's buffer, so the heap must be untouched
+    TEST_ASSERT_EQUAL(free_before, free_after);
+}
@@ -0,0 +1,112 @@
+#include <stdio.h>
+
+#include "unity.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void setUp(void) {
+    // Set up before every test
+}
+
+void tearDown(void) {
+    // Clean up after every test
+}
+
+// JSON writer tests
+void test_json_writer_builds_nested_document();
+void test_json_writer_escapes_strings();
+void test_json_writer_formats_numbers();
+void test_json_writer_detects_overflow();
+
+// JSON stream parser tests
+void test_json_stream_parser_binds_fields_across_chunks();
+void test_json_stream_parser_rejects_invalid_fields();
+void test_json_stream_parser_rejects_malformed_input();
+
+// Response cache tests
+void test_response_cache_tracks_generation();
+void test_response_cache_matches_etag();
+
+// Request arena tests
+void test_request_arena_allocates_and_resets();
+void test_request_arena_pool_recycles_arenas();
+
+// WebSocket protocol tests
+void test_ws_protocol_round_trips_samples();
+void test_ws_protocol_decodes_commands();
+void test_ws_protocol_round_trips_ack();
+
+// Benchmarks
+void bench_json_writer_vs_cjson();
+
+#ifdef __cplusplus
+}
+#endif
+
+TEST_CASE("JsonWriter: Builds nested document", "[json]") {
+    test_json_writer_builds_nested_document();
+}
+
+TEST_CASE("JsonWriter: Escapes strings", "[json]") {
+    test_json_writer_escapes_strings();
+}
+
+TEST_CASE("JsonWriter: Formats numbers", "[json]") {
+    test_json_writer_formats_numbers();
+}
+
+TEST_CASE("JsonWriter: Detects overflow", "[json]") {
+    test_json_writer_detects_overflow();
+}
+
+TEST_CASE("JsonStreamParser: Binds fields across chunks", "[json]") {
+    test_json_stream_parser_binds_fields_across_chunks();
+}
+
+TEST_CASE("JsonStreamParser: Rejects invalid fields", "[json]") {
+    test_json_stream_parser_rejects_invalid_fields();
+}
+
+TEST_CASE("JsonStreamParser: Rejects malformed input", "[json]") {
+    test_json_stream_parser_rejects_malformed_input();
+}
+
+TEST_CASE("ResponseCache: Tracks generation", "[cache]") {
+    test_response_cache_tracks_generation();
+}
+
+TEST_CASE("ResponseCache: Matches ETag", "[cache]") {
+    test_response_cache_matches_etag();
+}
+
+TEST_CASE("RequestArena: Allocates and resets", "[arena]") {
+    test_request_arena_allocates_and_resets();
+}
+
+TEST_CASE("RequestArena: Pool recycles arenas", "[arena]") {
+    test_request_arena_pool_recycles_arenas();
+}
+
+TEST_CASE("WsProtocol: Round-trips samples", "[ws]") {
+    test_ws_protocol_round_trips_samples();
+}
+
+TEST_CASE("WsProtocol: Decodes commands", "[ws]") {
+    test_ws_protocol_decodes_commands();
+}
+
+TEST_CASE("WsProtocol: Round-trips ack", "[ws]") {
+    test_ws_protocol_round_trips_ack();
+}
+
+TEST_CASE("Bench: JsonWriter vs cJSON per request", "[bench]") {
+    bench_json_writer_vs_cjson();
+}
+
+void app_main(void) {
+    UNITY_BEGIN();
+    unity_run_all_tests();
+    UNITY_END();
+}
@@ -0,0 +1,103 @@
+#include <cstring>
+
+#include "json_stream_parser.hpp"
+#include "unity.h"
+
+namespace {
+
+struct TestTarget {
+    char name[16];
+    char secret[8];
+    bool enabled;
+};
+
+constexpr size_t FIELD_COUNT = 3;
+
+void bindTarget(TestTarget& target, JsonFieldBinding (&fields)[FIELD_COUNT]) {
+    fields[0] = {"name", JsonFieldKind::String, target.name, sizeof(target.name)};
+    fields[1] = {"secret", JsonFieldKind::NullableString, target.secret, sizeof(target.secret)};
+    fields[2] = {"enabled", JsonFieldKind::Bool, &target.enabled, 0};
+}
+
+bool parseInPieces(JsonFieldListener& listener, const char* json, size_t piece) {
+    JsonStreamParser parser(listener);
+    size_t len = strlen(json);
+    for (size_t i = 0; i < len; i += piece) {
+        size_t n = len - i < piece ? len - i : piece;
+        if (!parser.feed(json + i, n)) return false;
+    }
+    return parser.finish();
+}
+
+}  // namespace
+
+/// @brief Verifies that values land in bound fields however the input is split.
+extern "C" void test_json_stream_parser_binds_fields_across_chunks() {
+    const char* json =
+        "{ \"name\" : \"esp\\u00e9 \\\"32\\\"\", \"skip\": [1, {\"x\": \"]}\"}], "
+        "\"count\": -1.5e3, \"enabled\": true, \"secret\": null }";
+
+    for (size_t piece = 1; piece <= strlen(json); piece++) {
+        TestTarget target = {"old", "pw", false};
+        JsonFieldBinding fields[FIELD_COUNT];
+        bindTarget(target, fields);
+        JsonFieldBinder binder(fields, FIELD_COUNT);
+
+        TEST_ASSERT_TRUE(parseInPieces(binder, json, piece));
+        TEST_ASSERT_EQUAL_STRING("esp\xc3\xa9 \"32\"", target.name);
+        TEST_ASSERT_EQUAL_STRING("", target.secret);
+        TEST_ASSERT_TRUE(target.enabled);
+        TEST_ASSERT_TRUE(binder.wasSet(0));
+        TEST_ASSERT_TRUE(binder.wasSet(1));
+        TEST_ASSERT_TRUE(binder.wasSet(2));
+    }
+}
+
+/// @brief Verifies that wrong types and values too long for a field are rejected by key.
+extern "C" void test_json_stream_parser_rejects_invalid_fields() {
+    TestTarget target = {"old", "pw", false};
+    JsonFieldBinding fields[FIELD_COUNT];
+    bindTarget(target, fields);
+
+    JsonFieldBinder too_long(fields, FIELD_COUNT);
+    TEST_ASSERT_FALSE(parseInPieces(too_long, "{\"secret\":\"12345678\"}", 4));
+    TEST_ASSERT_EQUAL_STRING("secret", too_long.invalidKey());
+    TEST_ASSERT_EQUAL_STRING("pw", target.secret);
+
+    JsonFieldBinder wrong_type(fields, FIELD_COUNT);
+    TEST_ASSERT_FALSE(parseInPieces(wrong_type, "{\"name\":42}", 4));
+    TEST_ASSERT_EQUAL_STRING("name", wrong_type.invalidKey());
+    TEST_ASSERT_EQUAL_STRING("old", target.name);
+
+    // Bool bindings ignore values of other types
+    JsonFieldBinder ignored(fields, FIELD_COUNT);
+    TEST_ASSERT_TRUE(parseInPieces(ignored, "{\"enabled\":\"yes\"}", 4));
+    TEST_ASSERT_FALSE(ignored.wasSet(2));
+    TEST_ASSERT_NULL(ignored.invalidKey());
+}
+
+/// @brief Verifies that malformed documents are rejected.
+extern "C" void test_json_stream_parser_rejects_malformed_input() {
+    const char* bad[] = {
+        "",
+        "[]",
+        "{\"name\"}",
+        "{\"name\":\"x\",}",
+        "{\"name\":\"x\"",
+        "{\"name\":tru}",
+        "{\"n\":01x}",
+        "{\"name\":\"a\nb\"}",
+        "{\"name\":\"\\q\"}",
+        "{} {}",
+        "{\"a\":[[[[[[[[[[[[[[[[[[]]]]]]]]]]]]]]]]]]}",
+    };
+
+    for (const char* json : bad) {
+        TestTarget target = {"old", "pw", false};
+        JsonFieldBinding fields[FIELD_COUNT];
+        bindTarget(target, fields);
+        JsonFieldBinder binder(fields, FIELD_COUNT);
+
+        TEST_ASSERT_FALSE_MESSAGE(parseInPieces(binder, json, 3), json);
+    }
+}
@@ -0,0 +1,64 @@
+#include <cstring>
+
+#include "json_writer.hpp"
+#include "unity.h"
+
+/// @brief Verifies commas and nesting for objects and arrays.
+extern "C" void test_json_writer_builds_nested_document() {
+    char buf[128];
+    JsonWriter json(buf, sizeof(buf));
+    json.beginObject()
+        .field("name", "esp32")
+        .field("ok", true)
+        .key("list")
+        .beginArray()
+        .value(1)
+        .value(-2)
+        .beginObject()
+        .endObject()
+        .endArray()
+        .key("none")
+        .null()
+        .endObject();
+
+    TEST_ASSERT_TRUE(json.ok());
+    TEST_ASSERT_EQUAL_STRING("{\"name\":\"esp32\",\"ok\":true,\"list\":[1,-2,{}],\"none\":null}",
+                             json.c_str());
+    TEST_ASSERT_EQUAL(strlen(buf), json.length());
+}
+
+/// @brief Verifies string escaping of quotes, backslashes and control characters.
+extern "C" void test_json_writer_escapes_strings() {
+    char buf[64];
+    JsonWriter json(buf, sizeof(buf));
+    json.value("a\"b\\c\n\x01");
+
+    TEST_ASSERT_TRUE(json.ok());
+    TEST_ASSERT_EQUAL_STRING("\"a\\\"b\\\\c\\n\\u0001\"", json.c_str());
+}
+
+/// @brief Verifies number formatting, including non-finite values.
+extern "C" void test_json_writer_formats_numbers() {
+    char buf[64];
+    JsonWriter json(buf, sizeof(buf));
+    json.beginArray().value(23.4375f).value(0.1).value(4294967295u).value(1.0 / 0.0).endArray();
+
+    TEST_ASSERT_TRUE(json.ok());
+    TEST_ASSERT_EQUAL_STRING("[23.4375,0.1,4294967295,null]", json.c_str());
+}
+
+/// @brief Verifies overflow is latched and the buffer stays terminated.
+extern "C" void test_json_writer_detects_overflow() {
+    char buf[16];
+    JsonWriter json(buf, sizeof(buf));
+    json.beginObject().field("device_name", "too-long-for-buffer").endObject();
+
+    TEST_ASSERT_FALSE(json.ok());
+    TEST_ASSERT_TRUE(json.overflowed());
+    TEST_ASSERT_LESS_THAN(sizeof(buf), strlen(buf));
+
+    json.reset();
+    json.beginObject().endObject();
+    TEST_ASSERT_TRUE(json.ok());
+    TEST_ASSERT_EQUAL_STRING("{}", json.c_str());
+}
@@ -0,0 +1,57 @@
+#include <cstdint>
+
+#include "request_arena.hpp"
+#include "unity.h"
+
+/// @brief Verifies aligned bump allocation, overflow and the O(1) reset.
+extern "C" void test_request_arena_allocates_and_resets() {
+    RequestArenaPool pool;
+    TEST_ASSERT_TRUE(pool.init(1, 256));
+    RequestArena* arena = pool.acquire();
+    TEST_ASSERT_NOT_NULL(arena);
+    TEST_ASSERT_EQUAL(256, arena->capacity());
+
+    char* text = arena->alloc<char>(3);
+    uint32_t* words = arena->alloc<uint32_t>(4);
+    TEST_ASSERT_NOT_NULL(text);
+    TEST_ASSERT_NOT_NULL(words);
+    TEST_ASSERT_EQUAL(0, reinterpret_cast<uintptr_t>(words) % alignof(uint32_t));
+    TEST_ASSERT_EQUAL(4 + 4 * sizeof(uint32_t), arena->used());
+
+    // What does not fit fails without disturbing what is in use
+    size_t used = arena->used();
+    TEST_ASSERT_NULL(arena->alloc<char>(256));
+    TEST_ASSERT_NULL(arena->alloc<uint32_t>(SIZE_MAX / 2));
+    TEST_ASSERT_EQUAL(used, arena->used());
+    TEST_ASSERT_NOT_NULL(arena->alloc<char>(256 - used));
+
+    arena->reset();
+    TEST_ASSERT_EQUAL(0, arena->used());
+    TEST_ASSERT_EQUAL(256, arena->highWater());
+    TEST_ASSERT_EQUAL_PTR(text, arena->alloc<char>(1));
+}
+
+/// @brief Verifies that the pool hands out each arena once and takes them back reset.
+extern "C" void test_request_arena_pool_recycles_arenas() {
+    RequestArenaPool pool;
+    TEST_ASSERT_TRUE(pool.init(2, 100));
+    TEST_ASSERT_EQUAL(0, pool.arenaSize() % alignof(max_align_t));
+
+    RequestArena* first = pool.acquire();
+    RequestArena* second = pool.acquire();
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_NOT_NULL(second);
+    TEST_ASSERT_TRUE(first != second);
+    TEST_ASSERT_NULL(pool.acquire());
+    TEST_ASSERT_EQUAL(2, pool.inUse());
+
+    // Released as httpd would when the session closes
+    first->alloc<char>(10);
+    RequestArenaPool::releaseContext(first);
+    TEST_ASSERT_EQUAL(1, pool.inUse());
+    TEST_ASSERT_EQUAL(2, pool.peakInUse());
+
+    RequestArena* again = pool.acquire();
+    TEST_ASSERT_EQUAL_PTR(first, again);
+    TEST_ASSERT_EQUAL(0, again->used());
+}
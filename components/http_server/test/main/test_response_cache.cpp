@@ -0,0 +1,50 @@
+#include <cstring>
+
+#include "response_cache.hpp"
+#include "unity.h"
+
+static void render(ResponseCache& cache, uint32_t generation, const char* body) {
+    strcpy(cache.buffer(), body);
+    cache.commit(generation, strlen(body));
+}
+
+/// @brief Verifies that an entry is only fresh for the generation it was rendered from.
+extern "C" void test_response_cache_tracks_generation() {
+    ResponseCache cache;
+    TEST_ASSERT_FALSE(cache.fresh(0));
+
+    render(cache, 7, "{\"a\":1}");
+    TEST_ASSERT_TRUE(cache.fresh(7));
+    TEST_ASSERT_FALSE(cache.fresh(8));
+    TEST_ASSERT_EQUAL_STRING("{\"a\":1}", cache.body());
+    TEST_ASSERT_EQUAL(7, cache.length());
+
+    // Starting a render invalidates the entry until it is committed again
+    cache.buffer();
+    TEST_ASSERT_FALSE(cache.fresh(7));
+}
+
+/// @brief Verifies ETag derivation and If-None-Match matching.
+extern "C" void test_response_cache_matches_etag() {
+    ResponseCache cache;
+    render(cache, 1, "{\"a\":1}");
+
+    char etag[16];
+    strcpy(etag, cache.etag());
+    TEST_ASSERT_EQUAL(10, strlen(etag));
+    TEST_ASSERT_EQUAL('"', etag[0]);
+
+    // Same body under a new generation keeps the tag; a different body changes it
+    render(cache, 2, "{\"a\":1}");
+    TEST_ASSERT_EQUAL_STRING(etag, cache.etag());
+    render(cache, 3, "{\"a\":2}");
+    TEST_ASSERT_FALSE(strcmp(etag, cache.etag()) == 0);
+
+    char list[48];
+    snprintf(list, sizeof(list), "W/\"00000000\", %s", cache.etag());
+    TEST_ASSERT_TRUE(cache.matches(cache.etag()));
+    TEST_ASSERT_TRUE(cache.matches(list));
+    TEST_ASSERT_TRUE(cache.matches("*"));
+    TEST_ASSERT_FALSE(cache.matches(etag));
+    TEST_ASSERT_FALSE(cache.matches(""));
+}
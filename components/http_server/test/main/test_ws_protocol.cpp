@@ -0,0 +1,78 @@
+#include <cstring>
+
+#include "unity.h"
+#include "ws_protocol.hpp"
+
+/// @brief Verifies that sample frames round-trip and clamp out-of-range readings.
+extern "C" void test_ws_protocol_round_trips_samples() {
+    const WsSample samples[] = {
+        {0, true, 23.456f, 41},
+        {1, false, -12.5f, 65535},
+        {2, true, 1000.0f, 7},  // Beyond int16 centi-degrees
+    };
+    uint8_t frame[WS_FRAME_HEADER_LEN + 3 * WS_SAMPLE_RECORD_LEN];
+
+    size_t len = wsEncodeSamples(samples, 3, frame, sizeof(frame));
+    TEST_ASSERT_EQUAL(sizeof(frame), len);
+    TEST_ASSERT_EQUAL(0, wsEncodeSamples(samples, 3, frame, sizeof(frame) - 1));
+
+    WsSample decoded[4];
+    size_t count = 0;
+    TEST_ASSERT_TRUE(wsDecodeSamples(frame, len, decoded, 4, count));
+    TEST_ASSERT_EQUAL(3, count);
+    TEST_ASSERT_EQUAL(0, decoded[0].sensor);
+    TEST_ASSERT_TRUE(decoded[0].ok);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 23.46f, decoded[0].temperature);
+    TEST_ASSERT_EQUAL(41, decoded[0].sequence);
+    TEST_ASSERT_FALSE(decoded[1].ok);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, -12.5f, decoded[1].temperature);
+    TEST_ASSERT_EQUAL(65535, decoded[1].sequence);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 327.67f, decoded[2].temperature);
+
+    // A record count that disagrees with the frame length is rejected
+    TEST_ASSERT_FALSE(wsDecodeSamples(frame, len - 1, decoded, 4, count));
+    TEST_ASSERT_FALSE(wsDecodeSamples(frame, len, decoded, 2, count));
+}
+
+/// @brief Verifies command encoding and decoding, including malformed frames.
+extern "C" void test_ws_protocol_decodes_commands() {
+    uint8_t frame[WS_MAX_COMMAND_LEN];
+    WsCommand cmd;
+
+    size_t len = wsEncodeSetDeviceName("greenhouse", frame, sizeof(frame));
+    TEST_ASSERT_EQUAL(12, len);
+    TEST_ASSERT_TRUE(wsDecodeCommand(frame, len, cmd));
+    TEST_ASSERT_EQUAL(WsFrameType::SetDeviceName, cmd.type);
+    TEST_ASSERT_EQUAL(10, cmd.name.len);
+    TEST_ASSERT_EQUAL_MEMORY("greenhouse", cmd.name.data, 10);
+    TEST_ASSERT_FALSE(wsDecodeCommand(frame, len - 1, cmd));
+
+    len = wsEncodeSetApConfig("esp32-ap", nullptr, 0, frame, sizeof(frame));
+    TEST_ASSERT_TRUE(wsDecodeCommand(frame, len, cmd));
+    TEST_ASSERT_EQUAL(WsFrameType::SetApConfig, cmd.type);
+    TEST_ASSERT_EQUAL(WS_AP_HAS_SSID | WS_AP_HAS_ENABLED, cmd.ap_flags);
+    TEST_ASSERT_EQUAL_MEMORY("esp32-ap", cmd.ssid.data, cmd.ssid.len);
+    TEST_ASSERT_EQUAL(0, cmd.password.len);
+
+    // Trailing bytes, a length prefix past the end and unknown types are all rejected
+    frame[len] = 0;
+    TEST_ASSERT_FALSE(wsDecodeCommand(frame, len + 1, cmd));
+    frame[2] = 200;
+    TEST_ASSERT_FALSE(wsDecodeCommand(frame, len, cmd));
+    frame[0] = static_cast<uint8_t>(WsFrameType::Samples);
+    TEST_ASSERT_FALSE(wsDecodeCommand(frame, len, cmd));
+}
+
+/// @brief Verifies the Ack frame round-trip.
+extern "C" void test_ws_protocol_round_trips_ack() {
+    uint8_t frame[3];
+    TEST_ASSERT_EQUAL(0, wsEncodeAck(0x10, WsStatus::Ok, frame, 2));
+    TEST_ASSERT_EQUAL(3, wsEncodeAck(0x11, WsStatus::Invalid, frame, sizeof(frame)));
+
+    uint8_t command = 0;
+    WsStatus status = WsStatus::Ok;
+    TEST_ASSERT_TRUE(wsDecodeAck(frame, sizeof(frame), command, status));
+    TEST_ASSERT_EQUAL(0x11, command);
+    TEST_ASSERT_EQUAL(WsStatus::Invalid, status);
+    TEST_ASSERT_FALSE(wsDecodeAck(frame, 2, command, status));
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "metrics_writer.hpp"
+
+enum class MetricType : uint8_t {
+    Counter,
+    Gauge,
+    Histogram,
+};
+
+/**
+ * @brief Base of every exported metric.
+ *
+ * Metrics link themselves into one global list when published and are never
+ * unlinked, so they need static storage. Publishing and recording are
+ * lock-free. Metrics that share a name, one per label set, must be published
+ * back to back so their HELP/TYPE lines are written once.
+ *
+ * Values are 32-bit so that recording stays a single atomic add on the ESP32.
+ * A wrapped counter reads as a counter reset, which Prometheus' rate() handles.
+ */
+class Metric {
+   public:
+    Metric(const Metric&) = delete;
+    Metric& operator=(const Metric&) = delete;
+
+    /**
+     * @brief Add the metric to the exported list; once per metric.
+     * @param labels Label set without braces, e.g. route="GET /"; nullptr for none
+     */
+    void publish(const char* name, const char* help, const char* labels = nullptr);
+
+    const char* name() const {
+        return name_;
+    }
+
+    const char* help() const {
+        return help_;
+    }
+
+    const char* labels() const {
+        return labels_;
+    }
+
+    MetricType type() const {
+        return type_;
+    }
+
+    const Metric* next() const {
+        return next_;
+    }
+
+    /**
+     * @brief Most recently published metric; follow next() for the rest.
+     */
+    static const Metric* first();
+
+   protected:
+    explicit Metric(MetricType type) : type_(type) {}
+
+   private:
+    const char* name_ = nullptr;
+    const char* help_ = nullptr;
+    const char* labels_ = nullptr;
+    MetricType type_;
+    Metric* next_ = nullptr;
+
+    static std::atomic<Metric*> head_;
+};
+
+/**
+ * @brief Monotonic count of events.
+ */
+class MetricCounter : public Metric {
+   public:
+    MetricCounter() : Metric(MetricType::Counter) {}
+    MetricCounter(const char* name, const char* help, const char* labels = nullptr)
+        : Metric(MetricType::Counter) {
+        publish(name, help, labels);
+    }
+
+    void add(uint32_t n = 1) {
+        value_.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint32_t value() const {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    std::atomic<uint32_t> value_{0};
+};
+
+/**
+ * @brief Current value of something that goes up and down, or a peak.
+ */
+class MetricGauge : public Metric {
+   public:
+    MetricGauge() : Metric(MetricType::Gauge) {}
+    MetricGauge(const char* name, const char* help, const char* labels = nullptr)
+        : Metric(MetricType::Gauge) {
+        publish(name, help, labels);
+    }
+
+    void set(uint32_t value) {
+        value_.store(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Set to value if that is higher, for high-water marks.
+     */
+    void raise(uint32_t value) {
+        uint32_t current = value_.load(std::memory_order_relaxed);
+        while (current < value &&
+               !value_.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint32_t value() const {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    std::atomic<uint32_t> value_{0};
+};
+
+/**
+ * @brief Distribution of values over fixed buckets.
+ *
+ * Values are recorded as integers, e.g. microseconds, and multiplied by scale
+ * on export so the exposition uses base units, e.g. seconds.
+ */
+class MetricHistogram : public Metric {
+   public:
+    static constexpr size_t MAX_BUCKETS = 16;
+
+    /// 100 us to 5 s, for request and task timings recorded with esp_timer
+    static const uint32_t LATENCY_BOUNDS_US[];
+    static const size_t LATENCY_BOUND_COUNT;
+
+    /**
+     * @brief Latency histogram: LATENCY_BOUNDS_US, recorded in us, exported in seconds.
+     */
+    MetricHistogram();
+
+    /**
+     * @param bounds Ascending bucket upper bounds with static storage; +Inf is implied
+     * @param count Number of bounds, at most MAX_BUCKETS
+     */
+    MetricHistogram(const uint32_t* bounds, size_t count, double scale = 1.0);
+    MetricHistogram(const char* name, const char* help, const uint32_t* bounds, size_t count,
+                    double scale = 1.0, const char* labels = nullptr);
+
+    void observe(uint32_t value);
+
+    size_t bucketCount() const {
+        return count_;
+    }
+
+    const uint32_t* bounds() const {
+        return bounds_;
+    }
+
+    double scale() const {
+        return scale_;
+    }
+
+    /**
+     * @brief Observations in bucket i alone; bucketCount() is the +Inf bucket.
+     */
+    uint32_t bucketValue(size_t i) const {
+        return buckets_[i].load(std::memory_order_relaxed);
+    }
+
+    uint32_t sum() const {
+        return sum_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    const uint32_t* bounds_;
+    size_t count_;
+    double scale_;
+    std::atomic<uint32_t> buckets_[MAX_BUCKETS + 1] = {};
+    std::atomic<uint32_t> sum_{0};
+};
+
+/**
+ * @brief Write every published metric, then heap and FreeRTOS task figures
+ *        read at call time, in the Prometheus text exposition format.
+ */
+void writeMetrics(MetricsWriter& out);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Streams the Prometheus text format through a fixed buffer.
+ *
+ * Output accumulates in the caller's buffer and goes to the sink whenever the
+ * next line would not fit, so a scrape of any size needs one buffer of memory.
+ * After a sink failure further writes are dropped and ok() turns false.
+ */
+class MetricsWriter {
+   public:
+    /**
+     * @return false to stop the output, e.g. when the client went away
+     */
+    using Sink = bool (*)(void* ctx, const char* data, size_t len);
+
+    MetricsWriter(char* buf, size_t cap, Sink sink, void* ctx)
+        : buf_(buf), cap_(cap), sink_(sink), ctx_(ctx) {}
+
+    /**
+     * @brief # HELP and # TYPE lines opening a metric family.
+     */
+    void header(const char* name, const char* help, const char* type);
+
+    /**
+     * @brief One sample line; labels is the set without braces, or nullptr.
+     */
+    void sample(const char* name, const char* labels, uint64_t value);
+    void sample(const char* name, const char* labels, double value);
+
+    bool printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+    /**
+     * @brief Hand the rest of the buffer to the sink.
+     */
+    bool flush();
+
+    bool ok() const {
+        return ok_;
+    }
+
+   private:
+    char* buf_;
+    size_t cap_;
+    Sink sink_;
+    void* ctx_;
+    size_t len_ = 0;
+    bool ok_ = true;
+};
@@ -0,0 +1,202 @@
+#include "metrics.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+#if CONFIG_FREERTOS_RUN_TIME_STATS_USING_CPU_CLK
+constexpr double RUN_TIME_COUNTER_HZ = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1e6;
+#else
+constexpr double RUN_TIME_COUNTER_HZ = 1e6;  // esp_timer microseconds
+#endif
+
+std::atomic<Metric*> Metric::head_{nullptr};
+
+const uint32_t MetricHistogram::LATENCY_BOUNDS_US[] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 100000, 500000, 1000000, 5000000,
+};
+const size_t MetricHistogram::LATENCY_BOUND_COUNT =
+    sizeof(LATENCY_BOUNDS_US) / sizeof(LATENCY_BOUNDS_US[0]);
+
+void Metric::publish(const char* name, const char* help, const char* labels) {
+    name_ = name;
+    help_ = help;
+    labels_ = labels;
+
+    // Lock-free push, so metrics can be published from static constructors
+    Metric* head = head_.load(std::memory_order_relaxed);
+    do {
+        next_ = head;
+    } while (!head_.compare_exchange_weak(head, this, std::memory_order_release,
+                                          std::memory_order_relaxed));
+}
+
+const Metric* Metric::first() {
+    return head_.load(std::memory_order_acquire);
+}
+
+MetricHistogram::MetricHistogram()
+    : MetricHistogram(LATENCY_BOUNDS_US, LATENCY_BOUND_COUNT, 1e-6) {}
+
+MetricHistogram::MetricHistogram(const uint32_t* bounds, size_t count, double scale)
+    : Metric(MetricType::Histogram),
+      bounds_(bounds),
+      count_(count < MAX_BUCKETS ? count : MAX_BUCKETS),
+      scale_(scale) {}
+
+MetricHistogram::MetricHistogram(const char* name, const char* help, const uint32_t* bounds,
+                                 size_t count, double scale, const char* labels)
+    : MetricHistogram(bounds, count, scale) {
+    publish(name, help, labels);
+}
+
+void MetricHistogram::observe(uint32_t value) {
+    size_t i = 0;
+    while (i < count_ && value > bounds_[i]) i++;
+    buckets_[i].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+}
+
+static const char* typeName(MetricType type) {
+    switch (type) {
+        case MetricType::Counter:
+            return "counter";
+        case MetricType::Gauge:
+            return "gauge";
+        default:
+            return "histogram";
+    }
+}
+
+/**
+ * @brief The le="..." values of the bounds formatted last, so histograms that
+ *        share bounds, such as one per route, format them once per scrape.
+ */
+struct BoundLabels {
+    const uint32_t* bounds = nullptr;
+    double scale = 0;
+    char le[MetricHistogram::MAX_BUCKETS][16];
+
+    void update(const MetricHistogram& histogram) {
+        if (bounds == histogram.bounds() && scale == histogram.scale()) return;
+        bounds = histogram.bounds();
+        scale = histogram.scale();
+        for (size_t i = 0; i < histogram.bucketCount(); i++) {
+            snprintf(le[i], sizeof(le[i]), "%.9g", bounds[i] * scale);
+        }
+    }
+};
+
+// Bucket counts are read one by one while others record, so a scrape can be
+// off by the observations that landed meanwhile; _count is derived from the
+// same reads to keep it equal to the +Inf bucket.
+static void writeHistogram(MetricsWriter& out, const MetricHistogram& histogram,
+                           BoundLabels& bound_labels) {
+    bound_labels.update(histogram);
+    const char* labels = histogram.labels();
+    const char* sep = labels ? "," : "";
+    if (!labels) labels = "";
+
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < histogram.bucketCount(); i++) {
+        cumulative += histogram.bucketValue(i);
+        out.printf("%s_bucket{%s%sle=\"%s\"} %llu\n", histogram.name(), labels, sep,
+                   bound_labels.le[i], (unsigned long long)cumulative);
+    }
+    cumulative += histogram.bucketValue(histogram.bucketCount());
+    out.printf("%s_bucket{%s%sle=\"+Inf\"} %llu\n", histogram.name(), labels, sep,
+               (unsigned long long)cumulative);
+
+    const char* braces_open = *labels ? "{" : "";
+    const char* braces_close = *labels ? "}" : "";
+    out.printf("%s_sum%s%s%s %.9g\n", histogram.name(), braces_open, labels, braces_close,
+               histogram.sum() * histogram.scale());
+    out.printf("%s_count%s%s%s %llu\n", histogram.name(), braces_open, labels, braces_close,
+               (unsigned long long)cumulative);
+}
+
+static void writeHeap(MetricsWriter& out) {
+    out.header("heap_free_bytes", "Free heap", "gauge");
+    out.sample("heap_free_bytes", nullptr,
+               static_cast<uint64_t>(heap_caps_get_free_size(MALLOC_CAP_DEFAULT)));
+    out.header("heap_min_free_bytes", "Lowest free heap since boot", "gauge");
+    out.sample("heap_min_free_bytes", nullptr,
+               static_cast<uint64_t>(heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT)));
+    out.header("heap_largest_free_block_bytes", "Largest block malloc can return", "gauge");
+    out.sample("heap_largest_free_block_bytes", nullptr,
+               static_cast<uint64_t>(heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT)));
+}
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+constexpr size_t TASK_LABEL_LEN = configMAX_TASK_NAME_LEN + 8;  // task="..."
+
+static void writeTasks(MetricsWriter& out) {
+    std::unique_ptr<TaskStatus_t[]> tasks(
+        new (std::nothrow) TaskStatus_t[CONFIG_METRICS_MAX_TASKS]);
+    if (!tasks) return;
+
+    decltype(TaskStatus_t::ulRunTimeCounter) total_run_time = 0;
+    UBaseType_t count =
+        uxTaskGetSystemState(tasks.get(), CONFIG_METRICS_MAX_TASKS, &total_run_time);
+    // A table too small for every task is left empty
+    if (count == 0) return;
+
+    char labels[TASK_LABEL_LEN];
+    out.header("freertos_task_stack_min_free_bytes", "Least free stack a task has had",
+               "gauge");
+    for (UBaseType_t i = 0; i < count; i++) {
+        snprintf(labels, sizeof(labels), "task=\"%s\"", tasks[i].pcTaskName);
+        out.sample("freertos_task_stack_min_free_bytes", labels,
+                   static_cast<uint64_t>(tasks[i].usStackHighWaterMark));
+    }
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    // The counters are 32-bit by default and wrap; rate() takes that as a reset
+    out.header("freertos_task_runtime_seconds_total", "CPU time a task has run", "counter");
+    for (UBaseType_t i = 0; i < count; i++) {
+        snprintf(labels, sizeof(labels), "task=\"%s\"", tasks[i].pcTaskName);
+        out.sample("freertos_task_runtime_seconds_total", labels,
+                   tasks[i].ulRunTimeCounter / RUN_TIME_COUNTER_HZ);
+    }
+    out.header("freertos_runtime_seconds_total", "Run time the task counters are shares of",
+               "counter");
+    out.sample("freertos_runtime_seconds_total", nullptr, total_run_time / RUN_TIME_COUNTER_HZ);
+#endif
+}
+#endif
+
+void writeMetrics(MetricsWriter& out) {
+    const char* family = nullptr;
+    BoundLabels bound_labels;
+    for (const Metric* metric = Metric::first(); metric; metric = metric->next()) {
+        if (!family || strcmp(family, metric->name()) != 0) {
+            family = metric->name();
+            out.header(family, metric->help(), typeName(metric->type()));
+        }
+        switch (metric->type()) {
+            case MetricType::Counter:
+                out.sample(metric->name(), metric->labels(),
+                           static_cast<uint64_t>(
+                               static_cast<const MetricCounter*>(metric)->value()));
+                break;
+            case MetricType::Gauge:
+                out.sample(metric->name(), metric->labels(),
+                           static_cast<uint64_t>(static_cast<const MetricGauge*>(metric)->value()));
+                break;
+            case MetricType::Histogram:
+                writeHistogram(out, *static_cast<const MetricHistogram*>(metric), bound_labels);
+                break;
+        }
+    }
+
+    writeHeap(out);
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+    writeTasks(out);
+#endif
+}
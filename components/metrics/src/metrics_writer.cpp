@@ -0,0 +1,47 @@
+#include "metrics_writer.hpp"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+void MetricsWriter::header(const char* name, const char* help, const char* type) {
+    printf("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+void MetricsWriter::sample(const char* name, const char* labels, uint64_t value) {
+    if (labels) {
+        printf("%s{%s} %llu\n", name, labels, static_cast<unsigned long long>(value));
+    } else {
+        printf("%s %llu\n", name, static_cast<unsigned long long>(value));
+    }
+}
+
+void MetricsWriter::sample(const char* name, const char* labels, double value) {
+    if (labels) {
+        printf("%s{%s} %.9g\n", name, labels, value);
+    } else {
+        printf("%s %.9g\n", name, value);
+    }
+}
+
+bool MetricsWriter::printf(const char* fmt, ...) {
+    for (int attempt = 0; attempt < 2 && ok_; attempt++) {
+        va_list args;
+        va_start(args, fmt);
+        int n = vsnprintf(buf_ + len_, cap_ - len_, fmt, args);
+        va_end(args);
+
+        if (n >= 0 && static_cast<size_t>(n) < cap_ - len_) {
+            len_ += n;
+            return true;
+        }
+        if (!flush()) return false;
+    }
+    ok_ = false;  // Single line larger than the whole buffer
+    return false;
+}
+
+bool MetricsWriter::flush() {
+    if (len_ > 0 && ok_) ok_ = sink_(ctx_, buf_, len_);
+    len_ = 0;
+    return ok_;
+}
@@ -0,0 +1,47 @@
+#include <stdio.h>
+
+#include "unity.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void setUp(void) {
+    // Set up before every test
+}
+
+void tearDown(void) {
+    // Clean up after every test
+}
+
+// metrics tests
+void test_metrics_counter_is_exported();
+void test_metrics_gauge_keeps_peak();
+void test_metrics_histogram_exports_cumulative_buckets();
+void test_metrics_writer_streams_through_small_buffer();
+
+#ifdef __cplusplus
+}
+#endif
+
+TEST_CASE("Metrics: Counters are exported with their labels", "[metrics]") {
+    test_metrics_counter_is_exported();
+}
+
+TEST_CASE("Metrics: Gauges keep their peak", "[metrics]") {
+    test_metrics_gauge_keeps_peak();
+}
+
+TEST_CASE("Metrics: Histograms export cumulative buckets", "[metrics]") {
+    test_metrics_histogram_exports_cumulative_buckets();
+}
+
+TEST_CASE("Metrics: The writer streams through a small buffer", "[metrics]") {
+    test_metrics_writer_streams_through_small_buffer();
+}
+
+void app_main(void) {
+    UNITY_BEGIN();
+    unity_run_all_tests();
+    UNITY_END();
+}
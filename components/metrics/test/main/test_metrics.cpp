@@ -0,0 +1,107 @@
+#include <cstring>
+#include <string>
+
+#include "metrics.hpp"
+#include "unity.h"
+
+// Metrics are never unpublished, so each test owns distinct names
+static MetricCounter test_counter_a("test_events_total", "Test events", "kind=\"a\"");
+static MetricCounter test_counter_b("test_events_total", "Test events", "kind=\"b\"");
+static MetricGauge test_gauge("test_peak_bytes", "Test peak");
+
+static const uint32_t TEST_BOUNDS[] = {10, 100, 1000};
+static MetricHistogram test_histogram("test_duration_seconds", "Test durations", TEST_BOUNDS,
+                                      3, 1e-3);
+
+static bool appendTo(void* ctx, const char* data, size_t len) {
+    static_cast<std::string*>(ctx)->append(data, len);
+    return true;
+}
+
+/**
+ * @brief Run writeMetrics into a string.
+ */
+static std::string scrape() {
+    std::string text;
+    char buf[256];
+    MetricsWriter out(buf, sizeof(buf), appendTo, &text);
+    writeMetrics(out);
+    TEST_ASSERT_TRUE(out.flush());
+    return text;
+}
+
+static bool contains(const std::string& text, const char* line) {
+    return text.find(line) != std::string::npos;
+}
+
+/// @brief Tests that counters of one family share a header and keep their own values.
+extern "C" void test_metrics_counter_is_exported() {
+    test_counter_a.add();
+    test_counter_b.add(5);
+    TEST_ASSERT_EQUAL(1, test_counter_a.value());
+
+    std::string text = scrape();
+    TEST_ASSERT_TRUE(contains(text, "# TYPE test_events_total counter\n"));
+    TEST_ASSERT_TRUE(contains(text, "test_events_total{kind=\"a\"} 1\n"));
+    TEST_ASSERT_TRUE(contains(text, "test_events_total{kind=\"b\"} 5\n"));
+    TEST_ASSERT_EQUAL(text.find("# HELP test_events_total"),
+                      text.rfind("# HELP test_events_total"));
+    TEST_ASSERT_TRUE(contains(text, "heap_free_bytes "));
+}
+
+/// @brief Tests that raise() only moves a gauge up and set() moves it either way.
+extern "C" void test_metrics_gauge_keeps_peak() {
+    test_gauge.raise(300);
+    test_gauge.raise(200);
+    TEST_ASSERT_EQUAL(300, test_gauge.value());
+
+    std::string text = scrape();
+    TEST_ASSERT_TRUE(contains(text, "# TYPE test_peak_bytes gauge\n"));
+    TEST_ASSERT_TRUE(contains(text, "test_peak_bytes 300\n"));
+
+    test_gauge.set(100);
+    TEST_ASSERT_EQUAL(100, test_gauge.value());
+}
+
+/// @brief Tests that observations land in the first bucket they fit and export cumulatively.
+extern "C" void test_metrics_histogram_exports_cumulative_buckets() {
+    test_histogram.observe(5);
+    test_histogram.observe(10);  // Bounds are inclusive
+    test_histogram.observe(50);
+    test_histogram.observe(5000);
+    TEST_ASSERT_EQUAL(2, test_histogram.bucketValue(0));
+    TEST_ASSERT_EQUAL(1, test_histogram.bucketValue(1));
+    TEST_ASSERT_EQUAL(0, test_histogram.bucketValue(2));
+    TEST_ASSERT_EQUAL(1, test_histogram.bucketValue(3));
+
+    std::string text = scrape();
+    TEST_ASSERT_TRUE(contains(text, "# TYPE test_duration_seconds histogram\n"));
+    TEST_ASSERT_TRUE(contains(text, "test_duration_seconds_bucket{le=\"0.01\"} 2\n"));
+    TEST_ASSERT_TRUE(contains(text, "test_duration_seconds_bucket{le=\"0.1\"} 3\n"));
+    TEST_ASSERT_TRUE(contains(text, "test_duration_seconds_bucket{le=\"1\"} 3\n"));
+    TEST_ASSERT_TRUE(contains(text, "test_duration_seconds_bucket{le=\"+Inf\"} 4\n"));
+    TEST_ASSERT_TRUE(contains(text, "test_duration_seconds_sum 5.065\n"));
+    TEST_ASSERT_TRUE(contains(text, "test_duration_seconds_count 4\n"));
+}
+
+/// @brief Tests that lines are never split across sink calls and that a failing sink stops output.
+extern "C" void test_metrics_writer_streams_through_small_buffer() {
+    std::string text;
+    char buf[32];
+    MetricsWriter out(buf, sizeof(buf), appendTo, &text);
+    for (int i = 0; i < 10; i++) out.sample("test_line", "n=\"x\"", static_cast<uint64_t>(i));
+    TEST_ASSERT_TRUE(out.flush());
+    TEST_ASSERT_EQUAL(10 * strlen("test_line{n=\"x\"} 0\n"), text.size());
+    TEST_ASSERT_TRUE(contains(text, "test_line{n=\"x\"} 9\n"));
+
+    // A line longer than the buffer cannot be written
+    MetricsWriter tiny(buf, 8, appendTo, &text);
+    TEST_ASSERT_FALSE(tiny.printf("%s\n", "longer than eight"));
+    TEST_ASSERT_FALSE(tiny.ok());
+
+    MetricsWriter failing(buf, sizeof(buf), [](void*, const char*, size_t) { return false; },
+                          nullptr);
+    failing.sample("test_line", nullptr, 1.5);
+    TEST_ASSERT_FALSE(failing.flush());
+    TEST_ASSERT_FALSE(failing.printf("after\n"));
+}
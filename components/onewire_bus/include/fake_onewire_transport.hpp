@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "onewire_bus.hpp"
+#include "onewire_transport.hpp"
+
+/**
+ * @brief Host-side 1-Wire bus model.
+ *
+ * Simulates DS18B20 slaves at the time-slot level: every attached device runs
+ * its own ROM/function command state machine and read slots are wired-AND
+ * across the devices still selected, exactly as on a real bus. Unit tests
+ * drive it directly; OneWireSimPin puts it behind a simulated GPIO. Linux
+ * target only.
+ */
+class FakeOneWireTransport : public OneWireTransport {
+   public:
+    /**
+     * @brief Attach a simulated DS18B20.
+     * @param rom 64-bit ROM code (family code in the low byte)
+     * @param raw_temp Temperature in 1/16 °C reported after the next Convert T
+     * @param busy_slots Read slots the device stays busy after Convert T
+     */
+    void addDevice(OneWireAddress rom, int16_t raw_temp, int busy_slots = 3);
+
+    void setTemperature(size_t index, int16_t raw_temp);
+    uint8_t scratchpadByte(size_t index, size_t byte) const;
+
+    /// Flip one bit in the next scratchpad read of a device, as a line glitch would.
+    void corruptNextRead(size_t index);
+
+    bool reset() override;
+    void writeBit(bool bit) override;
+    bool readBit() override;
+
+    size_t resetCount() const {
+        return resets_;
+    }
+    size_t slotCount() const {
+        return slots_;
+    }
+
+   private:
+    enum class State {
+        Idle,
+        RomCommand,
+        Search,
+        Match,
+        FunctionCommand,
+        Converting,
+        ReadSp,
+        WriteSp,
+    };
+
+    struct Device {
+        OneWireAddress rom;
+        uint8_t scratchpad[9];
+        int16_t pending_temp;
+        bool corrupt_next;
+        int busy_slots;
+        int busy_left;
+        State state;
+        uint8_t shift;
+        int bit_index;
+        int search_phase;
+    };
+
+    std::vector<Device> devices_;
+    size_t resets_ = 0;
+    size_t slots_ = 0;
+
+    static void updateCrc(Device& dev);
+    static bool shiftIn(Device& dev, bool bit);
+    void handleCommand(Device& dev);
+};
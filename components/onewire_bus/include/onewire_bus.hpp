@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "onewire_transport.hpp"
+
+#define ONEWIRE_MAX_DEVICES 16
+
+/**
+ * @brief 64-bit 1-Wire ROM code, transmitted LSB first (family code in the low byte).
+ */
+using OneWireAddress = uint64_t;
+
+/**
+ * @brief 1-Wire bus master with ROM search and per-device addressing.
+ *
+ * Protocol logic only; timing is delegated to a OneWireTransport.
+ */
+class OneWireBus {
+   public:
+    explicit OneWireBus(OneWireTransport& transport);
+
+    // === Link layer ===
+
+    bool reset();
+    void writeBit(bool bit);
+    bool readBit();
+    void writeByte(uint8_t byte);
+    uint8_t readByte();
+    void writeBytes(const uint8_t* data, size_t len);
+    void readBytes(uint8_t* data, size_t len);
+
+    // === ROM commands ===
+
+    /**
+     * @brief Reset the bus and address a single device (Match ROM).
+     * @return false if no presence pulse was seen
+     */
+    bool select(OneWireAddress address);
+
+    /**
+     * @brief Reset the bus and address every device at once (Skip ROM).
+     * @return false if no presence pulse was seen
+     */
+    bool selectAll();
+
+    /**
+     * @brief Enumerate the bus with Search ROM and refresh the cached device table.
+     * @return Number of devices found (capped at ONEWIRE_MAX_DEVICES)
+     */
+    size_t searchDevices();
+
+    size_t deviceCount() const;
+    OneWireAddress device(size_t index) const;
+
+    static uint8_t familyCode(OneWireAddress address) {
+        return static_cast<uint8_t>(address & 0xFF);
+    }
+
+   private:
+    OneWireTransport& _transport;
+    OneWireAddress _devices[ONEWIRE_MAX_DEVICES] = {};
+    size_t _device_count = 0;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Build the lookup table for the Dallas/Maxim CRC8 (x^8 + x^5 + x^4 + 1, reflected).
+ */
+constexpr std::array<uint8_t, 256> makeOneWireCrc8Table() {
+    std::array<uint8_t, 256> table = {};
+    for (int i = 0; i < 256; i++) {
+        uint8_t crc = static_cast<uint8_t>(i);
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x01) ? static_cast<uint8_t>((crc >> 1) ^ 0x8C) : (crc >> 1);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+inline constexpr std::array<uint8_t, 256> ONEWIRE_CRC8_TABLE = makeOneWireCrc8Table();
+
+/**
+ * @brief Dallas CRC8 over a buffer. Running it over data plus its CRC byte yields 0.
+ */
+constexpr uint8_t oneWireCrc8(const uint8_t* data, size_t len, uint8_t crc = 0) {
+    for (size_t i = 0; i < len; i++) {
+        crc = ONEWIRE_CRC8_TABLE[crc ^ data[i]];
+    }
+    return crc;
+}
+
+static_assert(ONEWIRE_CRC8_TABLE[1] == 0x5E, "CRC8 table generation is broken");
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "onewire_transport.hpp"
+
+/**
+ * @brief Bit-banged 1-Wire on an open-drain GPIO.
+ *
+ * Each time slot runs inside a critical section so an interrupt cannot
+ * stretch the sample window. The CPU is busy for the whole transfer.
+ */
+class OneWireGpioTransport : public OneWireTransport {
+   public:
+    explicit OneWireGpioTransport(gpio_num_t pin);
+
+    bool reset() override;
+    void writeBit(bool bit) override;
+    bool readBit() override;
+
+   private:
+    gpio_num_t _pin;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+};
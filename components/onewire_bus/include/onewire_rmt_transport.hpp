@@ -0,0 +1,50 @@
+#pragma once
+
+#include "driver/gpio.h"
+#include "driver/rmt_rx.h"
+#include "driver/rmt_tx.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "onewire_transport.hpp"
+
+#define ONEWIRE_RMT_RX_CHUNK_BYTES 7
+
+/**
+ * @brief 1-Wire driven by the RMT peripheral.
+ *
+ * Time slots are encoded into RMT symbols and clocked out by hardware, with
+ * the bus looped back into an RX channel to sample presence and read slots.
+ * The calling task blocks on the transfer instead of spinning.
+ */
+class OneWireRmtTransport : public OneWireTransport {
+   public:
+    explicit OneWireRmtTransport(gpio_num_t pin);
+    ~OneWireRmtTransport() override;
+
+    /**
+     * @brief Allocate RMT channels and encoders.
+     * @return ESP_OK on success, or error code
+     */
+    esp_err_t init();
+
+    bool reset() override;
+    void writeBit(bool bit) override;
+    bool readBit() override;
+    void writeBytes(const uint8_t* data, size_t len) override;
+    void readBytes(uint8_t* data, size_t len) override;
+
+   private:
+    gpio_num_t _pin;
+    rmt_channel_handle_t _tx_channel = nullptr;
+    rmt_channel_handle_t _rx_channel = nullptr;
+    rmt_encoder_handle_t _copy_encoder = nullptr;
+    rmt_encoder_handle_t _bytes_encoder = nullptr;
+    QueueHandle_t _rx_queue = nullptr;
+    rmt_symbol_word_t _rx_symbols[ONEWIRE_RMT_RX_CHUNK_BYTES * 8 + 2];
+
+    size_t transmitAndReceive(rmt_encoder_handle_t encoder, const void* payload, size_t len);
+
+    static bool onRxDone(rmt_channel_handle_t channel, const rmt_rx_done_event_data_t* edata,
+                         void* user_ctx);
+};
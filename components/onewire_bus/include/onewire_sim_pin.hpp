@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "fake_onewire_transport.hpp"
+#include "host_gpio.hpp"
+
+/**
+ * @brief Pin-level front end for FakeOneWireTransport on a host_sim GPIO.
+ *
+ * Decodes the line the way a DS18B20 does: a low of at least 480 us is a reset,
+ * at least 15 us a write-0, anything shorter starts a write-1 or read slot. A
+ * short slot becomes a read slot if the line is sampled before the next one
+ * starts; the selected devices then hold it low for 45 us when sending a 0.
+ * Presence is asserted 30-150 us after a reset. Linux target only.
+ */
+class OneWireSimPin : public HostGpioDevice {
+   public:
+    static constexpr uint64_t RESET_MIN_US = 480;
+    static constexpr uint64_t WRITE0_MIN_US = 15;
+    static constexpr uint64_t READ_HOLD_US = 45;
+    static constexpr uint64_t PRESENCE_START_US = 30;
+    static constexpr uint64_t PRESENCE_END_US = 150;
+
+    explicit OneWireSimPin(FakeOneWireTransport& bus) : bus_(bus) {}
+
+    /**
+     * @brief Put a bus of DS18B20s on a pin for a host app build.
+     *
+     * Temperatures drift slowly around 20-25 °C so histories and live streams
+     * have something to show. The bus lives for the rest of the process.
+     * @param count Number of sensors; 0 leaves the pin unconnected
+     */
+    static void attachSensors(gpio_num_t pin, size_t count);
+
+    void drive(bool level, uint64_t now_us) override;
+    bool sense(uint64_t now_us) override;
+
+   private:
+    enum class Slot {
+        Idle,
+        Presence,  ///< After a reset pulse
+        Short,     ///< Write-1 or read; decided by whether the master samples
+        Read,
+    };
+
+    FakeOneWireTransport& bus_;
+    Slot slot_ = Slot::Idle;
+    bool master_low_ = false;
+    bool presence_ = false;
+    bool read_bit_ = true;
+    uint64_t fall_us_ = 0;
+    uint64_t rise_us_ = 0;
+
+    size_t drift_count_ = 0;  ///< Sensors animated by attachSensors()
+    std::chrono::steady_clock::time_point drift_start_;
+
+    void updateDrift();
+};
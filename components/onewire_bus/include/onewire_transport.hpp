@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Physical-layer backend for OneWireBus.
+ *
+ * Implementations only need reset and single-bit slots. Backends that can
+ * schedule whole transactions in hardware should override the byte helpers
+ * so a command or scratchpad read becomes a single transfer.
+ */
+class OneWireTransport {
+   public:
+    virtual ~OneWireTransport() = default;
+
+    /**
+     * @brief Issue a reset pulse and sample the presence response.
+     * @return true if at least one device answered
+     */
+    virtual bool reset() = 0;
+
+    virtual void writeBit(bool bit) = 0;
+    virtual bool readBit() = 0;
+
+    /**
+     * @brief Write bytes LSB first.
+     */
+    virtual void writeBytes(const uint8_t* data, size_t len) {
+        for (size_t i = 0; i < len; i++) {
+            uint8_t byte = data[i];
+            for (int b = 0; b < 8; b++) {
+                writeBit(byte & 0x01);
+                byte >>= 1;
+            }
+        }
+    }
+
+    /**
+     * @brief Read bytes LSB first.
+     */
+    virtual void readBytes(uint8_t* data, size_t len) {
+        for (size_t i = 0; i < len; i++) {
+            uint8_t byte = 0;
+            for (int b = 0; b < 8; b++) {
+                if (readBit()) byte |= (1 << b);
+            }
+            data[i] = byte;
+        }
+    }
+};
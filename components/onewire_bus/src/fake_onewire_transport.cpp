@@ -0,0 +1,167 @@
+#include "fake_onewire_transport.hpp"
+
+#include "onewire_crc.hpp"
+
+void FakeOneWireTransport::addDevice(OneWireAddress rom, int16_t raw_temp, int busy_slots) {
+    Device dev = {};
+    dev.rom = rom;
+    dev.pending_temp = raw_temp;
+    dev.busy_slots = busy_slots;
+    dev.state = State::Idle;
+
+    // Power-on scratchpad: 85 °C, 12-bit config
+    const uint8_t por[9] = {0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10, 0x00};
+    for (int i = 0; i < 9; i++) dev.scratchpad[i] = por[i];
+    updateCrc(dev);
+
+    devices_.push_back(dev);
+}
+
+void FakeOneWireTransport::setTemperature(size_t index, int16_t raw_temp) {
+    devices_.at(index).pending_temp = raw_temp;
+}
+
+uint8_t FakeOneWireTransport::scratchpadByte(size_t index, size_t byte) const {
+    return devices_.at(index).scratchpad[byte];
+}
+
+void FakeOneWireTransport::corruptNextRead(size_t index) {
+    devices_.at(index).corrupt_next = true;
+}
+
+void FakeOneWireTransport::updateCrc(Device& dev) {
+    dev.scratchpad[8] = oneWireCrc8(dev.scratchpad, 8);
+}
+
+bool FakeOneWireTransport::shiftIn(Device& dev, bool bit) {
+    dev.shift = (dev.shift >> 1) | (bit ? 0x80 : 0x00);
+    return ++dev.bit_index % 8 == 0;
+}
+
+bool FakeOneWireTransport::reset() {
+    resets_++;
+    for (auto& dev : devices_) {
+        dev.state = State::RomCommand;
+        dev.shift = 0;
+        dev.bit_index = 0;
+    }
+    return !devices_.empty();
+}
+
+void FakeOneWireTransport::handleCommand(Device& dev) {
+    dev.bit_index = 0;
+    switch (dev.shift) {
+        case 0x44:  // Convert T
+            dev.scratchpad[0] = static_cast<uint8_t>(dev.pending_temp & 0xFF);
+            dev.scratchpad[1] = static_cast<uint8_t>(dev.pending_temp >> 8);
+            updateCrc(dev);
+            dev.busy_left = dev.busy_slots;
+            dev.state = State::Converting;
+            break;
+        case 0xBE:  // Read Scratchpad
+            dev.state = State::ReadSp;
+            break;
+        case 0x4E:  // Write Scratchpad
+            dev.state = State::WriteSp;
+            break;
+        default:
+            dev.state = State::Idle;
+            break;
+    }
+}
+
+void FakeOneWireTransport::writeBit(bool bit) {
+    slots_++;
+    for (auto& dev : devices_) {
+        switch (dev.state) {
+            case State::RomCommand:
+                if (!shiftIn(dev, bit)) break;
+                dev.bit_index = 0;
+                if (dev.shift == 0xF0) {
+                    dev.state = State::Search;
+                    dev.search_phase = 0;
+                } else if (dev.shift == 0x55) {
+                    dev.state = State::Match;
+                } else if (dev.shift == 0xCC) {
+                    dev.state = State::FunctionCommand;
+                } else {
+                    dev.state = State::Idle;
+                }
+                break;
+            case State::Search:
+            case State::Match: {
+                bool rom_bit = (dev.rom >> dev.bit_index) & 1;
+                if (dev.state == State::Search && dev.search_phase != 2) break;
+                if (bit != rom_bit) {
+                    dev.state = State::Idle;
+                    break;
+                }
+                dev.search_phase = 0;
+                if (++dev.bit_index == 64) {
+                    dev.bit_index = 0;
+                    dev.state = State::FunctionCommand;
+                }
+                break;
+            }
+            case State::FunctionCommand:
+                if (shiftIn(dev, bit)) handleCommand(dev);
+                break;
+            case State::WriteSp:
+                // TH, TL and config land in scratchpad bytes 2..4
+                if (shiftIn(dev, bit)) {
+                    int index = 1 + dev.bit_index / 8;
+                    dev.scratchpad[index] = dev.shift;
+                    if (index == 4) {
+                        dev.scratchpad[4] |= 0x1F;
+                        updateCrc(dev);
+                        dev.state = State::Idle;
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+bool FakeOneWireTransport::readBit() {
+    slots_++;
+    bool line = true;
+    for (auto& dev : devices_) {
+        bool out = true;
+        switch (dev.state) {
+            case State::Search: {
+                bool rom_bit = (dev.rom >> dev.bit_index) & 1;
+                if (dev.search_phase == 0) {
+                    out = rom_bit;
+                    dev.search_phase = 1;
+                } else if (dev.search_phase == 1) {
+                    out = !rom_bit;
+                    dev.search_phase = 2;
+                }
+                break;
+            }
+            case State::Converting:
+                if (dev.busy_left > 0) {
+                    dev.busy_left--;
+                    out = false;
+                }
+                break;
+            case State::ReadSp:
+                if (dev.bit_index < 72) {
+                    int byte = dev.bit_index / 8;
+                    out = (dev.scratchpad[byte] >> (dev.bit_index % 8)) & 1;
+                    if (dev.corrupt_next && dev.bit_index == 0) {
+                        out = !out;
+                        dev.corrupt_next = false;
+                    }
+                    dev.bit_index++;
+                }
+                break;
+            default:
+                break;
+        }
+        line = line && out;
+    }
+    return line;
+}
@@ -0,0 +1,133 @@
+#include "onewire_bus.hpp"
+
+#include "esp_log.h"
+#include "onewire_crc.hpp"
+
+static const char* TAG = "onewire_bus";
+
+constexpr uint8_t CMD_SEARCH_ROM = 0xF0;
+constexpr uint8_t CMD_MATCH_ROM = 0x55;
+constexpr uint8_t CMD_SKIP_ROM = 0xCC;
+
+OneWireBus::OneWireBus(OneWireTransport& transport) : _transport(transport) {}
+
+bool OneWireBus::reset() {
+    return _transport.reset();
+}
+
+void OneWireBus::writeBit(bool bit) {
+    _transport.writeBit(bit);
+}
+
+bool OneWireBus::readBit() {
+    return _transport.readBit();
+}
+
+void OneWireBus::writeByte(uint8_t byte) {
+    _transport.writeBytes(&byte, 1);
+}
+
+uint8_t OneWireBus::readByte() {
+    uint8_t byte = 0;
+    _transport.readBytes(&byte, 1);
+    return byte;
+}
+
+void OneWireBus::writeBytes(const uint8_t* data, size_t len) {
+    _transport.writeBytes(data, len);
+}
+
+void OneWireBus::readBytes(uint8_t* data, size_t len) {
+    _transport.readBytes(data, len);
+}
+
+bool OneWireBus::select(OneWireAddress address) {
+    if (!reset()) return false;
+
+    // Command and ROM go out as one transfer
+    uint8_t frame[9] = {CMD_MATCH_ROM};
+    for (int i = 0; i < 8; i++) {
+        frame[i + 1] = static_cast<uint8_t>(address >> (8 * i));
+    }
+    writeBytes(frame, sizeof(frame));
+    return true;
+}
+
+bool OneWireBus::selectAll() {
+    if (!reset()) return false;
+
+    writeByte(CMD_SKIP_ROM);
+    return true;
+}
+
+size_t OneWireBus::searchDevices() {
+    // Maxim AN187 search: each pass walks the ROM tree, taking the 0 branch at the
+    // deepest unexplored conflict from the previous pass and 1 at that conflict itself.
+    _device_count = 0;
+
+    OneWireAddress rom = 0;
+    int last_discrepancy = -1;
+    bool last_device = false;
+
+    while (!last_device && _device_count < ONEWIRE_MAX_DEVICES) {
+        if (!reset()) break;
+        writeByte(CMD_SEARCH_ROM);
+
+        int discrepancy = -1;
+        bool aborted = false;
+
+        for (int bit = 0; bit < 64; bit++) {
+            bool id_bit = readBit();
+            bool cmp_bit = readBit();
+
+            if (id_bit && cmp_bit) {  // No device answered this slot
+                aborted = true;
+                break;
+            }
+
+            bool direction;
+            if (id_bit != cmp_bit) {
+                direction = id_bit;
+            } else if (bit < last_discrepancy) {
+                direction = (rom >> bit) & 1;
+            } else {
+                direction = (bit == last_discrepancy);
+            }
+            if (id_bit == cmp_bit && !direction) discrepancy = bit;
+
+            if (direction) {
+                rom |= (1ULL << bit);
+            } else {
+                rom &= ~(1ULL << bit);
+            }
+            writeBit(direction);
+        }
+
+        if (aborted) {
+            ESP_LOGW(TAG, "Search aborted: no response on bus");
+            break;
+        }
+
+        uint8_t rom_bytes[8];
+        for (int i = 0; i < 8; i++) rom_bytes[i] = static_cast<uint8_t>(rom >> (8 * i));
+        if (oneWireCrc8(rom_bytes, sizeof(rom_bytes)) == 0) {
+            _devices[_device_count++] = rom;
+        } else {
+            ESP_LOGW(TAG, "Dropping ROM with bad CRC: %016llx",
+                     static_cast<unsigned long long>(rom));
+        }
+        last_discrepancy = discrepancy;
+        last_device = (discrepancy < 0);
+    }
+
+    ESP_LOGI(TAG, "Found %u device(s)", static_cast<unsigned>(_device_count));
+    return _device_count;
+}
+
+size_t OneWireBus::deviceCount() const {
+    return _device_count;
+}
+
+OneWireAddress OneWireBus::device(size_t index) const {
+    return index < _device_count ? _devices[index] : 0;
+}
@@ -0,0 +1,46 @@
+#include "onewire_gpio_transport.hpp"
+
+#include "esp_rom_sys.h"
+
+OneWireGpioTransport::OneWireGpioTransport(gpio_num_t pin) : _pin(pin) {
+    gpio_set_direction(_pin, GPIO_MODE_INPUT_OUTPUT_OD);
+    gpio_set_level(_pin, 1);
+}
+
+bool OneWireGpioTransport::reset() {
+    // The 480 us low phase tolerates jitter; only the presence sample is timed tightly
+    gpio_set_level(_pin, 0);
+    esp_rom_delay_us(480);
+
+    portENTER_CRITICAL(&_mux);
+    gpio_set_level(_pin, 1);
+    esp_rom_delay_us(70);
+    bool presence = !gpio_get_level(_pin);
+    portEXIT_CRITICAL(&_mux);
+
+    esp_rom_delay_us(410);
+    return presence;
+}
+
+void OneWireGpioTransport::writeBit(bool bit) {
+    portENTER_CRITICAL(&_mux);
+    gpio_set_level(_pin, 0);
+    esp_rom_delay_us(bit ? 6 : 60);
+    gpio_set_level(_pin, 1);
+    portEXIT_CRITICAL(&_mux);
+
+    esp_rom_delay_us(bit ? 64 : 10);
+}
+
+bool OneWireGpioTransport::readBit() {
+    portENTER_CRITICAL(&_mux);
+    gpio_set_level(_pin, 0);
+    esp_rom_delay_us(6);
+    gpio_set_level(_pin, 1);
+    esp_rom_delay_us(9);
+    bool bit = gpio_get_level(_pin);
+    portEXIT_CRITICAL(&_mux);
+
+    esp_rom_delay_us(55);
+    return bit;
+}
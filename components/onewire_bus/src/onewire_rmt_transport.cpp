@@ -0,0 +1,192 @@
+#include "onewire_rmt_transport.hpp"
+
+#include <cstring>
+
+#include "esp_attr.h"
+#include "esp_log.h"
+
+static const char* TAG = "onewire_rmt";
+
+// 1 tick = 1 us
+constexpr uint32_t RMT_RESOLUTION_HZ = 1000000;
+
+// Slot timing in microseconds
+constexpr uint16_t RESET_LOW_US = 480;
+constexpr uint16_t RESET_RELEASE_US = 480;
+constexpr uint16_t PRESENCE_MIN_US = 30;
+constexpr uint16_t SLOT_START_US = 6;
+constexpr uint16_t SLOT_BIT0_LOW_US = 60;
+constexpr uint16_t SLOT_TOTAL_US = 70;
+constexpr uint16_t READ_SAMPLE_US = 15;
+
+// Anything below the glitch filter is noise; idle longer than the reset pulse ends a receive
+constexpr uint32_t RX_MIN_NS = 1000;
+constexpr uint32_t RX_MAX_NS = (RESET_LOW_US + 20) * 1000;
+constexpr int TRANSFER_TIMEOUT_MS = 50;
+
+static const rmt_symbol_word_t SYMBOL_RESET = {
+    {RESET_LOW_US, 0, RESET_RELEASE_US, 1},
+};
+static const rmt_symbol_word_t SYMBOL_BIT0 = {
+    {SLOT_BIT0_LOW_US, 0, SLOT_TOTAL_US - SLOT_BIT0_LOW_US, 1},
+};
+static const rmt_symbol_word_t SYMBOL_BIT1 = {
+    {SLOT_START_US, 0, SLOT_TOTAL_US - SLOT_START_US, 1},
+};
+
+static const rmt_transmit_config_t TX_CONFIG = {
+    .loop_count = 0,
+    .flags = {.eot_level = 1},
+};
+
+static const rmt_receive_config_t RX_CONFIG = {
+    .signal_range_min_ns = RX_MIN_NS,
+    .signal_range_max_ns = RX_MAX_NS,
+};
+
+OneWireRmtTransport::OneWireRmtTransport(gpio_num_t pin) : _pin(pin) {}
+
+OneWireRmtTransport::~OneWireRmtTransport() {
+    if (_tx_channel) {
+        rmt_disable(_tx_channel);
+        rmt_del_channel(_tx_channel);
+    }
+    if (_rx_channel) {
+        rmt_disable(_rx_channel);
+        rmt_del_channel(_rx_channel);
+    }
+    if (_copy_encoder) rmt_del_encoder(_copy_encoder);
+    if (_bytes_encoder) rmt_del_encoder(_bytes_encoder);
+    if (_rx_queue) vQueueDelete(_rx_queue);
+}
+
+esp_err_t OneWireRmtTransport::init() {
+    // RX first, then TX looped back onto the same open-drain pin
+    rmt_rx_channel_config_t rx_config = {};
+    rx_config.gpio_num = _pin;
+    rx_config.clk_src = RMT_CLK_SRC_DEFAULT;
+    rx_config.resolution_hz = RMT_RESOLUTION_HZ;
+    rx_config.mem_block_symbols = 64;
+    esp_err_t err = rmt_new_rx_channel(&rx_config, &_rx_channel);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create RX channel: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    rmt_tx_channel_config_t tx_config = {};
+    tx_config.gpio_num = _pin;
+    tx_config.clk_src = RMT_CLK_SRC_DEFAULT;
+    tx_config.resolution_hz = RMT_RESOLUTION_HZ;
+    tx_config.mem_block_symbols = 64;
+    tx_config.trans_queue_depth = 4;
+    tx_config.flags.io_loop_back = 1;
+    tx_config.flags.io_od_mode = 1;
+    err = rmt_new_tx_channel(&tx_config, &_tx_channel);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create TX channel: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    rmt_copy_encoder_config_t copy_config = {};
+    err = rmt_new_copy_encoder(&copy_config, &_copy_encoder);
+    if (err != ESP_OK) return err;
+
+    rmt_bytes_encoder_config_t bytes_config = {};
+    bytes_config.bit0 = SYMBOL_BIT0;
+    bytes_config.bit1 = SYMBOL_BIT1;
+    bytes_config.flags.msb_first = 0;
+    err = rmt_new_bytes_encoder(&bytes_config, &_bytes_encoder);
+    if (err != ESP_OK) return err;
+
+    _rx_queue = xQueueCreate(1, sizeof(size_t));
+    if (!_rx_queue) return ESP_ERR_NO_MEM;
+
+    rmt_rx_event_callbacks_t callbacks = {};
+    callbacks.on_recv_done = onRxDone;
+    err = rmt_rx_register_event_callbacks(_rx_channel, &callbacks, _rx_queue);
+    if (err != ESP_OK) return err;
+
+    err = rmt_enable(_rx_channel);
+    if (err == ESP_OK) err = rmt_enable(_tx_channel);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to enable channels: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    ESP_LOGI(TAG, "RMT 1-Wire ready on GPIO %d", _pin);
+    return ESP_OK;
+}
+
+bool IRAM_ATTR OneWireRmtTransport::onRxDone(rmt_channel_handle_t channel,
+                                             const rmt_rx_done_event_data_t* edata,
+                                             void* user_ctx) {
+    BaseType_t woken = pdFALSE;
+    size_t num_symbols = edata->num_symbols;
+    xQueueSendFromISR(static_cast<QueueHandle_t>(user_ctx), &num_symbols, &woken);
+    return woken == pdTRUE;
+}
+
+size_t OneWireRmtTransport::transmitAndReceive(rmt_encoder_handle_t encoder, const void* payload,
+                                               size_t len) {
+    xQueueReset(_rx_queue);
+    if (rmt_receive(_rx_channel, _rx_symbols, sizeof(_rx_symbols), &RX_CONFIG) != ESP_OK) {
+        return 0;
+    }
+    if (rmt_transmit(_tx_channel, encoder, payload, len, &TX_CONFIG) != ESP_OK) {
+        return 0;
+    }
+
+    size_t num_symbols = 0;
+    if (xQueueReceive(_rx_queue, &num_symbols, pdMS_TO_TICKS(TRANSFER_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "Receive timed out");
+        return 0;
+    }
+    return num_symbols;
+}
+
+bool OneWireRmtTransport::reset() {
+    size_t n = transmitAndReceive(_copy_encoder, &SYMBOL_RESET, sizeof(SYMBOL_RESET));
+
+    // Symbol 0 is our own low pulse; a device answers with a second low pulse
+    return n >= 2 && _rx_symbols[0].level0 == 0 && _rx_symbols[1].level0 == 0 &&
+           _rx_symbols[1].duration0 >= PRESENCE_MIN_US;
+}
+
+void OneWireRmtTransport::writeBit(bool bit) {
+    rmt_transmit(_tx_channel, _copy_encoder, bit ? &SYMBOL_BIT1 : &SYMBOL_BIT0,
+                 sizeof(rmt_symbol_word_t), &TX_CONFIG);
+    rmt_tx_wait_all_done(_tx_channel, TRANSFER_TIMEOUT_MS);
+}
+
+bool OneWireRmtTransport::readBit() {
+    size_t n = transmitAndReceive(_copy_encoder, &SYMBOL_BIT1, sizeof(SYMBOL_BIT1));
+
+    // A device writing 0 stretches the low phase past the sample point
+    return n >= 1 && _rx_symbols[0].duration0 < READ_SAMPLE_US;
+}
+
+void OneWireRmtTransport::writeBytes(const uint8_t* data, size_t len) {
+    rmt_transmit(_tx_channel, _bytes_encoder, data, len, &TX_CONFIG);
+    rmt_tx_wait_all_done(_tx_channel, TRANSFER_TIMEOUT_MS);
+}
+
+void OneWireRmtTransport::readBytes(uint8_t* data, size_t len) {
+    // Read slots are write-1 slots; the RX channel holds one block, so go in chunks
+    static const uint8_t ones[ONEWIRE_RMT_RX_CHUNK_BYTES] = {0xFF, 0xFF, 0xFF, 0xFF,
+                                                             0xFF, 0xFF, 0xFF};
+
+    while (len > 0) {
+        size_t chunk = len < ONEWIRE_RMT_RX_CHUNK_BYTES ? len : ONEWIRE_RMT_RX_CHUNK_BYTES;
+        size_t n = transmitAndReceive(_bytes_encoder, ones, chunk);
+
+        std::memset(data, 0, chunk);
+        for (size_t bit = 0; bit < chunk * 8 && bit < n; bit++) {
+            if (_rx_symbols[bit].duration0 < READ_SAMPLE_US) {
+                data[bit / 8] |= (1 << (bit % 8));
+            }
+        }
+
+        data += chunk;
+        len -= chunk;
+    }
+}
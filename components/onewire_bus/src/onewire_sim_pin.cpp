@@ -0,0 +1,87 @@
+#include "onewire_sim_pin.hpp"
+
+#include <cmath>
+
+#include "esp_log.h"
+#include "onewire_crc.hpp"
+
+static const char* TAG = "onewire_sim";
+
+constexpr uint8_t DS18B20_FAMILY = 0x28;
+constexpr double DRIFT_PERIOD_S = 600.0;
+
+// Family code, 48-bit serial and CRC, as burned into a real part
+static OneWireAddress simRom(uint64_t serial) {
+    uint8_t bytes[7] = {DS18B20_FAMILY};
+    for (int i = 0; i < 6; i++) bytes[i + 1] = static_cast<uint8_t>(serial >> (8 * i));
+
+    OneWireAddress rom = static_cast<OneWireAddress>(oneWireCrc8(bytes, sizeof(bytes))) << 56;
+    for (int i = 0; i < 7; i++) rom |= static_cast<OneWireAddress>(bytes[i]) << (8 * i);
+    return rom;
+}
+
+void OneWireSimPin::attachSensors(gpio_num_t pin, size_t count) {
+    if (count == 0) return;
+
+    static FakeOneWireTransport bus;
+    static OneWireSimPin sim(bus);
+    for (size_t i = 0; i < count; i++) bus.addDevice(simRom(0x5EED00 + i), 0);
+    sim.drift_count_ = count;
+    sim.drift_start_ = std::chrono::steady_clock::now();
+    sim.updateDrift();
+
+    hostGpioAttach(pin, &sim);
+    ESP_LOGI(TAG, "%u simulated DS18B20 on GPIO %d", (unsigned)count, pin);
+}
+
+void OneWireSimPin::updateDrift() {
+    auto elapsed = std::chrono::steady_clock::now() - drift_start_;
+    double t = std::chrono::duration<double>(elapsed).count();
+    for (size_t i = 0; i < drift_count_; i++) {
+        double celsius = 21.0 + 1.5 * i + 2.0 * std::sin(2.0 * M_PI * t / DRIFT_PERIOD_S + i);
+        bus_.setTemperature(i, static_cast<int16_t>(std::lround(celsius * 16)));
+    }
+}
+
+void OneWireSimPin::drive(bool level, uint64_t now_us) {
+    if (!level) {
+        // An unsampled short slot was a write-1
+        if (slot_ == Slot::Short) bus_.writeBit(true);
+        slot_ = Slot::Idle;
+        master_low_ = true;
+        fall_us_ = now_us;
+        return;
+    }
+
+    if (!master_low_) return;
+    master_low_ = false;
+
+    uint64_t low_us = now_us - fall_us_;
+    if (low_us >= RESET_MIN_US) {
+        if (drift_count_) updateDrift();
+        presence_ = bus_.reset();
+        rise_us_ = now_us;
+        slot_ = Slot::Presence;
+    } else if (low_us >= WRITE0_MIN_US) {
+        bus_.writeBit(false);
+    } else {
+        slot_ = Slot::Short;
+    }
+}
+
+bool OneWireSimPin::sense(uint64_t now_us) {
+    switch (slot_) {
+        case Slot::Presence: {
+            uint64_t since = now_us - rise_us_;
+            return !(presence_ && since >= PRESENCE_START_US && since < PRESENCE_END_US);
+        }
+        case Slot::Short:
+            read_bit_ = bus_.readBit();
+            slot_ = Slot::Read;
+            [[fallthrough]];
+        case Slot::Read:
+            return read_bit_ || now_us - fall_us_ >= READ_HOLD_US;
+        default:
+            return true;
+    }
+}
@@ -0,0 +1,82 @@
+#include <stdio.h>
+
+#include "unity.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void setUp(void) {
+    // Set up before every test
+}
+
+void tearDown(void) {
+    // Clean up after every test
+}
+
+// 1-Wire bus tests
+void test_search_finds_all_devices();
+void test_search_on_empty_bus_finds_nothing();
+void test_match_rom_reads_addressed_sensor();
+void test_busy_flag_tracks_conversion();
+void test_set_resolution_writes_config_register();
+void test_commands_fail_without_presence();
+void test_crc8_matches_datasheet_rom();
+void test_search_drops_rom_with_bad_crc();
+void test_crc_failure_is_retried_by_reread();
+void test_missing_sensor_fails_after_retries();
+void test_gpio_transport_on_simulated_pin();
+
+#ifdef __cplusplus
+}
+#endif
+
+TEST_CASE("Search: Finds all devices", "[onewire]") {
+    test_search_finds_all_devices();
+}
+
+TEST_CASE("Search: Empty bus finds nothing", "[onewire]") {
+    test_search_on_empty_bus_finds_nothing();
+}
+
+TEST_CASE("DS18B20: Match ROM reads addressed sensor", "[ds18b20]") {
+    test_match_rom_reads_addressed_sensor();
+}
+
+TEST_CASE("DS18B20: Busy flag tracks conversion", "[ds18b20]") {
+    test_busy_flag_tracks_conversion();
+}
+
+TEST_CASE("DS18B20: Resolution writes config register", "[ds18b20]") {
+    test_set_resolution_writes_config_register();
+}
+
+TEST_CASE("DS18B20: Commands fail without presence", "[ds18b20]") {
+    test_commands_fail_without_presence();
+}
+
+TEST_CASE("CRC: Table matches datasheet ROM", "[crc]") {
+    test_crc8_matches_datasheet_rom();
+}
+
+TEST_CASE("Search: Drops ROM with bad CRC", "[onewire]") {
+    test_search_drops_rom_with_bad_crc();
+}
+
+TEST_CASE("DS18B20: CRC failure is retried by re-read", "[ds18b20]") {
+    test_crc_failure_is_retried_by_reread();
+}
+
+TEST_CASE("DS18B20: Missing sensor fails after retries", "[ds18b20]") {
+    test_missing_sensor_fails_after_retries();
+}
+
+TEST_CASE("GPIO: Transport drives simulated bus", "[onewire]") {
+    test_gpio_transport_on_simulated_pin();
+}
+
+void app_main(void) {
+    UNITY_BEGIN();
+    unity_run_all_tests();
+    UNITY_END();
+}
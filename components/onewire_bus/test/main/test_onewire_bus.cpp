@@ -0,0 +1,191 @@
+#include <cstring>
+
+#include "ds18b20.hpp"
+#include "fake_onewire_transport.hpp"
+#include "onewire_bus.hpp"
+#include "onewire_crc.hpp"
+#include "onewire_gpio_transport.hpp"
+#include "onewire_sim_pin.hpp"
+#include "unity.h"
+
+/// @brief Build a DS18B20 ROM code with a valid CRC byte from a 48-bit serial.
+static OneWireAddress makeRom(uint64_t serial) {
+    uint8_t bytes[7] = {DS18B20::FAMILY_CODE};
+    for (int i = 0; i < 6; i++) bytes[i + 1] = static_cast<uint8_t>(serial >> (8 * i));
+
+    OneWireAddress rom = static_cast<OneWireAddress>(oneWireCrc8(bytes, sizeof(bytes))) << 56;
+    for (int i = 0; i < 7; i++) rom |= static_cast<OneWireAddress>(bytes[i]) << (8 * i);
+    return rom;
+}
+
+// Serials diverge at different bit depths to exercise search
+static const OneWireAddress ROM_A = makeRom(0x000000123456);
+static const OneWireAddress ROM_B = makeRom(0x00000012345A);
+static const OneWireAddress ROM_C = makeRom(0x000087654300);
+
+static bool containsAddress(const OneWireBus& bus, OneWireAddress address) {
+    for (size_t i = 0; i < bus.deviceCount(); i++) {
+        if (bus.device(i) == address) return true;
+    }
+    return false;
+}
+
+/// @brief Verifies Search ROM enumerates every device exactly once.
+extern "C" void test_search_finds_all_devices() {
+    FakeOneWireTransport transport;
+    transport.addDevice(ROM_A, 0);
+    transport.addDevice(ROM_B, 0);
+    transport.addDevice(ROM_C, 0);
+    OneWireBus bus(transport);
+
+    TEST_ASSERT_EQUAL(3, bus.searchDevices());
+    TEST_ASSERT_TRUE(containsAddress(bus, ROM_A));
+    TEST_ASSERT_TRUE(containsAddress(bus, ROM_B));
+    TEST_ASSERT_TRUE(containsAddress(bus, ROM_C));
+    TEST_ASSERT_EQUAL_HEX8(0x28, OneWireBus::familyCode(bus.device(0)));
+}
+
+/// @brief Verifies an empty bus yields no devices.
+extern "C" void test_search_on_empty_bus_finds_nothing() {
+    FakeOneWireTransport transport;
+    OneWireBus bus(transport);
+
+    TEST_ASSERT_EQUAL(0, bus.searchDevices());
+    TEST_ASSERT_EQUAL(0, bus.deviceCount());
+}
+
+/// @brief Verifies Match ROM reads back the addressed sensor only.
+extern "C" void test_match_rom_reads_addressed_sensor() {
+    FakeOneWireTransport transport;
+    transport.addDevice(ROM_A, 25 * 16);   // 25.0 °C
+    transport.addDevice(ROM_B, -10 * 16);  // -10.0 °C
+    OneWireBus bus(transport);
+
+    DS18B20 sensor_a(bus, ROM_A);
+    DS18B20 sensor_b(bus, ROM_B);
+    TEST_ASSERT_TRUE(DS18B20::startConversionAll(bus));
+
+    float temp = 0.0f;
+    TEST_ASSERT_TRUE(sensor_a.fetchResult(temp));
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, temp);
+    TEST_ASSERT_TRUE(sensor_b.fetchResult(temp));
+    TEST_ASSERT_EQUAL_FLOAT(-10.0f, temp);
+}
+
+/// @brief Verifies the busy flag reads 0 while converting and 1 once done.
+extern "C" void test_busy_flag_tracks_conversion() {
+    FakeOneWireTransport transport;
+    transport.addDevice(ROM_A, 0, 2);
+    OneWireBus bus(transport);
+    DS18B20 sensor(bus);
+
+    TEST_ASSERT_TRUE(sensor.startConversion());
+    TEST_ASSERT_FALSE(sensor.isConversionDone());
+    TEST_ASSERT_FALSE(sensor.isConversionDone());
+    TEST_ASSERT_TRUE(sensor.isConversionDone());
+}
+
+/// @brief Verifies setResolution writes the config register and scales conversion time.
+extern "C" void test_set_resolution_writes_config_register() {
+    FakeOneWireTransport transport;
+    transport.addDevice(ROM_A, 0);
+    OneWireBus bus(transport);
+    DS18B20 sensor(bus, ROM_A);
+
+    TEST_ASSERT_TRUE(sensor.setResolution(10));
+    TEST_ASSERT_EQUAL_HEX8(0x3F, transport.scratchpadByte(0, 4));
+    TEST_ASSERT_EQUAL(188, sensor.conversionTimeMs());
+    TEST_ASSERT_FALSE(sensor.setResolution(13));
+}
+
+/// @brief Verifies commands fail cleanly when nothing answers the reset pulse.
+extern "C" void test_commands_fail_without_presence() {
+    FakeOneWireTransport transport;
+    OneWireBus bus(transport);
+    DS18B20 sensor(bus);
+
+    float temp = 0.0f;
+    TEST_ASSERT_FALSE(sensor.startConversion());
+    TEST_ASSERT_FALSE(sensor.fetchResult(temp));
+    TEST_ASSERT_FALSE(DS18B20::startConversionAll(bus));
+}
+
+/// @brief Verifies the generated CRC8 table against the DS18B20 datasheet example.
+extern "C" void test_crc8_matches_datasheet_rom() {
+    // ROM 0x A2 00 00 00 01 B8 1C 02 from the Maxim CRC application note
+    const uint8_t rom[8] = {0x02, 0x1C, 0xB8, 0x01, 0x00, 0x00, 0x00, 0xA2};
+    TEST_ASSERT_EQUAL_HEX8(0xA2, oneWireCrc8(rom, 7));
+    TEST_ASSERT_EQUAL_HEX8(0x00, oneWireCrc8(rom, 8));
+}
+
+/// @brief Verifies search drops devices whose ROM fails CRC.
+extern "C" void test_search_drops_rom_with_bad_crc() {
+    FakeOneWireTransport transport;
+    transport.addDevice(ROM_A, 0);
+    transport.addDevice(ROM_B ^ (1ULL << 60), 0);
+    OneWireBus bus(transport);
+
+    TEST_ASSERT_EQUAL(1, bus.searchDevices());
+    TEST_ASSERT_EQUAL_UINT64(ROM_A, bus.device(0));
+}
+
+/// @brief Verifies a glitched scratchpad is re-read without a new conversion.
+extern "C" void test_crc_failure_is_retried_by_reread() {
+    FakeOneWireTransport transport;
+    transport.addDevice(ROM_A, 21 * 16);
+    OneWireBus bus(transport);
+    DS18B20 sensor(bus, ROM_A);
+
+    TEST_ASSERT_TRUE(sensor.startConversion());
+    transport.corruptNextRead(0);
+
+    float temp = 0.0f;
+    TEST_ASSERT_TRUE(sensor.fetchResult(temp));
+    TEST_ASSERT_EQUAL_FLOAT(21.0f, temp);
+    TEST_ASSERT_EQUAL(1, sensor.stats().crc_errors);
+    TEST_ASSERT_EQUAL(1, sensor.stats().retries);
+    TEST_ASSERT_EQUAL(1, sensor.stats().reads);
+    TEST_ASSERT_EQUAL(0, sensor.stats().failures);
+}
+
+/// @brief Verifies a missing sensor is reported as a failure, never as a reading.
+extern "C" void test_missing_sensor_fails_after_retries() {
+    FakeOneWireTransport transport;
+    transport.addDevice(ROM_A, 0);
+    OneWireBus bus(transport);
+    DS18B20 absent(bus, ROM_B);
+    absent.setRetryLimit(1);
+
+    float temp = 123.0f;
+    TEST_ASSERT_FALSE(absent.fetchResult(temp));
+    TEST_ASSERT_EQUAL_FLOAT(123.0f, temp);
+    TEST_ASSERT_EQUAL(2, absent.stats().crc_errors);
+    TEST_ASSERT_EQUAL(1, absent.stats().failures);
+}
+
+/// @brief Verifies the GPIO transport's slot timing against the pin-level bus model.
+extern "C" void test_gpio_transport_on_simulated_pin() {
+    FakeOneWireTransport model;
+    model.addDevice(ROM_A, 25 * 16);
+    model.addDevice(ROM_C, -10 * 16 - 8);  // -10.5 °C
+    OneWireSimPin sim(model);
+    TEST_ASSERT_EQUAL(ESP_OK, hostGpioAttach(GPIO_NUM_4, &sim));
+
+    OneWireGpioTransport transport(GPIO_NUM_4);
+    OneWireBus bus(transport);
+    TEST_ASSERT_EQUAL(2, bus.searchDevices());
+    TEST_ASSERT_TRUE(containsAddress(bus, ROM_A));
+    TEST_ASSERT_TRUE(containsAddress(bus, ROM_C));
+
+    DS18B20 sensor(bus, ROM_C);
+    TEST_ASSERT_TRUE(sensor.setResolution(11));
+    TEST_ASSERT_EQUAL_HEX8(0x5F, model.scratchpadByte(1, 4));
+    TEST_ASSERT_TRUE(DS18B20::startConversionAll(bus));
+
+    float temp = 0.0f;
+    TEST_ASSERT_TRUE(sensor.fetchResult(temp));
+    TEST_ASSERT_EQUAL_FLOAT(-10.5f, temp);
+    TEST_ASSERT_EQUAL(0, sensor.stats().crc_errors);
+
+    hostGpioAttach(GPIO_NUM_4, nullptr);
+}
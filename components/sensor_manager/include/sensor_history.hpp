@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "sdkconfig.h"
+
+/**
+ * @brief Downsampling tier a history query is served from.
+ */
+enum class HistoryTier : uint8_t {
+    Raw,     ///< Every sample
+    Minute,  ///< 1-minute min/max/avg
+    Hour,    ///< 1-hour min/max/avg
+};
+
+/**
+ * @brief One point returned by a history query. Values are in centi-degrees °C.
+ */
+struct HistoryPoint {
+    uint32_t time_s;  ///< Start of the point's window, seconds since boot
+    int16_t min;      ///< Minimum over the window
+    int16_t max;      ///< Maximum over the window
+    int16_t avg;      ///< Mean over the window
+};
+
+/**
+ * @brief Time range and resolution of a history query.
+ */
+struct HistoryQuery {
+    uint32_t from_s;  ///< Inclusive start, seconds since boot
+    uint32_t to_s;    ///< Inclusive end, seconds since boot
+    uint32_t step_s;  ///< Requested resolution; 0 returns the raw tier unchanged
+};
+
+/**
+ * @brief Resume point for a query that is read in several pieces.
+ */
+struct HistoryCursor {
+    uint64_t next_index = 0;  ///< Absolute index of the next entry to visit
+    bool done = false;        ///< Set once the range has been fully returned
+};
+
+/**
+ * @brief Fixed-capacity ring whose entries store their time as a delta from
+ *        the previous entry, in units of UNIT_S seconds.
+ *
+ * Only the oldest entry's absolute time is kept; it is advanced on eviction.
+ * Gaps longer than 65535 units are clamped.
+ */
+template <typename Entry, size_t N, uint32_t UNIT_S>
+class DeltaRing {
+   public:
+    void push(uint32_t time_s, Entry entry) {
+        if (count_ == 0) {
+            oldest_time_s_ = time_s;
+            entry.delta = 0;
+        } else {
+            uint32_t delta = (time_s - newest_time_s_) / UNIT_S;
+            entry.delta = static_cast<uint16_t>(delta > UINT16_MAX ? UINT16_MAX : delta);
+        }
+
+        if (count_ == N) {
+            // Oldest is dropped; its successor's delta rebases the ring
+            tail_ = (tail_ + 1) % N;
+            oldest_time_s_ += entries_[tail_].delta * UNIT_S;
+            count_--;
+        }
+
+        entries_[(tail_ + count_) % N] = entry;
+        count_++;
+        total_++;
+        newest_time_s_ = time_s;
+    }
+
+    /**
+     * @brief Visit entries oldest first, starting at an absolute index.
+     * @param fn Called as fn(index, time_s, entry); return false to stop
+     * @return true if every remaining entry was visited
+     */
+    template <typename Fn>
+    bool walk(uint64_t from_index, Fn&& fn) const {
+        uint64_t index = total_ - count_;
+        uint32_t time_s = oldest_time_s_;
+        for (size_t i = 0; i < count_; i++, index++) {
+            const Entry& entry = entries_[(tail_ + i) % N];
+            if (i > 0) time_s += entry.delta * UNIT_S;
+            if (index < from_index) continue;
+            if (!fn(index, time_s, entry)) return false;
+        }
+        return true;
+    }
+
+    size_t size() const {
+        return count_;
+    }
+
+   private:
+    Entry entries_[N] = {};
+    size_t tail_ = 0;
+    size_t count_ = 0;
+    uint64_t total_ = 0;
+    uint32_t oldest_time_s_ = 0;
+    uint32_t newest_time_s_ = 0;
+};
+
+/**
+ * @brief Allocation-free temperature history for one sensor.
+ *
+ * Keeps raw samples plus 1-minute and 1-hour min/max/avg aggregates in static
+ * rings sized through Kconfig (Component config → Sensor history).
+ */
+class SensorHistory {
+   public:
+    /**
+     * @brief Append a sample and roll it into the minute and hour aggregates.
+     * @param time_s Sample time, seconds since boot (non-decreasing)
+     * @param temperature Temperature in °C
+     */
+    void record(uint32_t time_s, float temperature);
+
+    /**
+     * @brief Read points in [from_s, to_s] at roughly step_s resolution, oldest first.
+     *
+     * The coarsest tier not exceeding step_s is used, and its entries are merged
+     * into step-aligned windows. Call repeatedly with the same cursor until
+     * cursor.done to page through large ranges with a fixed-size buffer.
+     *
+     * @return Number of points written to out
+     */
+    size_t query(const HistoryQuery& query, HistoryCursor& cursor, HistoryPoint* out,
+                 size_t max_points) const;
+
+    /**
+     * @brief Tier a query with the given step is served from.
+     */
+    static HistoryTier tierForStep(uint32_t step_s);
+
+   private:
+    struct RawEntry {
+        int16_t value;   ///< Centi-degrees °C
+        uint16_t delta;  ///< Seconds since previous entry
+    };
+
+    struct AggregateEntry {
+        int16_t min;
+        int16_t max;
+        int16_t avg;
+        uint16_t delta;  ///< Tier units since previous entry
+    };
+
+    struct Accumulator {
+        uint32_t window_start_s = 0;
+        int32_t sum = 0;
+        uint32_t count = 0;
+        int16_t min = 0;
+        int16_t max = 0;
+
+        void add(int16_t value);
+        AggregateEntry take();
+    };
+
+    DeltaRing<RawEntry, CONFIG_SENSOR_HISTORY_RAW_SAMPLES, 1> raw_;
+    DeltaRing<AggregateEntry, CONFIG_SENSOR_HISTORY_MINUTE_SAMPLES, 60> minute_;
+    DeltaRing<AggregateEntry, CONFIG_SENSOR_HISTORY_HOUR_SAMPLES, 3600> hour_;
+    Accumulator minute_acc_;
+    Accumulator hour_acc_;
+    mutable std::mutex mutex_;
+
+    template <typename Ring>
+    static void rollInto(Ring& ring, Accumulator& acc, uint32_t window_s, uint32_t time_s,
+                         int16_t value);
+
+    template <typename Ring, typename ToPoint>
+    size_t queryRing(const Ring& ring, const HistoryQuery& query, HistoryCursor& cursor,
+                     HistoryPoint* out, size_t max_points, ToPoint&& to_point) const;
+};
@@ -1,21 +1,56 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <mutex>
 
 #include "driver/gpio.h"
+#include "ds18b20.hpp"
+#include "onewire_bus.hpp"
+#include "sensor_history.hpp"
+#include "sensor_notifier.hpp"
+#include "sensor_snapshot.hpp"
+
+#define SENSOR_MAX_COUNT ONEWIRE_MAX_DEVICES
 
 class DS18B20SensorManager {
    public:
-    static void init(gpio_num_t pin);
+    static void init(gpio_num_t pin, uint8_t resolution = 12, uint32_t interval_ms = 2000);
+
+    // Blocks until the sensor task has published its first sweep; false on timeout.
+    static bool waitForFirstSweep(uint32_t timeout_ms);
+
+    static size_t getSensorCount();
+
+    static OneWireAddress getSensorAddress(size_t index);
+
+    // Never blocks the sensor task; value, status and timestamp come from one sample.
+    static SensorSnapshot getSnapshot(size_t index = 0);
+
+    static float getLastTemperature(size_t index = 0);
+
+    static bool getSensorStatus(size_t index = 0);
+
+    static DS18B20Stats getSensorStats(size_t index = 0);
 
-    static float getLastTemperature();
+    // History is kept for the first CONFIG_SENSOR_HISTORY_CHANNELS sensors; nullptr otherwise.
+    static const SensorHistory* getHistory(size_t index = 0);
 
-    static bool getSensorStatus();
+    // Every published sample is also pushed to the notifier's subscribers.
+    static SensorNotifier& getNotifier();
 
    private:
     static void sensorTask(void* arg);
+    static void discoverSensors();
 
-    static float last_temperature_;
-    static bool sensor_ok_;
-    static std::mutex mutex_;
+    static SnapshotPublisher snapshots_[SENSOR_MAX_COUNT];
+    static DS18B20Stats sensor_stats_[SENSOR_MAX_COUNT];
+    static SensorHistory history_[CONFIG_SENSOR_HISTORY_CHANNELS];
+    static SensorNotifier notifier_;
+    static std::atomic<size_t> sensor_count_;
+    static std::atomic<uint32_t> sweeps_;
+    static uint8_t resolution_;
+    static uint32_t interval_ms_;
+    static std::mutex stats_mutex_;
 };
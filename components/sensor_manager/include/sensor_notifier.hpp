@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include "sensor_snapshot.hpp"
+
+/**
+ * @brief A sample published to subscribers.
+ */
+struct SensorEvent {
+    uint8_t sensor;           ///< Index in discovery order
+    SensorSnapshot snapshot;  ///< The sample as readers see it
+};
+
+/**
+ * @brief Fans samples out to a bounded set of subscriber queues.
+ *
+ * publish() never blocks: when a subscriber's queue is full its oldest event
+ * is discarded to make room, so a slow consumer loses stale samples instead
+ * of stalling the sensor task.
+ */
+class SensorNotifier {
+   public:
+    /**
+     * @brief Register a subscriber.
+     * @param waiter Task woken with xTaskNotifyGive() after every event, or nullptr
+     * @return Queue of SensorEvent to read from, or nullptr when all slots are taken
+     */
+    QueueHandle_t subscribe(TaskHandle_t waiter = nullptr);
+
+    /**
+     * @brief Remove a subscriber and delete its queue.
+     */
+    void unsubscribe(QueueHandle_t queue);
+
+    /**
+     * @brief Deliver an event to every subscriber without blocking.
+     */
+    void publish(const SensorEvent& event);
+
+    size_t subscriberCount() const;
+
+    /**
+     * @brief Events discarded across all subscribers because a queue was full.
+     */
+    uint32_t droppedEvents() const;
+
+   private:
+    struct Subscriber {
+        QueueHandle_t queue;
+        TaskHandle_t waiter;
+    };
+
+    Subscriber subscribers_[CONFIG_SENSOR_NOTIFIER_MAX_SUBSCRIBERS] = {};
+    size_t count_ = 0;
+    mutable std::mutex mutex_;
+    std::atomic<uint32_t> dropped_{0};
+};
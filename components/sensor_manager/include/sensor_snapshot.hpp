@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief One consistent sensor sample as seen by readers.
+ */
+struct SensorSnapshot {
+    float temperature;     ///< Last good temperature in °C
+    bool ok;               ///< Whether the latest read succeeded
+    int64_t timestamp_us;  ///< esp_timer time of the latest read attempt
+    uint32_t sequence;     ///< Increments on every publish; 0 means never published
+};
+
+/**
+ * @brief Single-writer, multi-reader snapshot slot ring.
+ *
+ * Each slot is a seqlock: the writer makes the slot's version odd, writes the
+ * fields, then makes it even again. A reader copies the slot named by the
+ * latest sequence and keeps the copy only if that version was even and
+ * unchanged around it. The writer always fills the slot after the latest one,
+ * so read() retries only if the writer wraps around the ring during a copy.
+ * Readers never block the writer, but read() is not wait-free.
+ */
+class SnapshotPublisher {
+   public:
+    void publish(float temperature, bool ok, int64_t timestamp_us) {
+        uint32_t seq = published_.load(std::memory_order_relaxed) + 1;
+        Slot& slot = slots_[seq % SLOTS];
+        uint32_t version = slot.version.load(std::memory_order_relaxed);
+        slot.version.store(version + 1, std::memory_order_relaxed);
+        // Keeps the field writes below from becoming visible before the odd version
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.data.temperature = temperature;
+        slot.data.ok = ok;
+        slot.data.timestamp_us = timestamp_us;
+        slot.data.sequence = seq;
+        slot.version.store(version + 2, std::memory_order_release);
+        published_.store(seq, std::memory_order_release);
+    }
+
+    SensorSnapshot read() const {
+        while (true) {
+            const Slot& slot = slots_[published_.load(std::memory_order_acquire) % SLOTS];
+            uint32_t version = slot.version.load(std::memory_order_acquire);
+            if (version & 1) continue;
+            SensorSnapshot copy = slot.data;
+            // Keeps the copy above from being read after the version re-check
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.version.load(std::memory_order_relaxed) == version) return copy;
+        }
+    }
+
+    uint32_t sequence() const {
+        return published_.load(std::memory_order_acquire);
+    }
+
+   private:
+    static constexpr uint32_t SLOTS = 4;
+
+    struct Slot {
+        std::atomic<uint32_t> version{0};  ///< Odd while the writer is filling data
+        SensorSnapshot data = {};
+    };
+
+    Slot slots_[SLOTS];
+    std::atomic<uint32_t> published_{0};
+};
@@ -0,0 +1,137 @@
+#include "sensor_history.hpp"
+
+#include <cmath>
+
+static int16_t toCentiDegrees(float temperature) {
+    float centi = std::round(temperature * 100.0f);
+    if (centi > INT16_MAX) return INT16_MAX;
+    if (centi < INT16_MIN) return INT16_MIN;
+    return static_cast<int16_t>(centi);
+}
+
+void SensorHistory::Accumulator::add(int16_t value) {
+    if (count == 0 || value < min) min = value;
+    if (count == 0 || value > max) max = value;
+    sum += value;
+    count++;
+}
+
+SensorHistory::AggregateEntry SensorHistory::Accumulator::take() {
+    AggregateEntry entry = {min, max, static_cast<int16_t>(sum / static_cast<int32_t>(count)), 0};
+    sum = 0;
+    count = 0;
+    return entry;
+}
+
+template <typename Ring>
+void SensorHistory::rollInto(Ring& ring, Accumulator& acc, uint32_t window_s, uint32_t time_s,
+                             int16_t value) {
+    uint32_t window_start = time_s - time_s % window_s;
+    if (acc.count > 0 && window_start != acc.window_start_s) {
+        ring.push(acc.window_start_s, acc.take());
+    }
+    if (acc.count == 0) acc.window_start_s = window_start;
+    acc.add(value);
+}
+
+void SensorHistory::record(uint32_t time_s, float temperature) {
+    int16_t value = toCentiDegrees(temperature);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    raw_.push(time_s, RawEntry{value, 0});
+    rollInto(minute_, minute_acc_, 60, time_s, value);
+    rollInto(hour_, hour_acc_, 3600, time_s, value);
+}
+
+HistoryTier SensorHistory::tierForStep(uint32_t step_s) {
+    if (step_s < 60) return HistoryTier::Raw;
+    if (step_s < 3600) return HistoryTier::Minute;
+    return HistoryTier::Hour;
+}
+
+template <typename Ring, typename ToPoint>
+size_t SensorHistory::queryRing(const Ring& ring, const HistoryQuery& query,
+                                HistoryCursor& cursor, HistoryPoint* out, size_t max_points,
+                                ToPoint&& to_point) const {
+    size_t n = 0;
+    bool out_full = false;
+
+    // Entries sharing a step-aligned window are merged into one pending point,
+    // which is only emitted once the next window starts or the range ends.
+    bool have_pending = false;
+    HistoryPoint pending = {};
+    int32_t pending_sum = 0;
+    int32_t pending_count = 0;
+    uint64_t pending_index = 0;
+
+    ring.walk(cursor.next_index, [&](uint64_t index, uint32_t time_s, const auto& entry) {
+        if (time_s < query.from_s) return true;
+        if (time_s > query.to_s) return false;
+
+        HistoryPoint point = to_point(time_s, entry);
+        if (query.step_s > 0) point.time_s = time_s - time_s % query.step_s;
+
+        if (have_pending && point.time_s == pending.time_s) {
+            if (point.min < pending.min) pending.min = point.min;
+            if (point.max > pending.max) pending.max = point.max;
+            pending_sum += point.avg;
+            pending_count++;
+            return true;
+        }
+
+        if (have_pending) {
+            if (n == max_points) {
+                out_full = true;
+                return false;
+            }
+            pending.avg = static_cast<int16_t>(pending_sum / pending_count);
+            out[n++] = pending;
+        }
+
+        pending = point;
+        pending_sum = point.avg;
+        pending_count = 1;
+        pending_index = index;
+        have_pending = true;
+        return true;
+    });
+
+    if (!out_full && have_pending) {
+        if (n < max_points) {
+            pending.avg = static_cast<int16_t>(pending_sum / pending_count);
+            out[n++] = pending;
+        } else {
+            out_full = true;
+        }
+    }
+
+    if (out_full) {
+        cursor.next_index = pending_index;
+    } else {
+        cursor.done = true;
+    }
+    return n;
+}
+
+size_t SensorHistory::query(const HistoryQuery& query, HistoryCursor& cursor, HistoryPoint* out,
+                            size_t max_points) const {
+    if (cursor.done || max_points == 0) return 0;
+
+    auto from_aggregate = [](uint32_t time_s, const AggregateEntry& entry) {
+        return HistoryPoint{time_s, entry.min, entry.max, entry.avg};
+    };
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    switch (tierForStep(query.step_s)) {
+        case HistoryTier::Raw:
+            return queryRing(raw_, query, cursor, out, max_points,
+                             [](uint32_t time_s, const RawEntry& entry) {
+                                 return HistoryPoint{time_s, entry.value, entry.value, entry.value};
+                             });
+        case HistoryTier::Minute:
+            return queryRing(minute_, query, cursor, out, max_points, from_aggregate);
+        case HistoryTier::Hour:
+        default:
+            return queryRing(hour_, query, cursor, out, max_points, from_aggregate);
+    }
+}
@@ -1,46 +1,197 @@
 #include "sensor_manager.hpp"
 
+#include <algorithm>
+
 #include "ds18b20.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "metrics.hpp"
+#include "onewire_gpio_transport.hpp"
+#if CONFIG_ONEWIRE_TRANSPORT_RMT
+#include "onewire_rmt_transport.hpp"
+#endif
+#if CONFIG_IDF_TARGET_LINUX
+#include "onewire_sim_pin.hpp"
+#endif
+
+static const char* TAG = "sensor_manager";
+
+// Poll step while waiting for the busy flag, the share of the nominal conversion
+// time slept before the first poll, and how far past the nominal time we keep
+// polling before declaring the bus stuck.
+constexpr uint32_t CONVERSION_POLL_MS = 10;
+constexpr uint32_t CONVERSION_FIRST_POLL_DIVISOR = 2;
+constexpr uint32_t CONVERSION_GRACE_MS = 100;
 
-static DS18B20* ds18b20_sensor = nullptr;
+static OneWireTransport* onewire_transport = nullptr;
+static OneWireBus* onewire_bus = nullptr;
+static DS18B20* ds18b20_sensors[SENSOR_MAX_COUNT] = {};
 
-float DS18B20SensorManager::last_temperature_ = 0.0f;
-bool DS18B20SensorManager::sensor_ok_ = false;
-std::mutex DS18B20SensorManager::mutex_;
+// A sweep is one conversion (94-750 ms by resolution) plus a scratchpad read per sensor
+static const uint32_t SWEEP_BOUNDS_US[] = {100000,  200000,  400000,  800000,
+                                           1000000, 1500000, 2000000, 5000000};
+static MetricHistogram sweep_duration("sensor_sweep_duration_seconds",
+                                      "Time from Convert T to the last sensor read",
+                                      SWEEP_BOUNDS_US,
+                                      sizeof(SWEEP_BOUNDS_US) / sizeof(SWEEP_BOUNDS_US[0]), 1e-6);
+static MetricCounter sensor_reads("sensor_reads_total", "Sensor reads attempted");
+static MetricCounter sensor_read_failures("sensor_read_failures_total",
+                                          "Sensor reads that returned no valid temperature");
 
-void DS18B20SensorManager::init(gpio_num_t pin) {
-    ds18b20_sensor = new DS18B20(pin);
+SnapshotPublisher DS18B20SensorManager::snapshots_[SENSOR_MAX_COUNT];
+DS18B20Stats DS18B20SensorManager::sensor_stats_[SENSOR_MAX_COUNT] = {};
+SensorHistory DS18B20SensorManager::history_[CONFIG_SENSOR_HISTORY_CHANNELS];
+SensorNotifier DS18B20SensorManager::notifier_;
+std::atomic<size_t> DS18B20SensorManager::sensor_count_{0};
+std::atomic<uint32_t> DS18B20SensorManager::sweeps_{0};
+uint8_t DS18B20SensorManager::resolution_ = 12;
+uint32_t DS18B20SensorManager::interval_ms_ = 2000;
+std::mutex DS18B20SensorManager::stats_mutex_;
+
+void DS18B20SensorManager::init(gpio_num_t pin, uint8_t resolution, uint32_t interval_ms) {
+#if CONFIG_IDF_TARGET_LINUX
+    OneWireSimPin::attachSensors(pin, CONFIG_ONEWIRE_SIM_DEVICES);
+#endif
+#if CONFIG_ONEWIRE_TRANSPORT_RMT
+    auto* rmt = new OneWireRmtTransport(pin);
+    if (rmt->init() == ESP_OK) {
+        onewire_transport = rmt;
+    } else {
+        ESP_LOGW(TAG, "RMT transport unavailable, falling back to GPIO");
+        delete rmt;
+    }
+#endif
+    if (!onewire_transport) onewire_transport = new OneWireGpioTransport(pin);
+
+    onewire_bus = new OneWireBus(*onewire_transport);
+    // The DS18B20 supports 9-12 bits; anything else would break the conversion timing
+    uint8_t clamped = std::clamp<uint8_t>(resolution, 9, 12);
+    if (clamped != resolution) {
+        ESP_LOGW(TAG, "Resolution %u bits out of range, using %u", resolution, clamped);
+    }
+    resolution_ = clamped;
+    interval_ms_ = interval_ms;
+    discoverSensors();
     xTaskCreate(sensorTask, "ds18b20_sensor_task", 4096, nullptr, 1, nullptr);
 }
 
-float DS18B20SensorManager::getLastTemperature() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return last_temperature_;
+void DS18B20SensorManager::discoverSensors() {
+    onewire_bus->searchDevices();
+
+    size_t count = 0;
+    for (size_t i = 0; i < onewire_bus->deviceCount() && count < SENSOR_MAX_COUNT; i++) {
+        OneWireAddress address = onewire_bus->device(i);
+        if (OneWireBus::familyCode(address) != DS18B20::FAMILY_CODE) continue;
+
+        delete ds18b20_sensors[count];
+        ds18b20_sensors[count] = new DS18B20(*onewire_bus, address);
+        if (!ds18b20_sensors[count]->setResolution(resolution_)) {
+            ESP_LOGW(TAG, "Sensor %u: failed to set %u-bit resolution",
+                     static_cast<unsigned>(count), resolution_);
+        }
+        count++;
+    }
+
+    sensor_count_.store(count, std::memory_order_release);
+    ESP_LOGI(TAG, "Tracking %u DS18B20 sensor(s)", static_cast<unsigned>(count));
+}
+
+bool DS18B20SensorManager::waitForFirstSweep(uint32_t timeout_ms) {
+    uint32_t waited_ms = 0;
+    while (sweeps_.load(std::memory_order_acquire) == 0) {
+        if (waited_ms >= timeout_ms) return false;
+        vTaskDelay(pdMS_TO_TICKS(CONVERSION_POLL_MS));
+        waited_ms += CONVERSION_POLL_MS;
+    }
+    return true;
+}
+
+size_t DS18B20SensorManager::getSensorCount() {
+    return sensor_count_.load(std::memory_order_acquire);
+}
+
+OneWireAddress DS18B20SensorManager::getSensorAddress(size_t index) {
+    return index < getSensorCount() ? ds18b20_sensors[index]->address() : 0;
+}
+
+SensorSnapshot DS18B20SensorManager::getSnapshot(size_t index) {
+    return index < SENSOR_MAX_COUNT ? snapshots_[index].read() : SensorSnapshot{};
+}
+
+float DS18B20SensorManager::getLastTemperature(size_t index) {
+    return getSnapshot(index).temperature;
+}
+
+bool DS18B20SensorManager::getSensorStatus(size_t index) {
+    return index < getSensorCount() && getSnapshot(index).ok;
+}
+
+DS18B20Stats DS18B20SensorManager::getSensorStats(size_t index) {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return index < getSensorCount() ? sensor_stats_[index] : DS18B20Stats{};
 }
 
-bool DS18B20SensorManager::getSensorStatus() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return sensor_ok_;
+const SensorHistory* DS18B20SensorManager::getHistory(size_t index) {
+    return index < CONFIG_SENSOR_HISTORY_CHANNELS ? &history_[index] : nullptr;
+}
+
+SensorNotifier& DS18B20SensorManager::getNotifier() {
+    return notifier_;
 }
 
 void DS18B20SensorManager::sensorTask(void* arg) {
+    TickType_t last_wake = xTaskGetTickCount();
+
     while (true) {
-        float temp_val = 0.0f;
-        bool ok = false;
+        if (sensor_count_ == 0) discoverSensors();
+        int64_t sweep_start_us = esp_timer_get_time();
+
+        // One broadcast Convert T for the whole bus, so a sweep costs a single
+        // conversion time regardless of how many sensors are attached.
+        bool started = sensor_count_ > 0 && DS18B20::startConversionAll(*onewire_bus);
+        if (started) {
+            // conv_ms is the datasheet maximum and sensors usually finish well
+            // before it, so start polling early and read as soon as they are done
+            uint32_t conv_ms = DS18B20::conversionTimeMs(resolution_);
+            uint32_t waited_ms = conv_ms / CONVERSION_FIRST_POLL_DIVISOR;
+            vTaskDelay(pdMS_TO_TICKS(waited_ms));
+
+            // The bus reads 1 only once every sensor has released it
+            while (!onewire_bus->readBit() && waited_ms < conv_ms + CONVERSION_GRACE_MS) {
+                vTaskDelay(pdMS_TO_TICKS(CONVERSION_POLL_MS));
+                waited_ms += CONVERSION_POLL_MS;
+            }
+        }
+
+        for (size_t i = 0; i < sensor_count_; i++) {
+            float temp_val = 0.0f;
+            bool ok = started && ds18b20_sensors[i]->fetchResult(temp_val);
+            sensor_reads.add();
+            if (!ok) sensor_read_failures.add();
+
+            // A failed read keeps the last good value and only clears the status flag
+            int64_t now_us = esp_timer_get_time();
+            if (!ok) temp_val = snapshots_[i].read().temperature;
+            snapshots_[i].publish(temp_val, ok, now_us);
+            notifier_.publish({static_cast<uint8_t>(i), snapshots_[i].read()});
+
+            if (ok && i < CONFIG_SENSOR_HISTORY_CHANNELS) {
+                history_[i].record(static_cast<uint32_t>(now_us / 1000000), temp_val);
+            }
 
-        if (ds18b20_sensor && ds18b20_sensor->init()) {
-            temp_val = ds18b20_sensor->readTemperature();
-            ok = true;
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            sensor_stats_[i] = ds18b20_sensors[i]->stats();
         }
 
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            last_temperature_ = temp_val;
-            sensor_ok_ = ok;
+        if (started) {
+            sweep_duration.observe(
+                static_cast<uint32_t>(esp_timer_get_time() - sweep_start_us));
         }
+        sweeps_.fetch_add(1, std::memory_order_release);
 
-        vTaskDelay(pdMS_TO_TICKS(2000));
+        // Interval is measured from the start of the cycle, so conversion time overlaps it
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(interval_ms_));
     }
 }
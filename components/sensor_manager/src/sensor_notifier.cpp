@@ -0,0 +1,57 @@
+#include "sensor_notifier.hpp"
+
+QueueHandle_t SensorNotifier::subscribe(TaskHandle_t waiter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (Subscriber& subscriber : subscribers_) {
+        if (subscriber.queue) continue;
+
+        subscriber.queue = xQueueCreate(CONFIG_SENSOR_NOTIFIER_QUEUE_DEPTH, sizeof(SensorEvent));
+        if (!subscriber.queue) return nullptr;
+        subscriber.waiter = waiter;
+        count_++;
+        return subscriber.queue;
+    }
+    return nullptr;
+}
+
+void SensorNotifier::unsubscribe(QueueHandle_t queue) {
+    if (!queue) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (Subscriber& subscriber : subscribers_) {
+        if (subscriber.queue != queue) continue;
+
+        vQueueDelete(subscriber.queue);
+        subscriber = {};
+        count_--;
+        return;
+    }
+}
+
+void SensorNotifier::publish(const SensorEvent& event) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (count_ == 0) return;
+
+    for (Subscriber& subscriber : subscribers_) {
+        if (!subscriber.queue) continue;
+
+        // Drop-oldest: the consumer only ever falls behind, never blocks us
+        if (xQueueSend(subscriber.queue, &event, 0) != pdTRUE) {
+            SensorEvent stale;
+            xQueueReceive(subscriber.queue, &stale, 0);
+            xQueueSend(subscriber.queue, &event, 0);
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (subscriber.waiter) xTaskNotifyGive(subscriber.waiter);
+    }
+}
+
+size_t SensorNotifier::subscriberCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_;
+}
+
+uint32_t SensorNotifier::droppedEvents() const {
+    return dropped_.load(std::memory_order_relaxed);
+}
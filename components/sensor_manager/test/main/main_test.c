@@ -0,0 +1,69 @@
+#include <stdio.h>
+
+#include "unity.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void setUp(void) {
+    // Set up before every test
+}
+
+void tearDown(void) {
+    // Clean up after every test
+}
+
+// sensor_history tests
+void test_history_tier_follows_step();
+void test_history_aggregates_min_max_avg();
+void test_history_pages_across_batches();
+void test_history_ring_wraps_around();
+
+// snapshot and notifier tests
+void test_snapshot_returns_latest_sample();
+void test_snapshot_reads_are_never_torn();
+void test_notifier_drops_oldest_when_full();
+void test_notifier_limits_subscribers();
+
+#ifdef __cplusplus
+}
+#endif
+
+TEST_CASE("SensorHistory: The tier follows the requested step", "[sensor_history]") {
+    test_history_tier_follows_step();
+}
+
+TEST_CASE("SensorHistory: Windows report min, max and avg", "[sensor_history]") {
+    test_history_aggregates_min_max_avg();
+}
+
+TEST_CASE("SensorHistory: Paging returns every point once", "[sensor_history]") {
+    test_history_pages_across_batches();
+}
+
+TEST_CASE("SensorHistory: A full ring drops its oldest samples", "[sensor_history]") {
+    test_history_ring_wraps_around();
+}
+
+TEST_CASE("SnapshotPublisher: read() returns the latest sample", "[sensor_snapshot]") {
+    test_snapshot_returns_latest_sample();
+}
+
+TEST_CASE("SnapshotPublisher: Reads racing the writer are never torn", "[sensor_snapshot]") {
+    test_snapshot_reads_are_never_torn();
+}
+
+TEST_CASE("SensorNotifier: A full queue drops its oldest events", "[sensor_notifier]") {
+    test_notifier_drops_oldest_when_full();
+}
+
+TEST_CASE("SensorNotifier: Subscriptions are capped", "[sensor_notifier]") {
+    test_notifier_limits_subscribers();
+}
+
+void app_main(void) {
+    UNITY_BEGIN();
+    unity_run_all_tests();
+    UNITY_END();
+}
@@ -0,0 +1,138 @@
+#include <memory>
+
+#include "sensor_history.hpp"
+#include "unity.h"
+
+constexpr size_t PAGE_POINTS = 32;
+
+/**
+ * @brief Run a query to completion through a small buffer, as the HTTP handler does.
+ * @return Total number of points written to out
+ */
+static size_t queryAll(const SensorHistory& history, const HistoryQuery& query, HistoryPoint* out,
+                       size_t max_points, size_t page_points, size_t* pages = nullptr) {
+    HistoryCursor cursor;
+    size_t total = 0;
+    size_t calls = 0;
+    while (!cursor.done) {
+        size_t room = max_points - total < page_points ? max_points - total : page_points;
+        TEST_ASSERT_TRUE(room > 0);
+        total += history.query(query, cursor, out + total, room);
+        calls++;
+    }
+    if (pages) *pages = calls;
+    return total;
+}
+
+/// @brief Verifies that each step is served from the coarsest tier not exceeding it.
+extern "C" void test_history_tier_follows_step() {
+    TEST_ASSERT_TRUE(SensorHistory::tierForStep(0) == HistoryTier::Raw);
+    TEST_ASSERT_TRUE(SensorHistory::tierForStep(59) == HistoryTier::Raw);
+    TEST_ASSERT_TRUE(SensorHistory::tierForStep(60) == HistoryTier::Minute);
+    TEST_ASSERT_TRUE(SensorHistory::tierForStep(3599) == HistoryTier::Minute);
+    TEST_ASSERT_TRUE(SensorHistory::tierForStep(3600) == HistoryTier::Hour);
+    TEST_ASSERT_TRUE(SensorHistory::tierForStep(86400) == HistoryTier::Hour);
+}
+
+/// @brief Verifies min/max/avg of closed minute windows and of step-merged windows.
+extern "C" void test_history_aggregates_min_max_avg() {
+    auto history = std::make_unique<SensorHistory>();
+
+    // Minute m alternates between (m + 1) * 10 and (m + 1) * 10 + 2 degrees
+    for (uint32_t t = 0; t < 180; t += 2) {
+        uint32_t minute = t / 60;
+        float base = (minute + 1) * 10.0f;
+        history->record(t, (t / 2) % 2 ? base + 2.0f : base);
+    }
+
+    // The third minute is still open, so only two minute entries exist
+    HistoryPoint points[8];
+    HistoryCursor cursor;
+    size_t n = history->query({0, 3600, 60}, cursor, points, 8);
+    TEST_ASSERT_TRUE(cursor.done);
+    TEST_ASSERT_EQUAL(2, n);
+    TEST_ASSERT_EQUAL_UINT32(0, points[0].time_s);
+    TEST_ASSERT_EQUAL_INT(1000, points[0].min);
+    TEST_ASSERT_EQUAL_INT(1200, points[0].max);
+    TEST_ASSERT_EQUAL_INT(1100, points[0].avg);
+    TEST_ASSERT_EQUAL_UINT32(60, points[1].time_s);
+    TEST_ASSERT_EQUAL_INT(2000, points[1].min);
+    TEST_ASSERT_EQUAL_INT(2200, points[1].max);
+    TEST_ASSERT_EQUAL_INT(2100, points[1].avg);
+
+    // A wider step merges both minutes into one window
+    cursor = {};
+    n = history->query({0, 3600, 120}, cursor, points, 8);
+    TEST_ASSERT_EQUAL(1, n);
+    TEST_ASSERT_EQUAL_INT(1000, points[0].min);
+    TEST_ASSERT_EQUAL_INT(2200, points[0].max);
+    TEST_ASSERT_EQUAL_INT(1600, points[0].avg);
+
+    // Raw samples merged into 10 s windows: five samples each, three of them low
+    cursor = {};
+    n = history->query({0, 9, 10}, cursor, points, 8);
+    TEST_ASSERT_EQUAL(1, n);
+    TEST_ASSERT_EQUAL_INT(1000, points[0].min);
+    TEST_ASSERT_EQUAL_INT(1200, points[0].max);
+    TEST_ASSERT_EQUAL_INT(1080, points[0].avg);
+
+    // The hour window is still open, so the hour tier has nothing yet
+    cursor = {};
+    TEST_ASSERT_EQUAL(0, history->query({0, 7200, 3600}, cursor, points, 8));
+    TEST_ASSERT_TRUE(cursor.done);
+}
+
+/// @brief Verifies that paging returns every point once and never splits a window.
+extern "C" void test_history_pages_across_batches() {
+    auto history = std::make_unique<SensorHistory>();
+    for (uint32_t t = 0; t < 200; t++) history->record(t, 20.0f + (t % 7) * 0.25f);
+
+    // Raw: 200 points through 32-point pages
+    HistoryPoint points[200];
+    size_t pages = 0;
+    size_t n = queryAll(*history, {0, 199, 0}, points, 200, PAGE_POINTS, &pages);
+    TEST_ASSERT_EQUAL(200, n);
+    TEST_ASSERT_GREATER_THAN(6, pages);
+    for (size_t i = 0; i < n; i++) TEST_ASSERT_EQUAL_UINT32(i, points[i].time_s);
+
+    // 10 s windows through 3-point pages: every window arrives whole
+    n = queryAll(*history, {0, 199, 10}, points, 200, 3, &pages);
+    TEST_ASSERT_EQUAL(20, n);
+    TEST_ASSERT_GREATER_THAN(6, pages);
+    for (size_t i = 0; i < n; i++) {
+        TEST_ASSERT_EQUAL_UINT32(i * 10, points[i].time_s);
+        TEST_ASSERT_EQUAL_INT(2000, points[i].min);
+        TEST_ASSERT_EQUAL_INT(2150, points[i].max);
+    }
+
+    // A sub-range starts and ends where asked
+    n = queryAll(*history, {50, 59, 0}, points, 200, 4);
+    TEST_ASSERT_EQUAL(10, n);
+    TEST_ASSERT_EQUAL_UINT32(50, points[0].time_s);
+    TEST_ASSERT_EQUAL_UINT32(59, points[9].time_s);
+}
+
+/// @brief Verifies that a full ring drops its oldest entries and keeps absolute times right.
+extern "C" void test_history_ring_wraps_around() {
+    constexpr uint32_t START_S = 1000;
+    constexpr uint32_t EXTRA = 50;
+    constexpr uint32_t TOTAL = CONFIG_SENSOR_HISTORY_RAW_SAMPLES + EXTRA;
+
+    auto history = std::make_unique<SensorHistory>();
+    // Irregular 1-3 s gaps, so the rebased oldest time depends on every delta
+    auto times = std::make_unique<uint32_t[]>(TOTAL);
+    uint32_t t = START_S;
+    for (uint32_t i = 0; i < TOTAL; i++) {
+        times[i] = t;
+        history->record(t, static_cast<float>(i % 100));
+        t += 1 + i % 3;
+    }
+
+    auto points = std::make_unique<HistoryPoint[]>(TOTAL);
+    size_t n = queryAll(*history, {0, UINT32_MAX, 0}, points.get(), TOTAL, PAGE_POINTS);
+    TEST_ASSERT_EQUAL(CONFIG_SENSOR_HISTORY_RAW_SAMPLES, n);
+    for (size_t i = 0; i < n; i++) {
+        TEST_ASSERT_EQUAL_UINT32(times[EXTRA + i], points[i].time_s);
+        TEST_ASSERT_EQUAL_INT(((EXTRA + i) % 100) * 100, points[i].avg);
+    }
+}
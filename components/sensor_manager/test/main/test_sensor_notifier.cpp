@@ -0,0 +1,122 @@
+#include <atomic>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sensor_notifier.hpp"
+#include "sensor_snapshot.hpp"
+#include "unity.h"
+
+static SensorEvent eventWithSequence(uint32_t sequence) {
+    SensorEvent event = {};
+    event.sensor = 0;
+    event.snapshot = {static_cast<float>(sequence), true, sequence * 1000, sequence};
+    return event;
+}
+
+/// @brief Verifies that read() returns the latest publish, also after the slot ring wraps.
+extern "C" void test_snapshot_returns_latest_sample() {
+    SnapshotPublisher publisher;
+    TEST_ASSERT_EQUAL_UINT32(0, publisher.read().sequence);
+
+    for (uint32_t i = 1; i <= 10; i++) {
+        publisher.publish(20.0f + i, i % 2, i * 1000);
+        SensorSnapshot snapshot = publisher.read();
+        TEST_ASSERT_EQUAL_UINT32(i, snapshot.sequence);
+        TEST_ASSERT_EQUAL_UINT32(i, publisher.sequence());
+        TEST_ASSERT_EQUAL_FLOAT(20.0f + i, snapshot.temperature);
+        TEST_ASSERT_EQUAL(i % 2, snapshot.ok);
+        TEST_ASSERT_TRUE(snapshot.timestamp_us == static_cast<int64_t>(i) * 1000);
+    }
+}
+
+struct PublisherRun {
+    SnapshotPublisher* publisher;
+    uint32_t samples;
+    std::atomic<bool> done;
+};
+
+static void publishTask(void* arg) {
+    auto* run = static_cast<PublisherRun*>(arg);
+    for (uint32_t i = 1; i <= run->samples; i++) {
+        // Every field is derived from i, so a torn read shows up as a mismatch
+        run->publisher->publish(static_cast<float>(i), i % 2, static_cast<int64_t>(i) * 7);
+        if (i % 64 == 0) taskYIELD();
+    }
+    run->done = true;
+    vTaskDelete(nullptr);
+}
+
+/// @brief Verifies that a reader racing the writer only ever sees whole samples.
+extern "C" void test_snapshot_reads_are_never_torn() {
+    static SnapshotPublisher publisher;
+    PublisherRun run = {&publisher, 50000, {false}};
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(publishTask, "publish", 4096, &run,
+                                          uxTaskPriorityGet(nullptr), nullptr));
+
+    uint32_t last = 0;
+    uint32_t reads = 0;
+    while (!run.done || reads == 0) {
+        SensorSnapshot snapshot = publisher.read();
+        reads++;
+        if (snapshot.sequence == 0) continue;
+
+        TEST_ASSERT_EQUAL_FLOAT(static_cast<float>(snapshot.sequence), snapshot.temperature);
+        TEST_ASSERT_EQUAL(snapshot.sequence % 2, snapshot.ok);
+        TEST_ASSERT_TRUE(snapshot.timestamp_us == static_cast<int64_t>(snapshot.sequence) * 7);
+        TEST_ASSERT_GREATER_OR_EQUAL(last, snapshot.sequence);
+        last = snapshot.sequence;
+    }
+    TEST_ASSERT_EQUAL_UINT32(run.samples, publisher.read().sequence);
+}
+
+/// @brief Verifies that a full subscriber queue drops its oldest events and wakes its waiter.
+extern "C" void test_notifier_drops_oldest_when_full() {
+    SensorNotifier notifier;
+    QueueHandle_t slow = notifier.subscribe(xTaskGetCurrentTaskHandle());
+    QueueHandle_t fast = notifier.subscribe();
+    TEST_ASSERT_NOT_NULL(slow);
+    TEST_ASSERT_NOT_NULL(fast);
+    TEST_ASSERT_EQUAL(2, notifier.subscriberCount());
+    ulTaskNotifyTake(pdTRUE, 0);
+
+    // The fast subscriber keeps up, so only the slow one overflows
+    constexpr uint32_t OVERFLOW = 3;
+    constexpr uint32_t PUBLISHED = CONFIG_SENSOR_NOTIFIER_QUEUE_DEPTH + OVERFLOW;
+    SensorEvent event;
+    for (uint32_t i = 1; i <= PUBLISHED; i++) {
+        notifier.publish(eventWithSequence(i));
+        TEST_ASSERT_EQUAL(pdTRUE, xQueueReceive(fast, &event, 0));
+        TEST_ASSERT_EQUAL_UINT32(i, event.snapshot.sequence);
+    }
+    TEST_ASSERT_EQUAL_UINT32(OVERFLOW, notifier.droppedEvents());
+    TEST_ASSERT_EQUAL_UINT32(PUBLISHED, ulTaskNotifyTake(pdTRUE, 0));
+
+    // The newest events survive, oldest first
+    for (uint32_t expected = OVERFLOW + 1; expected <= PUBLISHED; expected++) {
+        TEST_ASSERT_EQUAL(pdTRUE, xQueueReceive(slow, &event, 0));
+        TEST_ASSERT_EQUAL_UINT32(expected, event.snapshot.sequence);
+    }
+    TEST_ASSERT_EQUAL(pdFALSE, xQueueReceive(slow, &event, 0));
+
+    notifier.unsubscribe(slow);
+    notifier.unsubscribe(fast);
+    TEST_ASSERT_EQUAL(0, notifier.subscriberCount());
+}
+
+/// @brief Verifies that subscriptions are capped and freed slots are reused.
+extern "C" void test_notifier_limits_subscribers() {
+    SensorNotifier notifier;
+    QueueHandle_t queues[CONFIG_SENSOR_NOTIFIER_MAX_SUBSCRIBERS];
+    for (QueueHandle_t& queue : queues) {
+        queue = notifier.subscribe();
+        TEST_ASSERT_NOT_NULL(queue);
+    }
+    TEST_ASSERT_NULL(notifier.subscribe());
+
+    notifier.unsubscribe(queues[0]);
+    queues[0] = notifier.subscribe();
+    TEST_ASSERT_NOT_NULL(queues[0]);
+
+    for (QueueHandle_t queue : queues) notifier.unsubscribe(queue);
+    TEST_ASSERT_EQUAL(0, notifier.subscriberCount());
+}
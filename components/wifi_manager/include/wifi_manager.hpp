@@ -1,20 +1,157 @@
 #pragma once
 
 #include <cstring>
+#include <mutex>
 
 #include "config_manager.hpp"
 #include "esp_event.h"
 #include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/timers.h"
+
+/**
+ * @brief Where the station interface is in its connect cycle.
+ */
+enum class WiFiStaState : uint8_t {
+    Disabled,    ///< STA off in config, or Wi-Fi not started
+    Connecting,  ///< esp_wifi_connect() issued; scanning and associating
+    Associated,  ///< Link up, waiting for DHCP
+    Connected,   ///< Has an IP address
+    Backoff,     ///< Waiting to retry after a failed attempt
+};
+
+/**
+ * @brief STA counters since boot, and the timings of the latest connection.
+ */
+struct WiFiStaStats {
+    uint32_t attempts;       ///< esp_wifi_connect() calls
+    uint32_t connects;       ///< Connections that reached an IP address
+    uint32_t fast_connects;  ///< Of those, made with the cached channel/BSSID
+    uint32_t failures;       ///< Attempts that ended without an IP address
+    uint32_t link_losses;    ///< Connections dropped after reaching an IP address
+    uint8_t last_reason;     ///< wifi_err_reason_t of the latest disconnect
+    uint32_t assoc_ms;       ///< esp_wifi_connect() to association, last attempt
+    uint32_t dhcp_ms;        ///< Association to IP address
+    uint32_t time_to_ip_ms;  ///< First attempt to IP address, retries included
+};
+
+/**
+ * @brief One AP found by the latest scan.
+ */
+struct WiFiScanEntry {
+    char ssid[33];
+    uint8_t bssid[6];
+    uint8_t channel;
+    int8_t rssi;
+    uint8_t authmode;  ///< wifi_auth_mode_t
+};
+
+/**
+ * @brief Where the scan result table stands.
+ */
+enum class WiFiScanState : uint8_t {
+    Idle,      ///< No results, or they outlived CONFIG_WIFI_MANAGER_SCAN_TTL_MS
+    Scanning,  ///< A scan is running
+    Done,      ///< Results are fresh
+    Failed,    ///< The latest scan did not complete
+};
+
+/**
+ * @brief What requestScan() did.
+ */
+enum class WiFiScanRequest : uint8_t {
+    Started,
+    Running,      ///< A scan was already in progress
+    Cached,       ///< The results are still fresh, so no new scan
+    RateLimited,  ///< Too soon after the previous scan
+    Unavailable,  ///< Wi-Fi is off, or the station is busy connecting
+};
+
+struct WiFiScanStatus {
+    WiFiScanState state;
+    uint16_t total;     ///< APs in the table
+    uint32_t age_ms;    ///< Since the table was filled
+    uint32_t retry_ms;  ///< Until the rate limit admits another scan
+};
 
 class WiFiManager {
    public:
     WiFiManager(const NetworkConfig& config);
-    void startAP();
+    ~WiFiManager();
+
+    /**
+     * @brief Start Wi-Fi as AP, STA or both, as NetworkConfig asks.
+     *
+     * The station connects in the background, first to the channel and BSSID
+     * cached from its last connection, and reconnects by itself with backoff.
+     * Config changes are applied live from then on.
+     */
+    void start();
+    void stop();
     void logApIp();
 
+    WiFiStaState getStaState();
+    WiFiStaStats getStaStats();
+
+    /**
+     * @brief Start a scan in the background unless fresh results exist.
+     *
+     * Never blocks: the driver scans on its own task and the results land in
+     * a fixed table from WIFI_EVENT_SCAN_DONE. While only the AP runs, the
+     * station interface is brought up for the scan and dropped afterwards.
+     */
+    WiFiScanRequest requestScan();
+    WiFiScanStatus getScanStatus();
+
+    /**
+     * @brief Copy up to max table entries from offset, strongest first.
+     * @return Entries copied
+     */
+    size_t getScanResults(size_t offset, WiFiScanEntry* out, size_t max, WiFiScanStatus& status);
+
    private:
     NetworkConfig _config;
+    std::mutex _mutex;           ///< Guards every member below
+    int _config_sub = -1;        ///< ConfigManager subscription for NetworkConfig changes
+    bool _started = false;       ///< start() has run, so config changes are applied live
+    bool _wifi_running = false;  ///< esp_wifi_start() has run
+    wifi_mode_t _mode = WIFI_MODE_NULL;
+    esp_event_handler_instance_t _wifi_handler = nullptr;
+    esp_event_handler_instance_t _ip_handler = nullptr;
+
+    WiFiStaState _sta_state = WiFiStaState::Disabled;
+    bool _use_hint = false;         ///< This attempt targets the cached channel/BSSID
+    bool _restart_pending = false;  ///< Reconnect once the old link reports it is down
+    uint32_t _failures = 0;         ///< Consecutive failed attempts, drives the backoff
+    int64_t _first_attempt_us = 0;  ///< Start of the current connect sequence
+    int64_t _attempt_us = 0;
+    int64_t _assoc_us = 0;
+    uint8_t _ap_bssid[6] = {};  ///< AP joined by this attempt, from STA_CONNECTED
+    uint8_t _ap_channel = 0;
+    WiFiStaStats _stats = {};
+    TimerHandle_t _retry_timer = nullptr;
+
+    WiFiScanEntry _scan_table[CONFIG_WIFI_MANAGER_SCAN_MAX_APS];
+    uint16_t _scan_count = 0;
+    bool _scanning = false;
+    bool _scan_failed = false;
+    int64_t _scan_start_us = 0;  ///< Start of the latest scan, for the rate limit
+    int64_t _scan_done_us = 0;   ///< When _scan_table was filled; 0 while it is empty
+
+    esp_err_t applyConfig(bool ap_changed, bool sta_changed);
+    bool staWanted() const;
+    void beginSta();
+    bool stopSta();
+    bool hasCachedAp() const;
+    void connectSta();
+    void retryLater(uint32_t delay_ms);
+    void finishScan(bool ok);
+    WiFiScanStatus scanStatus(int64_t now);
 
+    static void onConfigChanged(uint8_t sections, const DeviceConfig& config, void* arg);
+    static void onRetryTimer(TimerHandle_t timer);
     static void onWiFiEvent(void* arg, esp_event_base_t event_base, int32_t event_id,
                             void* event_data);
+    static void onIpEvent(void* arg, esp_event_base_t event_base, int32_t event_id,
+                          void* event_data);
 };
@@ -1,13 +1,73 @@
 #include "wifi_manager.hpp"
 
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
+#include <strings.h>
 
 #include "esp_log.h"
 #include "esp_mac.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
 
 static const char* TAG = "wifi_manager";
 
-WiFiManager::WiFiManager(const NetworkConfig& config) : _config(config) {}
+// Reconnect anyway if the dropped link never reports STA_DISCONNECTED
+constexpr uint32_t RESTART_FALLBACK_MS = 1000;
+
+// Active dwell per scanned channel, and the time back on the AP's own channel
+// between two of them, so its clients are served throughout a scan
+constexpr uint32_t SCAN_CHANNEL_MS = 120;
+constexpr uint8_t SCAN_HOME_DWELL_MS = 60;
+
+// A reconnect due while the radio scans is put off by this much
+constexpr uint32_t SCAN_RETRY_DEFER_MS = 250;
+
+static bool hasAp(wifi_mode_t mode) {
+    return mode == WIFI_MODE_AP || mode == WIFI_MODE_APSTA;
+}
+
+static bool hasSta(wifi_mode_t mode) {
+    return mode == WIFI_MODE_STA || mode == WIFI_MODE_APSTA;
+}
+
+// Parses the "aa:bb:cc:dd:ee:ff" form NetworkConfig stores
+static bool parseMac(const char* text, uint8_t mac[6]) {
+    unsigned int b[6];
+    int end = 0;
+    if (sscanf(text, "%2x:%2x:%2x:%2x:%2x:%2x%n", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5],
+               &end) != 6 ||
+        text[end] != '\0') {
+        return false;
+    }
+    for (int i = 0; i < 6; i++) mac[i] = static_cast<uint8_t>(b[i]);
+    return true;
+}
+
+static uint32_t elapsedMs(int64_t since_us, int64_t now_us) {
+    return since_us ? static_cast<uint32_t>((now_us - since_us) / 1000) : 0;
+}
+
+// CONFIG_WIFI_MANAGER_RETRY_MIN_MS doubled per consecutive failure, capped
+static uint32_t backoffMs(uint32_t failures) {
+    uint32_t delay = CONFIG_WIFI_MANAGER_RETRY_MIN_MS;
+    for (uint32_t i = 1; i < failures && delay < CONFIG_WIFI_MANAGER_RETRY_MAX_MS; i++) delay *= 2;
+    return std::min<uint32_t>(delay, CONFIG_WIFI_MANAGER_RETRY_MAX_MS);
+}
+
+WiFiManager::WiFiManager(const NetworkConfig& config) : _config(config) {
+    _config_sub = ConfigManager::getInstance().subscribe(CONFIG_SECTION_NETWORK,
+                                                         &WiFiManager::onConfigChanged, this);
+}
+
+WiFiManager::~WiFiManager() {
+    ConfigManager::getInstance().unsubscribe(_config_sub);
+    if (_wifi_handler) {
+        esp_event_handler_instance_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, _wifi_handler);
+    }
+    if (_ip_handler) esp_event_handler_instance_unregister(IP_EVENT, ESP_EVENT_ANY_ID, _ip_handler);
+    if (_retry_timer) xTimerDelete(_retry_timer, portMAX_DELAY);
+}
 
 void WiFiManager::logApIp() {
     esp_netif_t* netif = esp_netif_get_handle_from_ifkey("WIFI_AP_DEF");
@@ -19,48 +79,372 @@ void WiFiManager::logApIp() {
     }
 }
 
-void WiFiManager::startAP() {
-    ESP_LOGI(TAG, "Starting Wi-Fi in AP mode...");
+void WiFiManager::start() {
+    ESP_LOGI(TAG, "Starting Wi-Fi...");
 
     static bool wifi_initialized = false;
     if (!wifi_initialized) {
         ESP_ERROR_CHECK(esp_netif_init());
         ESP_ERROR_CHECK(esp_event_loop_create_default());
         esp_netif_create_default_wifi_ap();
+        esp_netif_create_default_wifi_sta();
 
         wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
         ESP_ERROR_CHECK(esp_wifi_init(&cfg));
-
-        // Register event handler
-        ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID,
-                                                   &WiFiManager::onWiFiEvent, nullptr));
+        // NetworkConfig is the one persisted copy; the driver's NVS copy would only drift
+        ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
 
         wifi_initialized = true;
     }
 
-    // Configure access point
-    wifi_config_t ap_config = {};
-    strncpy((char*)ap_config.ap.ssid, _config.ap_ssid, sizeof(ap_config.ap.ssid));
-    strncpy((char*)ap_config.ap.password, _config.ap_password, sizeof(ap_config.ap.password));
-    ap_config.ap.ssid_len = strlen(_config.ap_ssid);
-    ap_config.ap.max_connection = 4;
-    ap_config.ap.authmode = WIFI_AUTH_WPA_WPA2_PSK;
+    bool ap_running;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_retry_timer) {
+            ESP_ERROR_CHECK(esp_event_handler_instance_register(
+                WIFI_EVENT, ESP_EVENT_ANY_ID, &WiFiManager::onWiFiEvent, this, &_wifi_handler));
+            ESP_ERROR_CHECK(esp_event_handler_instance_register(
+                IP_EVENT, ESP_EVENT_ANY_ID, &WiFiManager::onIpEvent, this, &_ip_handler));
+            _retry_timer = xTimerCreate("sta_retry", 1, pdFALSE, this, &WiFiManager::onRetryTimer);
+            if (!_retry_timer) ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+        }
+
+        _started = true;
+        ESP_ERROR_CHECK(applyConfig(true, true));
+        ap_running = hasAp(_mode);
+    }
+
+    if (ap_running) WiFiManager::logApIp();
+}
+
+void WiFiManager::stop() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _started = false;
+    _scanning = false;  // esp_wifi_stop() aborts it
+    stopSta();
+    if (_wifi_running && esp_wifi_stop() == ESP_OK) {
+        _wifi_running = false;
+        _mode = WIFI_MODE_NULL;
+        ESP_LOGI(TAG, "Wi-Fi stopped");
+    }
+}
+
+WiFiStaState WiFiManager::getStaState() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _sta_state;
+}
+
+WiFiStaStats WiFiManager::getStaStats() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+WiFiScanRequest WiFiManager::requestScan() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    int64_t now = esp_timer_get_time();
+    WiFiScanStatus status = scanStatus(now);
+    if (status.state == WiFiScanState::Scanning) return WiFiScanRequest::Running;
+    if (status.state == WiFiScanState::Done) return WiFiScanRequest::Cached;
+    // The driver refuses to scan in the middle of a connect
+    if (!_started || !_wifi_running || _sta_state == WiFiStaState::Connecting ||
+        _sta_state == WiFiStaState::Associated) {
+        return WiFiScanRequest::Unavailable;
+    }
+    if (status.retry_ms) return WiFiScanRequest::RateLimited;
+
+    _scanning = true;
+    _scan_start_us = now;
+    esp_err_t err = hasSta(_mode) ? ESP_OK : applyConfig(false, false);
+    if (err == ESP_OK) {
+        wifi_scan_config_t scan_config = {};
+        scan_config.scan_type = WIFI_SCAN_TYPE_ACTIVE;
+        scan_config.scan_time.active.max = SCAN_CHANNEL_MS;
+        scan_config.home_chan_dwell_time = SCAN_HOME_DWELL_MS;
+        err = esp_wifi_scan_start(&scan_config, false);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start scan: %s", esp_err_to_name(err));
+        finishScan(false);
+        return WiFiScanRequest::Unavailable;
+    }
+
+    ESP_LOGI(TAG, "Scan started");
+    return WiFiScanRequest::Started;
+}
+
+WiFiScanStatus WiFiManager::getScanStatus() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return scanStatus(esp_timer_get_time());
+}
+
+size_t WiFiManager::getScanResults(size_t offset, WiFiScanEntry* out, size_t max,
+                                   WiFiScanStatus& status) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    status = scanStatus(esp_timer_get_time());
+    if (offset >= _scan_count) return 0;
+
+    size_t count = std::min<size_t>(max, _scan_count - offset);
+    memcpy(out, &_scan_table[offset], count * sizeof(WiFiScanEntry));
+    return count;
+}
+
+// Caller holds _mutex. Drops the table once it outlives its TTL.
+WiFiScanStatus WiFiManager::scanStatus(int64_t now) {
+    if (_scan_done_us && now - _scan_done_us >= CONFIG_WIFI_MANAGER_SCAN_TTL_MS * 1000LL) {
+        _scan_count = 0;
+        _scan_done_us = 0;
+    }
 
-    if (strlen(_config.ap_password) == 0) {
-        ap_config.ap.authmode = WIFI_AUTH_OPEN;
+    WiFiScanStatus status = {};
+    if (_scanning) {
+        status.state = WiFiScanState::Scanning;
+    } else if (_scan_done_us) {
+        status.state = WiFiScanState::Done;
+    } else {
+        status.state = _scan_failed ? WiFiScanState::Failed : WiFiScanState::Idle;
     }
+    status.total = _scan_count;
+    status.age_ms = elapsedMs(_scan_done_us, now);
 
-    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_AP));
-    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_AP, &ap_config));
-    ESP_ERROR_CHECK(esp_wifi_start());
+    int64_t next_us = _scan_start_us + CONFIG_WIFI_MANAGER_SCAN_MIN_INTERVAL_MS * 1000LL;
+    if (_scan_start_us && next_us > now) status.retry_ms = (next_us - now + 999) / 1000;
+    return status;
+}
+
+// Caller holds _mutex. Runs on the event loop task, whose stack takes one
+// wifi_ap_record_t at a time but not a table of them.
+void WiFiManager::finishScan(bool ok) {
+    int64_t now = esp_timer_get_time();
+    _scanning = false;
+    _scan_failed = !ok;
+
+    if (ok) {
+        uint16_t found = 0;
+        esp_wifi_scan_get_ap_num(&found);
+
+        // Keeps the strongest APs when there are more than the table holds
+        wifi_ap_record_t record;
+        _scan_count = 0;
+        while (esp_wifi_scan_get_ap_record(&record) == ESP_OK) {
+            WiFiScanEntry* entry = &_scan_table[_scan_count];
+            if (_scan_count == CONFIG_WIFI_MANAGER_SCAN_MAX_APS) {
+                entry = std::min_element(
+                    _scan_table, _scan_table + _scan_count,
+                    [](const WiFiScanEntry& a, const WiFiScanEntry& b) { return a.rssi < b.rssi; });
+                if (entry->rssi >= record.rssi) continue;
+            } else {
+                _scan_count++;
+            }
+            memcpy(entry->ssid, record.ssid, sizeof(entry->ssid) - 1);
+            entry->ssid[sizeof(entry->ssid) - 1] = '\0';
+            memcpy(entry->bssid, record.bssid, sizeof(entry->bssid));
+            entry->channel = record.primary;
+            entry->rssi = record.rssi;
+            entry->authmode = static_cast<uint8_t>(record.authmode);
+        }
+        esp_wifi_clear_ap_list();
 
-    ESP_LOGI(TAG, "Access Point started. SSID: %s", _config.ap_ssid);
+        std::sort(_scan_table, _scan_table + _scan_count,
+                  [](const WiFiScanEntry& a, const WiFiScanEntry& b) { return a.rssi > b.rssi; });
+        _scan_done_us = now;
+        ESP_LOGI(TAG, "Scan found %u APs in %u ms", found,
+                 (unsigned)elapsedMs(_scan_start_us, now));
+    } else {
+        ESP_LOGW(TAG, "Scan did not complete");
+    }
 
-    WiFiManager::logApIp();
+    // Drop the station interface if only the scan wanted it
+    if (_started && !staWanted() && hasSta(_mode)) {
+        esp_err_t err = applyConfig(false, false);
+        if (err != ESP_OK) ESP_LOGE(TAG, "Failed to apply Wi-Fi config: %s", esp_err_to_name(err));
+    }
 }
 
+// Caller holds _mutex
+bool WiFiManager::staWanted() const {
+    return _config.sta_enabled && _config.ssid[0] != '\0';
+}
+
+// Caller holds _mutex
+esp_err_t WiFiManager::applyConfig(bool ap_changed, bool sta_changed) {
+    const bool ap = _config.ap_enabled;
+    const bool sta = staWanted();
+    // A scan needs the station interface, whether or not the station is on
+    const bool sta_if = sta || _scanning;
+    wifi_mode_t mode = ap ? (sta_if ? WIFI_MODE_APSTA : WIFI_MODE_AP)
+                          : (sta_if ? WIFI_MODE_STA : WIFI_MODE_NULL);
+
+    // Before the mode change, so the station's own disconnect is not retried
+    if (!sta) stopSta();
+
+    if (mode == WIFI_MODE_NULL) {
+        if (!_wifi_running) return ESP_OK;
+        esp_err_t err = esp_wifi_stop();
+        if (err == ESP_OK) {
+            _wifi_running = false;
+            _mode = WIFI_MODE_NULL;
+            ESP_LOGI(TAG, "Wi-Fi stopped");
+        }
+        return err;
+    }
+
+    esp_err_t err = ESP_OK;
+    const bool had_ap = hasAp(_mode);
+    if (mode != _mode) {
+        err = esp_wifi_set_mode(mode);
+        if (err != ESP_OK) return err;
+        _mode = mode;
+    }
+    if (!ap && had_ap) ESP_LOGI(TAG, "Access Point stopped");
+
+    if (ap && (ap_changed || !had_ap)) {
+        wifi_config_t ap_config = {};
+        strncpy((char*)ap_config.ap.ssid, _config.ap_ssid, sizeof(ap_config.ap.ssid));
+        strncpy((char*)ap_config.ap.password, _config.ap_password,
+                sizeof(ap_config.ap.password));
+        ap_config.ap.ssid_len = strlen(_config.ap_ssid);
+        ap_config.ap.max_connection = 4;
+        ap_config.ap.authmode = WIFI_AUTH_WPA_WPA2_PSK;
+
+        if (strlen(_config.ap_password) == 0) {
+            ap_config.ap.authmode = WIFI_AUTH_OPEN;
+        }
+
+        // Reconfiguring a running AP restarts it and drops its clients
+        err = esp_wifi_set_config(WIFI_IF_AP, &ap_config);
+        if (err != ESP_OK) return err;
+        ESP_LOGI(TAG, "Access Point started. SSID: %s", _config.ap_ssid);
+    }
+
+    if (!_wifi_running) {
+        // The station connects from WIFI_EVENT_STA_START
+        err = esp_wifi_start();
+        if (err == ESP_OK) _wifi_running = true;
+        return err;
+    }
+    if (sta && (sta_changed || _sta_state == WiFiStaState::Disabled)) beginSta();
+    return ESP_OK;
+}
+
+// Caller holds _mutex. Starts a connect sequence with the current credentials,
+// dropping whatever link or attempt the station had.
+void WiFiManager::beginSta() {
+    bool was_active = stopSta();
+    _failures = 0;
+    _use_hint = hasCachedAp();
+
+    if (was_active) {
+        // Reconnect from the STA_DISCONNECTED this causes, or the timer if none comes
+        _restart_pending = true;
+        retryLater(RESTART_FALLBACK_MS);
+        return;
+    }
+    connectSta();
+}
+
+// Caller holds _mutex. Returns whether a link or attempt was dropped.
+bool WiFiManager::stopSta() {
+    if (_retry_timer) xTimerStop(_retry_timer, 0);
+    bool active = _sta_state == WiFiStaState::Connecting ||
+                  _sta_state == WiFiStaState::Associated || _sta_state == WiFiStaState::Connected;
+    _sta_state = WiFiStaState::Disabled;
+    _restart_pending = false;
+    _first_attempt_us = 0;
+    if (active) esp_wifi_disconnect();
+    return active;
+}
+
+// Caller holds _mutex
+bool WiFiManager::hasCachedAp() const {
+    uint8_t bssid[6];
+    return _config.channel != 0 && parseMac(_config.bssid, bssid);
+}
+
+// Caller holds _mutex
+void WiFiManager::connectSta() {
+    wifi_config_t sta_config = {};
+    strncpy((char*)sta_config.sta.ssid, _config.ssid, sizeof(sta_config.sta.ssid));
+    strncpy((char*)sta_config.sta.password, _config.password, sizeof(sta_config.sta.password));
+    sta_config.sta.sort_method = WIFI_CONNECT_AP_BY_SIGNAL;
+    if (_use_hint) {
+        // Straight to the AP of the last connection: one channel instead of all of them
+        sta_config.sta.scan_method = WIFI_FAST_SCAN;
+        sta_config.sta.bssid_set = true;
+        parseMac(_config.bssid, sta_config.sta.bssid);
+        sta_config.sta.channel = _config.channel;
+    } else {
+        // Every channel, so the strongest AP of the network is found and cached
+        sta_config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+    }
+
+    int64_t now = esp_timer_get_time();
+    if (_first_attempt_us == 0) _first_attempt_us = now;
+    _attempt_us = now;
+    _assoc_us = 0;
+    _stats.attempts++;
+
+    esp_err_t err = esp_wifi_set_config(WIFI_IF_STA, &sta_config);
+    if (err == ESP_OK) err = esp_wifi_connect();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start STA connect: %s", esp_err_to_name(err));
+        _stats.failures++;
+        retryLater(backoffMs(++_failures));
+        return;
+    }
+
+    _sta_state = WiFiStaState::Connecting;
+    ESP_LOGI(TAG, "Connecting to %s%s", _config.ssid,
+             _use_hint ? " on its cached channel/BSSID" : " with a full scan");
+}
+
+// Caller holds _mutex
+void WiFiManager::retryLater(uint32_t delay_ms) {
+    if (!_restart_pending) _sta_state = WiFiStaState::Backoff;
+    TickType_t ticks = std::max<TickType_t>(1, pdMS_TO_TICKS(delay_ms));
+    if (xTimerChangePeriod(_retry_timer, ticks, 0) != pdPASS) {
+        ESP_LOGE(TAG, "Could not schedule an STA retry");
+    }
+}
+
+// Runs on the timer service task
+void WiFiManager::onRetryTimer(TimerHandle_t timer) {
+    auto* self = static_cast<WiFiManager*>(pvTimerGetTimerID(timer));
+    std::lock_guard<std::mutex> lock(self->_mutex);
+    if (!self->_restart_pending && self->_sta_state != WiFiStaState::Backoff) return;
+    if (self->_scanning) {
+        self->retryLater(SCAN_RETRY_DEFER_MS);
+        return;
+    }
+    self->_restart_pending = false;
+    self->connectSta();
+}
+
+// Runs on the ConfigManager bus task
+void WiFiManager::onConfigChanged(uint8_t sections, const DeviceConfig& config, void* arg) {
+    auto* self = static_cast<WiFiManager*>(arg);
+    std::lock_guard<std::mutex> lock(self->_mutex);
+
+    const NetworkConfig& next = config.network;
+    bool ap_changed = strcmp(self->_config.ap_ssid, next.ap_ssid) != 0 ||
+                      strcmp(self->_config.ap_password, next.ap_password) != 0 ||
+                      self->_config.ap_enabled != next.ap_enabled;
+    bool sta_changed = strcmp(self->_config.ssid, next.ssid) != 0 ||
+                       strcmp(self->_config.password, next.password) != 0 ||
+                       self->_config.sta_enabled != next.sta_enabled;
+    self->_config = next;
+    // bssid and channel alone are this class caching its own connection
+    if (!self->_started || (!ap_changed && !sta_changed)) return;
+
+    ESP_LOGI(TAG, "%s config changed, applying", ap_changed ? "AP" : "STA");
+    esp_err_t err = self->applyConfig(ap_changed, sta_changed);
+    if (err != ESP_OK) ESP_LOGE(TAG, "Failed to apply Wi-Fi config: %s", esp_err_to_name(err));
+}
+
+// Runs on the default event loop task
 void WiFiManager::onWiFiEvent(void* arg, esp_event_base_t event_base, int32_t event_id,
                               void* event_data) {
+    auto* self = static_cast<WiFiManager*>(arg);
+
     switch (event_id) {
         case WIFI_EVENT_AP_STACONNECTED: {
             auto* event = static_cast<wifi_event_ap_staconnected_t*>(event_data);
@@ -74,7 +458,135 @@ void WiFiManager::onWiFiEvent(void* arg, esp_event_base_t event_base, int32_t ev
                      event->aid);
             break;
         }
+        case WIFI_EVENT_SCAN_DONE: {
+            auto* event = static_cast<wifi_event_sta_scan_done_t*>(event_data);
+            std::lock_guard<std::mutex> lock(self->_mutex);
+            if (self->_scanning) self->finishScan(event->status == 0);
+            break;
+        }
+        case WIFI_EVENT_STA_START: {
+            std::lock_guard<std::mutex> lock(self->_mutex);
+            if (self->_started && self->staWanted() &&
+                self->_sta_state == WiFiStaState::Disabled && !self->_restart_pending) {
+                self->beginSta();
+            }
+            break;
+        }
+        case WIFI_EVENT_STA_CONNECTED: {
+            auto* event = static_cast<wifi_event_sta_connected_t*>(event_data);
+            std::lock_guard<std::mutex> lock(self->_mutex);
+            if (self->_sta_state != WiFiStaState::Connecting) break;
+
+            self->_sta_state = WiFiStaState::Associated;
+            self->_assoc_us = esp_timer_get_time();
+            memcpy(self->_ap_bssid, event->bssid, sizeof(self->_ap_bssid));
+            self->_ap_channel = event->channel;
+            ESP_LOGI(TAG, "Associated with " MACSTR " on channel %u", MAC2STR(event->bssid),
+                     event->channel);
+            break;
+        }
+        case WIFI_EVENT_STA_DISCONNECTED: {
+            auto* event = static_cast<wifi_event_sta_disconnected_t*>(event_data);
+            std::lock_guard<std::mutex> lock(self->_mutex);
+            self->_stats.last_reason = event->reason;
+
+            if (self->_sta_state == WiFiStaState::Disabled) {
+                // The old link is down; connect with the new credentials
+                if (self->_restart_pending) {
+                    self->_restart_pending = false;
+                    xTimerStop(self->_retry_timer, 0);
+                    self->connectSta();
+                }
+                break;
+            }
+            if (self->_sta_state == WiFiStaState::Backoff) break;
+
+            if (self->_sta_state == WiFiStaState::Connected) {
+                // Straight back to the same AP before any backoff
+                ESP_LOGW(TAG, "STA link lost (reason %u), reconnecting", event->reason);
+                self->_stats.link_losses++;
+                self->_failures = 0;
+                self->_first_attempt_us = 0;
+                self->_use_hint = self->hasCachedAp();
+                self->connectSta();
+                break;
+            }
+
+            self->_stats.failures++;
+            if (self->_use_hint) {
+                // The AP moved or is gone; a full scan finds the network wherever it is now
+                ESP_LOGW(TAG, "Cached AP failed (reason %u), retrying with a full scan",
+                         event->reason);
+                self->_use_hint = false;
+                self->connectSta();
+                break;
+            }
+
+            uint32_t delay_ms = backoffMs(++self->_failures);
+            ESP_LOGW(TAG, "STA connect failed (reason %u), retrying in %u ms", event->reason,
+                     (unsigned)delay_ms);
+            self->retryLater(delay_ms);
+            break;
+        }
         default:
             break;
     }
 }
+
+// Runs on the default event loop task
+void WiFiManager::onIpEvent(void* arg, esp_event_base_t event_base, int32_t event_id,
+                            void* event_data) {
+    auto* self = static_cast<WiFiManager*>(arg);
+
+    if (event_id == IP_EVENT_STA_LOST_IP) {
+        std::lock_guard<std::mutex> lock(self->_mutex);
+        if (self->_sta_state == WiFiStaState::Connected) {
+            ESP_LOGW(TAG, "STA lost its IP address, waiting for DHCP");
+            self->_sta_state = WiFiStaState::Associated;
+        }
+        return;
+    }
+    if (event_id != IP_EVENT_STA_GOT_IP) return;
+
+    auto* event = static_cast<ip_event_got_ip_t*>(event_data);
+    char ssid[SSID_MAX_LEN];
+    char bssid[MAC_ADDR_LEN];
+    uint8_t channel;
+    {
+        std::lock_guard<std::mutex> lock(self->_mutex);
+        if (self->_sta_state != WiFiStaState::Associated) return;
+
+        int64_t now = esp_timer_get_time();
+        WiFiStaStats& stats = self->_stats;
+        stats.connects++;
+        if (self->_use_hint) stats.fast_connects++;
+        stats.assoc_ms = elapsedMs(self->_attempt_us, self->_assoc_us);
+        stats.dhcp_ms = elapsedMs(self->_assoc_us, now);
+        stats.time_to_ip_ms = elapsedMs(self->_first_attempt_us, now);
+        self->_sta_state = WiFiStaState::Connected;
+        self->_first_attempt_us = 0;
+        self->_failures = 0;
+
+        ESP_LOGI(TAG, "STA got IP " IPSTR " in %u ms (%s, assoc %u ms, DHCP %u ms)",
+                 IP2STR(&event->ip_info.ip), (unsigned)stats.time_to_ip_ms,
+                 self->_use_hint ? "cached AP" : "full scan", (unsigned)stats.assoc_ms,
+                 (unsigned)stats.dhcp_ms);
+
+        snprintf(bssid, sizeof(bssid), MACSTR, MAC2STR(self->_ap_bssid));
+        channel = self->_ap_channel;
+        NetworkConfig& cached = self->_config;
+        if (channel == cached.channel && strcasecmp(bssid, cached.bssid) == 0) return;
+        memcpy(cached.bssid, bssid, sizeof(bssid));
+        cached.channel = channel;
+        strcpy(ssid, cached.ssid);
+    }
+
+    // Outside _mutex: the write comes back through onConfigChanged
+    ConfigManager& config_manager = ConfigManager::getInstance();
+    NetworkConfig network = config_manager.getNetworkConfig();
+    if (strcmp(network.ssid, ssid) != 0) return;  // Reconfigured meanwhile
+    memcpy(network.bssid, bssid, sizeof(bssid));
+    network.channel = channel;
+    config_manager.updateNetworkConfig(network);
+    ESP_LOGI(TAG, "Cached AP %s on channel %u for the next connect", bssid, channel);
+}
@@ -0,0 +1,55 @@
+#include <stdio.h>
+
+#include "nvs_flash.h"
+#include "unity.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void setUp(void) {
+    // Set up before every test
+}
+
+void tearDown(void) {
+    // Clean up after every test
+}
+
+// wifi manager tests (host_sim's simulated AP)
+void test_wifi_sta_connects_and_caches_ap();
+void test_wifi_sta_reconnects_with_cached_ap();
+void test_wifi_sta_stale_cache_falls_back_to_full_scan();
+void test_wifi_scan_runs_in_background_and_caches();
+
+#ifdef __cplusplus
+}
+#endif
+
+TEST_CASE("WiFi: STA connects and caches the AP", "[wifi]") {
+    test_wifi_sta_connects_and_caches_ap();
+}
+
+TEST_CASE("WiFi: STA reconnects through the cached AP", "[wifi]") {
+    test_wifi_sta_reconnects_with_cached_ap();
+}
+
+TEST_CASE("WiFi: Stale cached AP falls back to a full scan", "[wifi]") {
+    test_wifi_sta_stale_cache_falls_back_to_full_scan();
+}
+
+TEST_CASE("WiFi: Scan runs in the background and is cached", "[wifi]") {
+    test_wifi_scan_runs_in_background_and_caches();
+}
+
+void app_main(void) {
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(ret);
+
+    UNITY_BEGIN();
+    unity_run_all_tests();
+    UNITY_END();
+}
@@ -0,0 +1,154 @@
+#include <cstring>
+
+#include "config_manager.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "unity.h"
+#include "wifi_manager.hpp"
+
+// The one AP host_sim simulates; a full scan takes it 1.5 s, its own channel 40 ms
+constexpr uint8_t SIM_CHANNEL = 6;
+static const char* SIM_BSSID = "02:00:00:5a:11:01";
+
+constexpr TickType_t CONNECT_TIMEOUT = pdMS_TO_TICKS(8000);
+constexpr uint32_t FULL_SCAN_MS = 1500;
+
+// host_sim reports three visible APs, strongest first, and one hidden
+constexpr uint16_t SIM_VISIBLE_APS = 3;
+constexpr TickType_t SCAN_TIMEOUT = pdMS_TO_TICKS(8000);
+
+/**
+ * @brief Store a STA-only config with the given cached AP and return it.
+ */
+static NetworkConfig setStaConfig(const char* bssid, uint8_t channel) {
+    NetworkConfig net = ConfigManager::getInstance().getNetworkConfig();
+    net.ap_enabled = false;
+    net.sta_enabled = true;
+    strcpy(net.ssid, "TestNet");
+    strcpy(net.password, "test-pass");
+    strcpy(net.bssid, bssid);
+    net.channel = channel;
+    ConfigManager::getInstance().updateNetworkConfig(net);
+    return net;
+}
+
+static bool waitForConnected(WiFiManager& wifi) {
+    TickType_t start = xTaskGetTickCount();
+    while (wifi.getStaState() != WiFiStaState::Connected) {
+        if (xTaskGetTickCount() - start > CONNECT_TIMEOUT) return false;
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return true;
+}
+
+// The cache is written back through ConfigManager after the IP event
+static bool waitForCachedAp() {
+    TickType_t start = xTaskGetTickCount();
+    for (;;) {
+        NetworkConfig net = ConfigManager::getInstance().getNetworkConfig();
+        if (net.channel == SIM_CHANNEL && strcmp(net.bssid, SIM_BSSID) == 0) return true;
+        if (xTaskGetTickCount() - start > CONNECT_TIMEOUT) return false;
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+// Lets the events of the stopped driver drain before the next test
+static void stopWiFi(WiFiManager& wifi) {
+    wifi.stop();
+    vTaskDelay(pdMS_TO_TICKS(100));
+}
+
+/// @brief Tests that a first connect scans every channel and caches the AP it joined.
+extern "C" void test_wifi_sta_connects_and_caches_ap() {
+    WiFiManager wifi(setStaConfig("", 0));
+    wifi.start();
+
+    TEST_ASSERT_TRUE(waitForConnected(wifi));
+    WiFiStaStats stats = wifi.getStaStats();
+    TEST_ASSERT_EQUAL(1, stats.attempts);
+    TEST_ASSERT_EQUAL(1, stats.connects);
+    TEST_ASSERT_EQUAL(0, stats.fast_connects);
+    TEST_ASSERT_GREATER_OR_EQUAL(FULL_SCAN_MS, stats.time_to_ip_ms);
+    TEST_ASSERT_TRUE(waitForCachedAp());
+
+    stopWiFi(wifi);
+}
+
+/// @brief Tests that the cached channel/BSSID skip the full scan, also after a link loss.
+extern "C" void test_wifi_sta_reconnects_with_cached_ap() {
+    WiFiManager wifi(setStaConfig(SIM_BSSID, SIM_CHANNEL));
+    wifi.start();
+
+    TEST_ASSERT_TRUE(waitForConnected(wifi));
+    WiFiStaStats stats = wifi.getStaStats();
+    TEST_ASSERT_EQUAL(1, stats.attempts);
+    TEST_ASSERT_EQUAL(1, stats.fast_connects);
+    TEST_ASSERT_LESS_THAN(FULL_SCAN_MS, stats.time_to_ip_ms);
+
+    // Drop the link under the manager, as a lost AP would
+    TEST_ASSERT_EQUAL(ESP_OK, esp_wifi_disconnect());
+    vTaskDelay(pdMS_TO_TICKS(20));
+    TEST_ASSERT_TRUE(waitForConnected(wifi));
+    stats = wifi.getStaStats();
+    TEST_ASSERT_EQUAL(1, stats.link_losses);
+    TEST_ASSERT_EQUAL(2, stats.fast_connects);
+    TEST_ASSERT_LESS_THAN(FULL_SCAN_MS, stats.time_to_ip_ms);
+
+    stopWiFi(wifi);
+}
+
+/// @brief Tests that a cached AP that is gone costs one failed attempt, then a full scan.
+extern "C" void test_wifi_sta_stale_cache_falls_back_to_full_scan() {
+    WiFiManager wifi(setStaConfig("02:00:00:00:00:99", 11));
+    wifi.start();
+
+    TEST_ASSERT_TRUE(waitForConnected(wifi));
+    WiFiStaStats stats = wifi.getStaStats();
+    TEST_ASSERT_EQUAL(2, stats.attempts);
+    TEST_ASSERT_EQUAL(1, stats.failures);
+    TEST_ASSERT_EQUAL(WIFI_REASON_NO_AP_FOUND, stats.last_reason);
+    TEST_ASSERT_EQUAL(0, stats.fast_connects);
+    TEST_ASSERT_TRUE(waitForCachedAp());
+
+    stopWiFi(wifi);
+}
+
+/// @brief Tests that a scan from AP-only mode returns at once, pages its results and is cached.
+extern "C" void test_wifi_scan_runs_in_background_and_caches() {
+    NetworkConfig net = ConfigManager::getInstance().getNetworkConfig();
+    net.ap_enabled = true;
+    net.sta_enabled = false;
+    ConfigManager::getInstance().updateNetworkConfig(net);
+    WiFiManager wifi(net);
+    wifi.start();
+
+    TickType_t start = xTaskGetTickCount();
+    TEST_ASSERT_EQUAL(WiFiScanRequest::Started, wifi.requestScan());
+    TEST_ASSERT_LESS_THAN(pdMS_TO_TICKS(50), xTaskGetTickCount() - start);
+    TEST_ASSERT_EQUAL(WiFiScanRequest::Running, wifi.requestScan());
+
+    while (wifi.getScanStatus().state == WiFiScanState::Scanning) {
+        TEST_ASSERT_LESS_THAN(SCAN_TIMEOUT, xTaskGetTickCount() - start);
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+    WiFiScanStatus status = wifi.getScanStatus();
+    TEST_ASSERT_EQUAL(WiFiScanState::Done, status.state);
+    TEST_ASSERT_EQUAL(SIM_VISIBLE_APS, status.total);
+
+    WiFiScanEntry page[2];
+    TEST_ASSERT_EQUAL(2, wifi.getScanResults(0, page, 2, status));
+    TEST_ASSERT_EQUAL_STRING("HostSimNet", page[0].ssid);
+    TEST_ASSERT_EQUAL(SIM_CHANNEL, page[0].channel);
+    TEST_ASSERT_GREATER_THAN(page[1].rssi, page[0].rssi);
+    TEST_ASSERT_EQUAL(1, wifi.getScanResults(2, page, 2, status));
+    TEST_ASSERT_EQUAL_STRING("CoffeeShop", page[0].ssid);
+    TEST_ASSERT_EQUAL(0, wifi.getScanResults(SIM_VISIBLE_APS, page, 2, status));
+
+    // Fresh results answer the next request, and the scan's STA interface is gone
+    TEST_ASSERT_EQUAL(WiFiScanRequest::Cached, wifi.requestScan());
+    wifi_mode_t mode;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_wifi_get_mode(&mode));
+    TEST_ASSERT_EQUAL(WIFI_MODE_AP, mode);
+
+    stopWiFi(wifi);
+}
@@ -1,6 +1,8 @@
 #include <stdio.h>
 
+#include "boot_sequence.hpp"
 #include "config_manager.hpp"
+#include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "http_server.hpp"
@@ -8,25 +10,59 @@
 #include "sensor_manager.hpp"
 #include "wifi_manager.hpp"
 
-extern "C" void app_main() {
-    // INIT NVS
+static const char* TAG = "main";
+
+// A 12-bit conversion is 750 ms; past this the bus is taken to be stuck
+constexpr uint32_t FIRST_SWEEP_TIMEOUT_MS = 2000;
+
+static WiFiManager* wifi_manager = nullptr;
+
+static esp_err_t initNvs(void*) {
     esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
-        ESP_ERROR_CHECK(nvs_flash_erase());
-        ret = nvs_flash_init();
+        ret = nvs_flash_erase();
+        if (ret == ESP_OK) ret = nvs_flash_init();
     }
-    ESP_ERROR_CHECK(ret);
+    // BootSequence reports a failure and skips the stages that need NVS
+    return ret;
+}
 
-    // INIT CONFIG MANAGER
-    ConfigManager& configManager = ConfigManager::getInstance();
-    DeviceConfig config = configManager.getConfig();
+// Loads, and if needed migrates, every config section
+static esp_err_t initConfig(void*) {
+    ConfigManager::getInstance();
+    return ESP_OK;
+}
 
-    // INIT WIFI & HTTP
-    // static WiFiManager wifi(config.network);
-    // wifi.startAP();
+static esp_err_t startWiFi(void*) {
+    static WiFiManager wifi(ConfigManager::getInstance().getNetworkConfig());
+    wifi.start();
+    wifi_manager = &wifi;
+    return ESP_OK;
+}
 
-    // static HttpServer http_server(config.info);
-    // http_server.start();
+static esp_err_t startHttp(void*) {
+    static HttpServer http_server(wifi_manager);
+    http_server.start();
+    return ESP_OK;
+}
+
+// Includes the first conversion, so the breakdown shows when readings are real
+static esp_err_t startSensors(void*) {
+    DS18B20SensorManager::init(GPIO_NUM_4);
+    return DS18B20SensorManager::waitForFirstSweep(FIRST_SWEEP_TIMEOUT_MS) ? ESP_OK
+                                                                           : ESP_ERR_TIMEOUT;
+}
+
+extern "C" void app_main() {
+    // The sensors share nothing with the network stages and run alongside them;
+    // HTTP starts as soon as config and the network stack are up.
+    BootSequence boot;
+    int nvs = boot.add("nvs", initNvs);
+    int config = boot.add("config", initConfig, nullptr, {nvs});
+    int wifi = boot.add("wifi", startWiFi, nullptr, {config});
+    boot.add("http", startHttp, nullptr, {config, wifi});
+    boot.add("sensors", startSensors);
 
-    // DS18B20SensorManager::init(GPIO_NUM_4);
-}
\ No newline at end of file
+    esp_err_t err = boot.run();
+    if (err != ESP_OK) ESP_LOGE(TAG, "Boot finished with errors: %s", esp_err_to_name(err));
+}